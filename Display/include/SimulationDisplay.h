@@ -28,7 +28,9 @@
 #include "ElectronClusters.h"
 #include "ReadoutID.h"
 #include "ReadoutMap.h"
+#include "CompactReadoutMap.h"
 #include "ReadoutWaveforms.h"
+#include "CompactReadoutWaveforms.h"
 
 // ROOT includes
 #include <TFile.h>
@@ -196,6 +198,29 @@ class SimulationDisplay : public TGMainFrame {
   grams::ReadoutMap*       MyReadoutMap;
   grams::ReadoutWaveforms* MyWaveforms;
 
+  // If the input has the flat versions of the data products, they're
+  // read into these, then copied into the maps above. Otherwise
+  // these are nullptr.
+  grams::FlatMCLArHits*        MyFlatLArHits;
+  grams::FlatElectronClusters* MyFlatClusters;
+  grams::FlatReadoutMap*       MyFlatReadoutMap;
+  grams::FlatReadoutWaveforms* MyFlatWaveforms;
+
+  // If the readout map was written in its compressed sparse row
+  // form, it's read into this instead. Otherwise it's nullptr.
+  grams::CompactReadoutMap*    MyCompactReadoutMap;
+
+  // Likewise, if only the regions of interest of the waveforms were
+  // written; these are expanded into MyWaveforms after each read.
+  grams::CompactReadoutWaveforms* MyCompactWaveforms;
+
+  // If gramsdetsim wrote large events in segments, the DetSim and
+  // ReadoutSim trees have more than one row per event, and the rows
+  // of an event are found with ReadSegments(). Otherwise these are
+  // nullptr.
+  TTree* MyDetSimTree;
+  TTree* MyReadoutSimTree;
+
   // These are parameters associated with defining the displayed
   // histogram.
   double DriftVelocity;     // Parameters to be read via the Options utility
@@ -252,9 +277,11 @@ class SimulationDisplay : public TGMainFrame {
   // Routines associated with accumulating values from the ROOT
   // tree.
   void FindPrimaries();
+  void ReadSegments();
   void AccumulateHits();
   void AccumulateClusters();
   void AccumulateReadout();
+  void AccumulateCompactReadout();
   void AccumulateWaveforms();
 
   // The following line is mandatory for a ROOT GUI application.
@@ -21,19 +21,23 @@
 
 // GramsSim includes
 #include "Options.h"
+#include "ProductIO.h"
 #include "EventID.h"
 #include "MCTrackList.h"
 #include "MCLArHits.h"
 #include "ElectronClusters.h"
 #include "ReadoutID.h"
 #include "ReadoutMap.h"
+#include "CompactReadoutMap.h"
 #include "ReadoutWaveforms.h"
+#include "CompactReadoutWaveforms.h"
 
 // ROOT includes
 #include <TStyle.h>
 #include <TString.h>
 #include <TFile.h>
 #include <TTree.h>
+#include <TFriendElement.h>
 #include <TCanvas.h>
 #include <TH1.h>
 #include <TH2D.h>
@@ -69,10 +73,32 @@
 #include <iostream>
 #include <string>
 #include <map>
+#include <vector>
 #include <cmath>
 
 // ....ooooOOOOoooo....ooooOOOOoooo....ooooOOOOoooo....ooooOOOOoooo....
 
+// A data product may have been written as a std::map or in its flat
+// (sorted-vector) form; see GramsDataObj/README.md. Point the
+// branch at whichever object matches. If it's the flat one, the
+// flat object is created and must be converted to the map after
+// each GetEntry(); otherwise 'flatProduct' is set to nullptr.
+template <typename Flat, typename Map>
+static void SetProductAddress(TTree* a_tree, const char* a_name,
+			      Map** a_mapProduct, Flat** a_flatProduct)
+{
+  if ( util::ProductReader<Flat,Map>::IsFlat(a_tree, a_name) ) {
+    *a_flatProduct = new Flat;
+    a_tree->SetBranchAddress(a_name, a_flatProduct);
+  }
+  else {
+    *a_flatProduct = nullptr;
+    a_tree->SetBranchAddress(a_name, a_mapProduct);
+  }
+}
+
+// ....ooooOOOOoooo....ooooOOOOoooo....ooooOOOOoooo....ooooOOOOoooo....
+
 // Constructor. Define all the widgets that will appear within the
 // main frame.
 SimulationDisplay::SimulationDisplay(const TGWindow* a_window)
@@ -378,19 +404,48 @@ SimulationDisplay::SimulationDisplay(const TGWindow* a_window)
   MyTree = MyFile->Get<TTree>( elecsimTree.c_str() );
    
   // Declare the friend trees; that is, the files that contain
-  // the other columns for this tree.
+  // the other columns for this tree. Each of the trees has an index
+  // built from EventID, and ROOT uses it to find the row of a friend
+  // tree with the same event as the row of this tree.
   MyTree->AddFriend( g4Tree.c_str(),         g4File.c_str() );
-  MyTree->AddFriend( detsimTree.c_str(),     detsimFile.c_str() );
-  MyTree->AddFriend( readoutsimTree.c_str(), readoutsimFile.c_str() );
+  auto detsimFriend     = MyTree->AddFriend( detsimTree.c_str(),     detsimFile.c_str() );
+  auto readoutsimFriend = MyTree->AddFriend( readoutsimTree.c_str(), readoutsimFile.c_str() );
+
+  // That doesn't work if gramsdetsim wrote large events in segments
+  // (see maxClustersPerSegment in options.xml): those trees are
+  // indexed by both EventID and Segment, and have more than one row
+  // for some events. Their rows are read by ReadSegments() instead.
+  MyDetSimTree = nullptr;
+  MyReadoutSimTree = nullptr;
+  if ( detsimFriend->GetTree()->GetBranch("Segment") != nullptr ) {
+    MyDetSimTree = detsimFriend->GetTree();
+    MyReadoutSimTree = readoutsimFriend->GetTree();
+  }
    
   // Define the branches we'll read from the collection of friend
   // trees.
   MyTree->SetBranchAddress("EventID",          &MyEventID);
-  MyTree->SetBranchAddress("ElectronClusters", &MyClusters);
-  MyTree->SetBranchAddress("LArHits",          &MyLArHits);
   MyTree->SetBranchAddress("TrackList",        &MyTrackList);
-  MyTree->SetBranchAddress("ReadoutMap",       &MyReadoutMap);
-  MyTree->SetBranchAddress("ReadoutWaveforms", &MyWaveforms);
+  SetProductAddress(MyTree, "ElectronClusters", &MyClusters,   &MyFlatClusters);
+  SetProductAddress(MyTree, "LArHits",          &MyLArHits,    &MyFlatLArHits);
+  // The readout map may also be in its compressed sparse row form.
+  MyCompactReadoutMap = nullptr;
+  if ( util::ColumnHolds<grams::CompactReadoutMap>(MyTree, "ReadoutMap") ) {
+    MyFlatReadoutMap = nullptr;
+    MyCompactReadoutMap = new grams::CompactReadoutMap;
+    MyTree->SetBranchAddress("ReadoutMap", &MyCompactReadoutMap);
+  }
+  else
+    SetProductAddress(MyTree, "ReadoutMap",     &MyReadoutMap, &MyFlatReadoutMap);
+  // So may the waveforms (see compactWaveforms in options.xml).
+  MyCompactWaveforms = nullptr;
+  if ( util::ColumnHolds<grams::CompactReadoutWaveforms>(MyTree, "ReadoutWaveforms") ) {
+    MyFlatWaveforms = nullptr;
+    MyCompactWaveforms = new grams::CompactReadoutWaveforms;
+    MyTree->SetBranchAddress("ReadoutWaveforms", &MyCompactWaveforms);
+  }
+  else
+    SetProductAddress(MyTree, "ReadoutWaveforms", &MyWaveforms,  &MyFlatWaveforms);
 
   // Set up the histogram parameters.
   SetUpHistogram();
@@ -455,6 +510,59 @@ void SimulationDisplay::FindPrimaries() {
 
   // ....ooooOOOOoooo....ooooOOOOoooo....ooooOOOOoooo....ooooOOOOoooo....
 
+  // If gramsdetsim wrote large events in segments, collect the
+  // electron clusters and the readout map of every segment of the
+  // current event. The segments of an event are numbered from 0, and
+  // the rows of the DetSim and ReadoutSim trees are looked up by
+  // (EventID, Segment) in their indexes.
+void SimulationDisplay::ReadSegments() {
+
+  if (debug) std::cout << "ReadSegments" << std::endl;
+
+  grams::ElectronClusters eventClusters;
+  grams::ReadoutMap eventReadoutMap;
+  const auto index = MyEventID->Index();
+
+  for ( int segment = 0; ; ++segment ) {
+    const auto detsimEntry     = MyDetSimTree->GetEntryNumberWithIndex( index, segment );
+    const auto readoutsimEntry = MyReadoutSimTree->GetEntryNumberWithIndex( index, segment );
+    if ( detsimEntry < 0  ||  readoutsimEntry < 0 ) break;
+
+    // The branch addresses were set through MyTree, so reading a row
+    // of a friend tree fills the same objects.
+    MyDetSimTree->GetEntry( detsimEntry );
+    MyReadoutSimTree->GetEntry( readoutsimEntry );
+
+    if ( MyFlatClusters ) grams::Convert( *MyFlatClusters, *MyClusters );
+
+    // The cluster indices of a compact readout map refer to the
+    // clusters of its own segment, so it's converted here.
+    if ( MyCompactReadoutMap ) {
+      grams::FlatElectronClusters flatClusters;
+      if ( MyFlatClusters )
+	flatClusters = *MyFlatClusters;
+      else
+	grams::Convert( *MyClusters, flatClusters );
+      grams::FlatReadoutMap flatReadoutMap;
+      MyCompactReadoutMap->ToFlat( flatClusters, flatReadoutMap );
+      grams::Convert( flatReadoutMap, *MyReadoutMap );
+    }
+    else if ( MyFlatReadoutMap )
+      grams::Convert( *MyFlatReadoutMap, *MyReadoutMap );
+
+    // The cluster keys of different segments are different, but a
+    // readout cell may receive clusters from more than one segment.
+    eventClusters.merge( *MyClusters );
+    for ( auto& [ readoutID, clusterKeys ] : *MyReadoutMap )
+      eventReadoutMap[ readoutID ].merge( clusterKeys );
+  }
+
+  MyClusters->swap( eventClusters );
+  MyReadoutMap->swap( eventReadoutMap );
+} // ReadSegments
+
+  // ....ooooOOOOoooo....ooooOOOOoooo....ooooOOOOoooo....ooooOOOOoooo....
+
   // For the hits plot, accumulate the values associated with the
   // ionization energy deposits in the liquid argon.
 void SimulationDisplay::AccumulateHits() {
@@ -510,6 +618,14 @@ void SimulationDisplay::AccumulateClusters() {
 void SimulationDisplay::AccumulateReadout() {
 
   if (debug) std::cout << "AccumulateReadout" << std::endl;
+
+  // A compact readout map refers to the clusters by their position
+  // in the cluster list, so it's read directly. (If the event was
+  // written in segments, ReadSegments has already converted it.)
+  if ( MyCompactReadoutMap  &&  MyDetSimTree == nullptr ) {
+    AccumulateCompactReadout();
+    return;
+  }
     
   // Iterate over all readout channels.
   for (const auto& [readoutID, ckeys] : *MyReadoutMap) {
@@ -561,6 +677,44 @@ void SimulationDisplay::AccumulateReadout() {
 } // AccumulateReadout
 
   // ....ooooOOOOoooo....ooooOOOOoooo....ooooOOOOoooo....ooooOOOOoooo....
+
+  // The same as AccumulateReadout, for a grams::CompactReadoutMap.
+void SimulationDisplay::AccumulateCompactReadout() {
+
+  // The clusters in key order, so they can be found by their index.
+  std::vector< const grams::ElectronCluster* > clusterList;
+  clusterList.reserve( MyClusters->size() );
+  for ( const auto& [ ckey, cluster ] : *MyClusters )
+    clusterList.push_back( &cluster );
+
+  for (const auto& [readoutID, indices] : *MyCompactReadoutMap) {
+
+    auto xID = readoutID.X();
+    auto yID = readoutID.Y();
+
+    for ( const auto index : indices ) {
+      if ( index >= clusterList.size() ) {
+	std::cerr << "AccumulateReadout - ERROR - "
+		  << "Readout channel " << readoutID
+		  << " contains a non-existent cluster index " << index
+		  << std::endl;
+	break;
+      }
+      const auto& cluster = *clusterList[index];
+
+      // See AccumulateReadout.
+      double energy_at_anode = cluster.EnergyAtAnode();
+      if ( energy_at_anode > 0 ) {
+	e_val.push_back(energy_at_anode);
+	x_value.push_back(xID);
+	y_value.push_back(yID);
+	z_value.push_back(-cluster.TAtAnode() / 1000);
+      } // anode energy > 0
+    } // loop over clusters
+  } // loop over readout channels
+} // AccumulateCompactReadout
+
+  // ....ooooOOOOoooo....ooooOOOOoooo....ooooOOOOoooo....ooooOOOOoooo....
   
   // For the readout waveform plot, accumulate the values associated
   // with the output of GramsElecSim.
@@ -961,6 +1115,24 @@ void SimulationDisplay::UpdateDisplay() {
   // Get the current entry.
   MyTree->GetEntry( CurrentEntry );
 
+  // The rest of the display works with the std::map versions of the
+  // data products. Convert any that were written in flat form.
+  if ( MyFlatLArHits )    grams::Convert( *MyFlatLArHits,    *MyLArHits );
+  if ( MyFlatWaveforms )  grams::Convert( *MyFlatWaveforms,  *MyWaveforms );
+  if ( MyCompactWaveforms ) {
+    grams::FlatReadoutWaveforms flatWaveforms;
+    MyCompactWaveforms->ToFlat( flatWaveforms );
+    grams::Convert( flatWaveforms, *MyWaveforms );
+  }
+  if ( MyDetSimTree ) {
+    // ReadSegments does the conversions for each segment.
+    ReadSegments();
+  }
+  else {
+    if ( MyFlatClusters )   grams::Convert( *MyFlatClusters,   *MyClusters );
+    if ( MyFlatReadoutMap ) grams::Convert( *MyFlatReadoutMap, *MyReadoutMap );
+  }
+
   if (debug) std::cout << "Trace 0220"
 		       << " Event=" << (*MyEventID)
 		       << std::endl;
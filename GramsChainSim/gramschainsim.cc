@@ -0,0 +1,317 @@
+// gramschainsim.cc
+// Apply the models of gramsdetsim, gramsreadoutsim, and gramselecsim
+// to each event in memory, without writing and reading back the
+// electron clusters and readout map between the programs.
+// 16-Oct-2026
+
+// The models from each program.
+#include "DetectorResponse.h"    // in GramsDetSim/
+#include "AssignPixelID.h"       // in GramsReadoutSim/
+#include "PixelGeometryIO.h"     // in GramsReadoutSim/
+#include "ElectronicsResponse.h" // in GramsElecSim/
+#include "LoadOptionFile.h"      // in GramsElecSim/
+
+// For processing command-line and XML file options.
+#include "Options.h" // in util/
+
+// For copying and accessing the detectory geometry.
+#include "Geometry.h" // in util/
+
+// Per-event random-number streams.
+#include "RandomService.h" // in util/
+
+// For reading and writing either std::map or flat data products.
+#include "ProductIO.h" // in util/
+
+// From GramsDataObj
+#include "EventID.h"
+#include "MCLArHits.h"
+#include "ElectronClusters.h"
+#include "ReadoutMap.h"
+#include "CompactReadoutMap.h"
+#include "ReadoutWaveforms.h"
+#include "CompactReadoutWaveforms.h"
+
+// ROOT includes
+#include "TFile.h"
+#include "TTree.h"
+#include "TTreeReader.h"
+#include "TTreeReaderValue.h"
+
+// C++ includes
+#include <iostream>
+#include <string>
+#include <memory>
+#include <ctime>
+#include <utility>
+#include <cstddef>
+
+///////////////////////////////////////
+int main(int argc,char **argv)
+{
+  // Read the options of all three programs, plus those for this
+  // one. See "ParseOptions" in util/README.md.
+  auto options = util::Options::GetInstance();
+  auto result = options->ParseOptions(argc, argv,
+				      "gramschainsim,gramsdetsim,gramsreadoutsim,gramselecsim");
+
+  // Abort if we couldn't parse the job options.
+  if (! result) {
+    std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+	      << "gramschainsim: Aborting job due to failure to parse options"
+	      << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  bool debug;
+  options->GetOption("debug",debug);
+
+  bool help;
+  options->GetOption("help",help);
+  if (help) {
+    options->PrintHelp();
+    exit(EXIT_SUCCESS);
+  }
+
+  bool verbose;
+  options->GetOption("verbose",verbose);
+  if (verbose) {
+    // Display all program options.
+    options->PrintOptions();
+  }
+
+  // Which of the intermediate trees should be written?
+  bool writeDetSim;
+  bool writeReadoutSim;
+  options->GetOption("writeDetSim",     writeDetSim);
+  options->GetOption("writeReadoutSim", writeReadoutSim);
+
+  bool flatDataProducts;
+  options->GetOption("flatDataProducts",flatDataProducts);
+
+  // As in gramsdetsim, large events may be processed in segments
+  // to limit the memory they use.
+  int maxClustersPerSegment;
+  options->GetOption("maxClustersPerSegment",maxClustersPerSegment);
+  const bool segmented = ( maxClustersPerSegment > 0 );
+  const std::size_t segmentSize = segmented ? maxClustersPerSegment : 0;
+  int segment = 0;
+
+  // The input is the same as that of gramsdetsim.
+  std::string inputFileName;
+  options->GetOption("inputDetSimFile",inputFileName);
+
+  std::string inputTreeName;
+  options->GetOption("inputHitsTree",inputTreeName);
+
+  if (verbose)
+    std::cout << "gramschainsim: input file = '" << inputFileName
+	      << "', input tree = '" << inputTreeName
+	      << "'" << std::endl;
+
+  auto input = TFile::Open(inputFileName.c_str());
+  if (!input || input->IsZombie()) {
+    std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+	      << "gramschainsim: Could not open file '" << inputFileName << "'"
+	      << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // Copy the options saved in the input file, to maintain a
+  // historical record of the analysis chain.
+  options->CopyInputNtuple(input);
+
+  auto reader = new TTreeReader(inputTreeName.c_str(), input);
+  TTreeReaderValue<grams::EventID> inputEventID = {*reader, "EventID"};
+  util::ProductReader<grams::FlatMCLArHits, grams::MCLArHits> LArHits(*reader, "LArHits");
+
+  auto geometry = util::Geometry::GetInstance();
+
+  // Open an output file, save the options and the geometry in it,
+  // and create its tree with an EventID column. The output trees
+  // have the same names and contents as those of the individual
+  // programs, so they can be used as friends in the same way.
+  auto openOutput = [&]( const std::string& fileOption, const std::string& treeOption,
+			 const char* title, TFile*& file ) {
+    std::string fileName, treeName;
+    options->GetOption(fileOption,fileName);
+    options->GetOption(treeOption,treeName);
+    if (verbose)
+      std::cout << "gramschainsim: output file = '" << fileName
+		<< "', output tree = '" << treeName
+		<< "'" << std::endl;
+
+    file = TFile::Open(fileName.c_str(),"RECREATE");
+    options->WriteNtuple(file);
+    geometry->CopyGeometry(input,file);
+    auto tree = new TTree(treeName.c_str(),title);
+    return tree;
+  };
+
+  // The event ID written to every output tree.
+  auto eventID = new grams::EventID();
+
+  // The waveforms are always written.
+  TFile* elecOutput = nullptr;
+  auto elecTree = openOutput("outputElecFile", "outputElecTree", "Electronics Response", elecOutput);
+  // By experimenting, it turns out that setting the splitlevel to 0
+  // improves potential issues with ROOT's TBrowser.
+  elecTree->Branch("EventID", &eventID, 32000, 0);
+  // Possibly with only their regions of interest; see gramselecsim.
+  bool compactWaveforms;
+  options->GetOption("compactWaveforms",compactWaveforms);
+  util::ProductWriter<grams::FlatReadoutWaveforms, grams::ReadoutWaveforms>
+    readoutWaveforms(compactWaveforms ? nullptr : elecTree, "ReadoutWaveforms", flatDataProducts);
+  grams::CompactReadoutWaveforms compactReadoutWaveforms;
+  auto compactWaveformsPointer = &compactReadoutWaveforms;
+  if ( compactWaveforms )
+    elecTree->Branch("ReadoutWaveforms", &compactWaveformsPointer, 32000, 0);
+
+  // The electron clusters and the readout map are always computed,
+  // but only written if the user asked for them.
+  TFile* detsimOutput = nullptr;
+  TTree* detsimTree = nullptr;
+  if ( writeDetSim ) {
+    detsimTree = openOutput("outputDetSimFile", "outputDetSimTree", "Detector Response", detsimOutput);
+    detsimTree->Branch("EventID", &eventID, 32000, 0);
+    if ( segmented )
+      detsimTree->Branch("Segment", &segment);
+  }
+  util::ProductWriter<grams::FlatElectronClusters, grams::ElectronClusters>
+    clusters( detsimTree, "ElectronClusters", flatDataProducts );
+
+  TFile* readoutsimOutput = nullptr;
+  TTree* readoutsimTree = nullptr;
+  if ( writeReadoutSim ) {
+    readoutsimTree = openOutput("outputReadoutFile", "outputReadoutTree", "ReadoutSim", readoutsimOutput);
+    readoutsimTree->Branch("EventID", &eventID, 32000, 0);
+    if ( segmented )
+      readoutsimTree->Branch("Segment", &segment);
+  }
+  // In memory, the readout map is kept in the compressed sparse row
+  // form, which lets gramselecsim's models find each cluster without
+  // a search. It's converted if the user wants one of the other forms
+  // written.
+  bool compact;
+  options->GetOption("compactReadoutMap",compact);
+  grams::CompactReadoutMap compactMap;
+  auto compactMapPointer = &compactMap;
+  if ( readoutsimTree  &&  compact )
+    readoutsimTree->Branch("ReadoutMap", &compactMapPointer, 32000, 0);
+  util::ProductWriter<grams::FlatReadoutMap, grams::ReadoutMap>
+    readoutMap( compact ? nullptr : readoutsimTree, "ReadoutMap", flatDataProducts );
+
+  // Set up the models for each step.
+  util::RandomStream random;
+  gramsdetsim::DetectorResponse detectorResponse( &random );
+  auto randomService = util::RandomService::GetInstance();
+
+  // The two steps use the same pixels; see JobPixelGeometry() in
+  // GramsReadoutSim/include/PixelGeometryIO.h. As in gramsdetsim,
+  // the pixels are saved in the detsim file if the charge was
+  // deposited on them.
+  gramsreadoutsim::AssignPixelID assignPixelID;
+  if ( readoutsimOutput )
+    gramsreadoutsim::WritePixelGeometry( assignPixelID.Geometry(), readoutsimOutput );
+  bool diffusion, analyticDiffusion;
+  options->GetOption("diffusion",diffusion);
+  options->GetOption("AnalyticDiffusion",analyticDiffusion);
+  if ( detsimOutput  &&  diffusion  &&  analyticDiffusion )
+    gramsreadoutsim::WritePixelGeometry( assignPixelID.Geometry(), detsimOutput );
+
+  gramselecsim::LoadOptionFile::GetInstance()->Load();
+  gramselecsim::ElectronicsResponse electronicsResponse;
+
+  if (debug)
+    std::cout << "gramschainsim: models defined" << std::endl;
+
+  // For timing how long this routine takes.
+  time_t t1 = time(NULL);
+
+  // For each row in the input tree:
+  while ( (*reader).Next() ) {
+
+    if (debug)
+      std::cout << "gramschainsim: at entry " << reader->GetCurrentEntry() << std::endl;
+
+    (*eventID) = (*inputEventID);
+
+    // gramsdetsim: hits to electron clusters. The random-number
+    // stream is the one gramsdetsim would use for this event, so the
+    // results are the same as running the programs separately.
+    randomService->SetStream( random, util::RandomService::e_gramsdetsim,
+			      eventID->Run(), eventID->Event() );
+
+    // Unless maxClustersPerSegment is set, the whole event is one
+    // segment.
+    detectorResponse.Begin( *LArHits );
+    segment = 0;
+    bool moreHits;
+    do {
+      moreHits = detectorResponse.Next( *clusters, segmentSize );
+
+      // gramsreadoutsim: clusters to readout cells.
+      assignPixelID.Assign( *clusters, compactMap );
+
+      // gramselecsim: collect the electrons arriving at each readout
+      // cell.
+      electronicsResponse.Accumulate( *eventID, *clusters, compactMap );
+
+      if ( detsimTree ) {
+	clusters.Prepare();
+	detsimTree->Fill();
+      }
+      if ( readoutsimTree ) {
+	if ( ! compact ) {
+	  compactMap.ToFlat( *clusters, *readoutMap );
+	  readoutMap.Prepare();
+	}
+	readoutsimTree->Fill();
+      }
+      ++segment;
+    } while ( moreHits );
+
+    // gramselecsim: readout cells to waveforms.
+    electronicsResponse.Finish( *eventID, *readoutWaveforms );
+    if ( compactWaveforms )
+      electronicsResponse.Compact( *readoutWaveforms, compactReadoutWaveforms );
+    else
+      readoutWaveforms.Prepare();
+    elecTree->Fill();
+
+  } // for each event
+
+  // Report what the hit filter dropped.
+  if ( detectorResponse.FilterActive() )
+    std::cout << detectorResponse.FilterCounts() << std::endl;
+
+  // See gramsreadoutsim.
+  if ( assignPixelID.NumberOutsideAnode() > 0 )
+    std::cout << "gramschainsim: " << assignPixelID.NumberOutsideAnode()
+	      << " cluster(s) arrived outside the anode and were not assigned to a readout cell"
+	      << std::endl;
+
+  if (verbose) {
+    time_t t2 = time(NULL);
+    std::cout << "Time: " << t2 - t1 << "s" << std::endl;
+  }
+
+  // Build an index for each tree. This will allow downstream
+  // programs to quickly access a given EventID within the tree.
+  // Then close the files.
+  for ( auto [ tree, file ] : { std::make_pair( elecTree, elecOutput ),
+				std::make_pair( detsimTree, detsimOutput ),
+				std::make_pair( readoutsimTree, readoutsimOutput ) } ) {
+    if ( tree == nullptr ) continue;
+    if ( segmented  &&  tree != elecTree )
+      tree->BuildIndex("EventID.Index()","Segment");
+    else
+      tree->BuildIndex("EventID.Index()");
+    file->cd();
+    tree->Write();
+    file->Close();
+  }
+
+  delete reader;
+  input->Close();
+}
@@ -0,0 +1,199 @@
+/// \file CompactReadoutMap.h
+/// \brief The readout map in compressed sparse row (CSR) form.
+// 16-Oct-2026
+
+// A ReadoutMap (or FlatReadoutMap) keeps a separate set of cluster
+// keys for each readout cell, and each key is three ints. The same
+// information fits in three arrays:
+
+//   - the ReadoutIDs of the cells that received any clusters, in
+//     ReadoutID order;
+
+//   - for each cell, the offset of its first cluster in the third
+//     array;
+
+//   - the clusters of all the cells, one cell after another. Each
+//     cluster is stored as its index within the event's
+//     ElectronClusters: 0 for the cluster with the smallest key, 1
+//     for the next one, etc. That's the position of the cluster in a
+//     FlatElectronClusters, or the number of steps to reach it when
+//     iterating over an ElectronClusters map.
+
+// This is a lot less to write, read, and allocate. The price is that
+// the map only makes sense together with the clusters of the same
+// tree row; a cluster index can't be used with any other event or
+// segment.
+
+// Iterating over a CompactReadoutMap looks the same as iterating over
+// a ReadoutMap, except that the clusters come as indices:
+
+//    for ( const auto& [ readoutID, indices ] : compactMap ) {
+//      for ( const auto index : indices ) {
+//        const auto& cluster = grams::ClusterAt( flatClusters, index );
+//        ...
+//      }
+//    }
+
+#ifndef _grams_compactreadoutmap_h_
+#define _grams_compactreadoutmap_h_
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+
+#include "ReadoutID.h"
+#include "ElectronClusters.h"
+#include "ReadoutMap.h"
+
+namespace grams {
+
+  class CompactReadoutMap {
+  public:
+
+    typedef unsigned int index_type;
+    typedef std::size_t size_type;
+
+    // The cluster indices of one readout cell. This refers to the
+    // memory of the CompactReadoutMap, and becomes invalid if the map
+    // is changed.
+    class Indices {
+    public:
+      Indices(const index_type* a_begin, const index_type* a_end)
+	: m_begin(a_begin), m_end(a_end) {}
+      const index_type* begin() const { return m_begin; }
+      const index_type* end() const { return m_end; }
+      size_type size() const { return m_end - m_begin; }
+      bool empty() const { return m_begin == m_end; }
+      index_type operator[](size_type i) const { return m_begin[i]; }
+    private:
+      const index_type* m_begin;
+      const index_type* m_end;
+    };
+
+    // What you get for each cell when you iterate over the map; it
+    // has the same (first,second) form as an element of a
+    // ReadoutMap.
+    typedef std::pair< ReadoutID, Indices > value_type;
+
+    // The iterator constructs each value_type as it's needed, so it
+    // can only be used to read the map.
+    class const_iterator {
+    public:
+      const_iterator(const CompactReadoutMap* a_map, size_type a_cell)
+	: m_map(a_map), m_cell(a_cell) {}
+
+      value_type operator*() const { return (*m_map)[m_cell]; }
+
+      // For iterator->first and iterator->second.
+      struct Arrow {
+	value_type value;
+	const value_type* operator->() const { return &value; }
+      };
+      Arrow operator->() const { return Arrow{ **this }; }
+
+      const_iterator& operator++() { ++m_cell; return *this; }
+      const_iterator operator++(int) { auto previous = *this; ++m_cell; return previous; }
+      bool operator==(const const_iterator& a_other) const { return m_cell == a_other.m_cell; }
+      bool operator!=(const const_iterator& a_other) const { return m_cell != a_other.m_cell; }
+
+      // The position of this cell within the map.
+      size_type Cell() const { return m_cell; }
+
+    private:
+      const CompactReadoutMap* m_map;
+      size_type m_cell;
+    };
+    typedef const_iterator iterator;
+
+    CompactReadoutMap() {}
+
+    // The number of readout cells.
+    size_type size() const { return m_readoutIDs.size(); }
+    bool empty() const { return m_readoutIDs.empty(); }
+
+    // The total number of cluster indices in all the cells.
+    size_type NumberOfClusters() const { return m_clusterIndices.size(); }
+
+    // The readout ID and the clusters of cell number 'cell'.
+    value_type operator[](size_type a_cell) const
+    {
+      const index_type* data = m_clusterIndices.data();
+      const size_type last = ( a_cell + 1 < m_offsets.size() )
+	? m_offsets[a_cell + 1] : m_clusterIndices.size();
+      return value_type( m_readoutIDs[a_cell],
+			 Indices( data + m_offsets[a_cell], data + last ) );
+    }
+
+    const_iterator begin() const { return const_iterator( this, 0 ); }
+    const_iterator end() const { return const_iterator( this, size() ); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    // Look up a readout ID with a binary search. Returns end() if no
+    // clusters arrived at that cell.
+    const_iterator find(const ReadoutID& a_readoutID) const
+    {
+      auto i = std::lower_bound( m_readoutIDs.cbegin(), m_readoutIDs.cend(), a_readoutID );
+      if ( i == m_readoutIDs.cend()  ||  a_readoutID < *i )
+	return end();
+      return const_iterator( this, i - m_readoutIDs.cbegin() );
+    }
+
+    // Building a map. Call AddCell() for each readout cell, in
+    // ReadoutID order, then AddCluster() for each of that cell's
+    // clusters, in increasing index order.
+    void clear()
+    {
+      m_readoutIDs.clear();
+      m_offsets.clear();
+      m_clusterIndices.clear();
+    }
+    void reserve(size_type a_cells, size_type a_clusters)
+    {
+      m_readoutIDs.reserve(a_cells);
+      m_offsets.reserve(a_cells);
+      m_clusterIndices.reserve(a_clusters);
+    }
+    void AddCell(const ReadoutID& a_readoutID)
+    {
+      m_readoutIDs.push_back(a_readoutID);
+      m_offsets.push_back( index_type( m_clusterIndices.size() ) );
+    }
+    void AddCluster(index_type a_index) { m_clusterIndices.push_back(a_index); }
+
+    // Convert from a FlatReadoutMap, given the clusters it refers
+    // to. Returns false if the map contains a key that's not in
+    // 'clusters'; those keys are left out.
+    bool Assign(const FlatReadoutMap& readoutMap,
+		const FlatElectronClusters& clusters);
+
+    // Convert to a FlatReadoutMap, given the same clusters that were
+    // used to build this map. 'readoutMap' is overwritten.
+    void ToFlat(const FlatElectronClusters& clusters,
+		FlatReadoutMap& readoutMap) const;
+
+  private:
+
+    // These are the only members written to a ROOT file. Each cell's
+    // clusters go from m_offsets[cell] up to the next cell's offset,
+    // or the end of m_clusterIndices for the last cell.
+    std::vector< ReadoutID > m_readoutIDs;
+    std::vector< index_type > m_offsets;
+    std::vector< index_type > m_clusterIndices;
+  };
+
+  // The cluster with a given index in a FlatElectronClusters.
+  inline const ElectronCluster& ClusterAt(const FlatElectronClusters& a_clusters,
+					  CompactReadoutMap::index_type a_index)
+  {
+    return ( a_clusters.cbegin() + a_index )->second;
+  }
+
+} // namespace grams
+
+// As with the other flat data products, this is outside the namespace.
+std::ostream& operator<< (std::ostream& out, grams::CompactReadoutMap const& rm);
+
+#endif // _grams_compactreadoutmap_h_
@@ -0,0 +1,215 @@
+/// \file CompactReadoutWaveforms.h
+/// \brief The readout waveforms with the empty stretches left out.
+// 16-Oct-2026
+
+// Most of the samples in a ReadoutWaveform are the same: the ADC
+// value for no signal (the baseline) in the digital waveform, and
+// zero in the analog one. A CompactReadoutWaveforms keeps only the
+// regions of interest (ROIs) that differ from that value:
+
+//   - the ReadoutIDs of the cells, in ReadoutID order, and the full
+//     length of each cell's digital and analog waveforms;
+
+//   - for each cell, the number of its first ROI and its first
+//     stored sample, in the same compressed sparse row form as
+//     CompactReadoutMap;
+
+//   - for each ROI, the position of its first sample and the number
+//     of samples;
+
+//   - the samples of all the ROIs, one after another.
+
+// The digital samples are packed into 1, 2, or 4 bytes each: the
+// narrowest of those that holds every sample in the event. For an ADC
+// with a bit_resolution of 8 or less that's a byte, and up to 16 bits
+// it's two. The analog samples are optional, and are stored as float.
+
+// Two ROIs that are only a few samples apart are merged when storing
+// the samples in between takes less space than another ROI. The
+// dense waveforms are built again on request:
+
+//    for ( const auto& [ readoutID, waveform ] : compactWaveforms ) {
+//      for ( const auto adc : waveform.Digital() ) ...
+//    }
+
+// or, to avoid allocating memory for every cell,
+
+//    std::vector<int> digital;
+//    for ( std::size_t cell = 0; cell != compactWaveforms.size(); ++cell ) {
+//      compactWaveforms.Digital( cell, digital );
+//      ...
+//    }
+
+#ifndef _grams_compactreadoutwaveforms_h_
+#define _grams_compactreadoutwaveforms_h_
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+
+#include "ReadoutID.h"
+#include "ReadoutWaveforms.h"
+
+namespace grams {
+
+  class CompactReadoutWaveforms {
+  public:
+
+    typedef unsigned int index_type;
+    typedef std::size_t size_type;
+
+    // The ROIs of one kind of waveform (digital or analog) for all
+    // the cells. The ROIs of a cell are numbered from
+    // firstRegion[cell] up to firstRegion[cell+1] (or the end of
+    // 'start' for the last cell), and its samples begin at
+    // firstSample[cell].
+    struct Regions {
+      std::vector< index_type > firstRegion;
+      std::vector< index_type > firstSample;
+      std::vector< index_type > start;
+      std::vector< index_type > length;
+
+      void clear()
+      {
+	firstRegion.clear();
+	firstSample.clear();
+	start.clear();
+	length.clear();
+      }
+    };
+
+    // What you get for each cell when you iterate: the same
+    // (first,second) form as an element of a ReadoutWaveforms map,
+    // with the dense waveforms built when the iterator is
+    // dereferenced.
+    typedef std::pair< ReadoutID, ReadoutWaveform > value_type;
+
+    class const_iterator {
+    public:
+      const_iterator(const CompactReadoutWaveforms* a_waveforms, size_type a_cell)
+	: m_waveforms(a_waveforms), m_cell(a_cell) {}
+
+      value_type operator*() const
+      {
+	return value_type( m_waveforms->ID(m_cell), m_waveforms->Waveform(m_cell) );
+      }
+
+      const_iterator& operator++() { ++m_cell; return *this; }
+      const_iterator operator++(int) { auto previous = *this; ++m_cell; return previous; }
+      bool operator==(const const_iterator& a_other) const { return m_cell == a_other.m_cell; }
+      bool operator!=(const const_iterator& a_other) const { return m_cell != a_other.m_cell; }
+
+      // The position of this cell within the list.
+      size_type Cell() const { return m_cell; }
+
+    private:
+      const CompactReadoutWaveforms* m_waveforms;
+      size_type m_cell;
+    };
+    typedef const_iterator iterator;
+
+    CompactReadoutWaveforms() {}
+
+    // The number of readout cells.
+    size_type size() const { return m_readoutIDs.size(); }
+    bool empty() const { return m_readoutIDs.empty(); }
+
+    const_iterator begin() const { return const_iterator( this, 0 ); }
+    const_iterator end() const { return const_iterator( this, size() ); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    // Look up a readout ID with a binary search. Returns end() if the
+    // cell has no waveform.
+    const_iterator find(const ReadoutID& a_readoutID) const
+    {
+      auto i = std::lower_bound( m_readoutIDs.cbegin(), m_readoutIDs.cend(), a_readoutID );
+      if ( i == m_readoutIDs.cend()  ||  a_readoutID < *i )
+	return end();
+      return const_iterator( this, i - m_readoutIDs.cbegin() );
+    }
+
+    // The readout ID of cell number 'cell'.
+    const ReadoutID& ID(size_type a_cell) const { return m_readoutIDs[a_cell]; }
+
+    // The digital value outside the ROIs.
+    int Baseline() const { return m_baseline; }
+
+    // The number of bytes used for each digital sample.
+    unsigned int SampleBytes() const { return m_sampleBytes; }
+
+    // Were the analog waveforms kept? If not, Analog() returns
+    // waveforms of zeros.
+    bool HasAnalog() const { return m_hasAnalog; }
+
+    // The ROIs of the digital waveform of a cell, as (first sample,
+    // number of samples).
+    size_type NumberOfRegions(size_type a_cell) const
+    {
+      return m_LastRegion( m_digital, a_cell ) - m_digital.firstRegion[a_cell];
+    }
+    std::pair< index_type, index_type > Region(size_type a_cell, size_type a_region) const
+    {
+      const auto r = m_digital.firstRegion[a_cell] + a_region;
+      return std::make_pair( m_digital.start[r], m_digital.length[r] );
+    }
+
+    // The number of digital and analog samples stored for all the
+    // cells.
+    size_type NumberOfSamples() const { return m_digitalSamples.size() / m_sampleBytes; }
+    size_type NumberOfAnalogSamples() const { return m_analogSamples.size(); }
+
+    // Build the dense waveforms of cell number 'cell'. The versions
+    // that take a vector overwrite it, which avoids allocating memory
+    // if it's reused.
+    void Digital(size_type cell, std::vector<int>& digital) const;
+    void Analog(size_type cell, std::vector<double>& analog) const;
+    ReadoutWaveform Waveform(size_type cell) const;
+
+    void clear();
+
+    // Convert from the dense waveforms. 'baseline' is the digital
+    // value for no signal. If 'keepAnalog' is false, only the
+    // digital waveforms are kept. Analog values whose size is no
+    // more than 'analogThreshold' are treated as zero; this drops
+    // rounding errors (e.g., from an FFT) that would otherwise keep
+    // the whole waveform.
+    void Assign(const FlatReadoutWaveforms& waveforms,
+		int baseline, bool keepAnalog, double analogThreshold = 0.);
+
+    // Convert to the dense waveforms. 'waveforms' is overwritten.
+    void ToFlat(FlatReadoutWaveforms& waveforms) const;
+
+  private:
+
+    // The end of the ROIs of a cell.
+    index_type m_LastRegion(const Regions& a_regions, size_type a_cell) const
+    {
+      return ( a_cell + 1 < a_regions.firstRegion.size() )
+	? a_regions.firstRegion[a_cell + 1] : index_type( a_regions.start.size() );
+    }
+
+    // The digital sample number 'i' of all the stored samples.
+    int m_Sample(size_type i) const;
+
+    // These are the only members written to a ROOT file.
+    std::vector< ReadoutID > m_readoutIDs;
+    std::vector< index_type > m_digitalLengths;
+    std::vector< index_type > m_analogLengths;
+    int m_baseline = 0;
+    unsigned int m_sampleBytes = 1;
+    bool m_hasAnalog = false;
+    Regions m_digital;
+    Regions m_analog;
+    std::vector< unsigned char > m_digitalSamples;
+    std::vector< float > m_analogSamples;
+  };
+
+} // namespace grams
+
+// As with the other data products, this is outside the namespace.
+std::ostream& operator<< (std::ostream& out, grams::CompactReadoutWaveforms const& rws);
+
+#endif // _grams_compactreadoutwaveforms_h_
@@ -7,6 +7,8 @@
 
 #include <Math/Vector4D.h>
 
+#include "FlatMap.h"
+
 #include <iostream>
 #include <map>
 #include <tuple>
@@ -75,6 +77,10 @@ namespace grams {
 
   typedef std::map< std::tuple<int,int,int>, ElectronCluster > ElectronClusters;
 
+  // The same list stored as a sorted vector; see FlatMap.h. It can be
+  // used in the same way as ElectronClusters.
+  typedef FlatMap< std::tuple<int,int,int>, ElectronCluster > FlatElectronClusters;
+
 } // namespace grams
 
 // I prefer to define "write" operators for my custom classes to make
@@ -84,5 +90,6 @@ namespace grams {
 
 std::ostream& operator<< (std::ostream& out, const grams::ElectronCluster& cluster);
 std::ostream& operator<< (std::ostream& out, const grams::ElectronClusters& clusters);
+std::ostream& operator<< (std::ostream& out, const grams::FlatElectronClusters& clusters);
 
 #endif // _grams_electronclusters_h_
@@ -0,0 +1,270 @@
+/// \file FlatMap.h
+/// \brief Sorted-vector replacements for std::map and std::set.
+// 16-Oct-2026
+
+// The data products in GramsDataObj are std::maps. Each element of a
+// std::map is a separately-allocated "node", which costs memory, and
+// ROOT has to re-create every node each time it reads an
+// entry. FlatMap and FlatSet keep their elements in a single
+// std::vector, sorted by key, and find a key with a binary search.
+
+// They have the parts of the std::map and std::set interfaces used in
+// GramsSim, so code like this works with either:
+
+//    for ( const auto& [ key, cluster ] : clusters ) { ... }
+//    auto search = clusters.find( key );
+//    if ( search != clusters.cend() ) { ... search->second ... }
+
+// The differences:
+
+//   - Inserting in the middle of a FlatMap moves every element after
+//     it. Either insert in key order (which is fast), or use
+//     push_back() for all the elements followed by Sort().
+
+//   - Inserting an element may invalidate iterators and references
+//     to the other elements, as with a std::vector.
+
+#ifndef _grams_flatmap_h_
+#define _grams_flatmap_h_
+
+#include <vector>
+#include <map>
+#include <set>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <cstddef>
+
+namespace grams {
+
+  template <typename K, typename V>
+  class FlatMap {
+  public:
+
+    typedef K key_type;
+    typedef V mapped_type;
+    // Unlike std::map, the key is not const; that's what allows the
+    // elements to be sorted in place.
+    typedef std::pair<K,V> value_type;
+    typedef typename std::vector<value_type>::iterator iterator;
+    typedef typename std::vector<value_type>::const_iterator const_iterator;
+    typedef std::size_t size_type;
+
+    FlatMap() {}
+
+    // Copy the contents of a std::map. They're already in key order.
+    explicit FlatMap(const std::map<K,V>& a_map)
+      : m_data( a_map.cbegin(), a_map.cend() ) {}
+
+    iterator begin() { return m_data.begin(); }
+    iterator end() { return m_data.end(); }
+    const_iterator begin() const { return m_data.cbegin(); }
+    const_iterator end() const { return m_data.cend(); }
+    const_iterator cbegin() const { return m_data.cbegin(); }
+    const_iterator cend() const { return m_data.cend(); }
+
+    size_type size() const { return m_data.size(); }
+    bool empty() const { return m_data.empty(); }
+
+    // clear() keeps the memory, so a FlatMap that's re-used for each
+    // event stops allocating once it's reached its largest size.
+    void clear() { m_data.clear(); }
+    void reserve(size_type n) { m_data.reserve(n); }
+
+    // The first element whose key is not less than 'key'.
+    iterator lower_bound(const K& a_key)
+    {
+      return std::lower_bound( m_data.begin(), m_data.end(), a_key, KeyLess() );
+    }
+    const_iterator lower_bound(const K& a_key) const
+    {
+      return std::lower_bound( m_data.cbegin(), m_data.cend(), a_key, KeyLess() );
+    }
+
+    iterator find(const K& a_key)
+    {
+      auto i = lower_bound(a_key);
+      return ( i != m_data.end()  &&  !(a_key < i->first) ) ? i : m_data.end();
+    }
+    const_iterator find(const K& a_key) const
+    {
+      auto i = lower_bound(a_key);
+      return ( i != m_data.cend()  &&  !(a_key < i->first) ) ? i : m_data.cend();
+    }
+
+    size_type count(const K& a_key) const { return ( find(a_key) != cend() ) ? 1 : 0; }
+
+    V& at(const K& a_key)
+    {
+      auto i = find(a_key);
+      if ( i == m_data.end() ) throw std::out_of_range("grams::FlatMap::at");
+      return i->second;
+    }
+    const V& at(const K& a_key) const
+    {
+      auto i = find(a_key);
+      if ( i == m_data.cend() ) throw std::out_of_range("grams::FlatMap::at");
+      return i->second;
+    }
+
+    // As with std::map, create a default element if the key isn't
+    // already present.
+    V& operator[](const K& a_key)
+    {
+      // Fast paths for keys that arrive in order: the key is either
+      // the last one, or goes after it.
+      if ( m_data.empty()  ||  m_data.back().first < a_key ) {
+	m_data.push_back( value_type( a_key, V() ) );
+	return m_data.back().second;
+      }
+      if ( !(a_key < m_data.back().first) )
+	return m_data.back().second;
+
+      auto i = lower_bound(a_key);
+      if ( i == m_data.end()  ||  a_key < i->first )
+	i = m_data.insert( i, value_type( a_key, V() ) );
+      return i->second;
+    }
+
+    // As with std::map, nothing is inserted if the key is already
+    // present.
+    std::pair<iterator,bool> insert(const value_type& a_value)
+    {
+      // Fast path: appending in key order.
+      if ( m_data.empty()  ||  m_data.back().first < a_value.first ) {
+	m_data.push_back(a_value);
+	return std::make_pair( std::prev(m_data.end()), true );
+      }
+      auto i = lower_bound(a_value.first);
+      if ( i != m_data.end()  &&  !(a_value.first < i->first) )
+	return std::make_pair( i, false );
+      return std::make_pair( m_data.insert( i, a_value ), true );
+    }
+
+    // For compatibility with code that inserts into a std::map with a
+    // hint. Only the key order matters here; the hint is ignored.
+    template <typename... Args>
+    iterator emplace_hint(const_iterator, Args&&... a_args)
+    {
+      return insert( value_type( std::forward<Args>(a_args)... ) ).first;
+    }
+
+    // Append an element without looking at the key. After one or
+    // more calls to push_back(), call Sort() before doing anything
+    // that depends on the key order.
+    void push_back(const value_type& a_value) { m_data.push_back(a_value); }
+    void push_back(value_type&& a_value) { m_data.push_back( std::move(a_value) ); }
+
+    // Put the elements in key order. If a key appears more than
+    // once, only the first one added is kept, as if each element had
+    // been inserted with insert().
+    void Sort()
+    {
+      std::stable_sort( m_data.begin(), m_data.end(),
+			[](const value_type& a, const value_type& b) { return a.first < b.first; } );
+      auto last = std::unique( m_data.begin(), m_data.end(),
+			       [](const value_type& a, const value_type& b) { return !(a.first < b.first); } );
+      m_data.erase( last, m_data.end() );
+    }
+
+    // Copy to or from a std::map, re-using this object's memory.
+    void Assign(const std::map<K,V>& a_map) { m_data.assign( a_map.cbegin(), a_map.cend() ); }
+    std::map<K,V> ToMap() const { return std::map<K,V>( m_data.cbegin(), m_data.cend() ); }
+
+  private:
+
+    // Compare an element to a key, for the binary search.
+    struct KeyLess {
+      bool operator()(const value_type& a_value, const K& a_key) const { return a_value.first < a_key; }
+    };
+
+    // The elements, in key order. This is the only member that's
+    // written to a ROOT file.
+    std::vector<value_type> m_data;
+  };
+
+  template <typename K>
+  class FlatSet {
+  public:
+
+    typedef K key_type;
+    typedef K value_type;
+    // Like std::set, the elements can't be changed through an
+    // iterator, since that could spoil the order.
+    typedef typename std::vector<K>::const_iterator iterator;
+    typedef typename std::vector<K>::const_iterator const_iterator;
+    typedef std::size_t size_type;
+
+    FlatSet() {}
+
+    // Copy the contents of a std::set. They're already in order.
+    explicit FlatSet(const std::set<K>& a_set)
+      : m_data( a_set.cbegin(), a_set.cend() ) {}
+
+    const_iterator begin() const { return m_data.cbegin(); }
+    const_iterator end() const { return m_data.cend(); }
+    const_iterator cbegin() const { return m_data.cbegin(); }
+    const_iterator cend() const { return m_data.cend(); }
+
+    size_type size() const { return m_data.size(); }
+    bool empty() const { return m_data.empty(); }
+    void clear() { m_data.clear(); }
+    void reserve(size_type n) { m_data.reserve(n); }
+
+    const_iterator find(const K& a_key) const
+    {
+      auto i = std::lower_bound( m_data.cbegin(), m_data.cend(), a_key );
+      return ( i != m_data.cend()  &&  !(a_key < *i) ) ? i : m_data.cend();
+    }
+
+    size_type count(const K& a_key) const { return ( find(a_key) != cend() ) ? 1 : 0; }
+
+    std::pair<const_iterator,bool> insert(const K& a_key)
+    {
+      // Fast path: appending in order.
+      if ( m_data.empty()  ||  m_data.back() < a_key ) {
+	m_data.push_back(a_key);
+	return std::make_pair( std::prev(m_data.cend()), true );
+      }
+      auto i = std::lower_bound( m_data.begin(), m_data.end(), a_key );
+      if ( i != m_data.end()  &&  !(a_key < *i) )
+	return std::make_pair( const_iterator(i), false );
+      return std::make_pair( const_iterator( m_data.insert( i, a_key ) ), true );
+    }
+
+    // See FlatMap::push_back() and FlatMap::Sort().
+    void push_back(const K& a_key) { m_data.push_back(a_key); }
+    void Sort()
+    {
+      std::sort( m_data.begin(), m_data.end() );
+      m_data.erase( std::unique( m_data.begin(), m_data.end() ), m_data.end() );
+    }
+
+    void Assign(const std::set<K>& a_set) { m_data.assign( a_set.cbegin(), a_set.cend() ); }
+    std::set<K> ToSet() const { return std::set<K>( m_data.cbegin(), m_data.cend() ); }
+
+  private:
+
+    // The elements, in order. This is the only member that's written
+    // to a ROOT file.
+    std::vector<K> m_data;
+  };
+
+  // Convert between the std::map-based data products and their flat
+  // equivalents. 'out' is overwritten. There are overloads for
+  // products with nested containers (see ReadoutMap.h).
+  template <typename K, typename V>
+  void Convert(const std::map<K,V>& in, FlatMap<K,V>& out) { out.Assign(in); }
+
+  template <typename K, typename V>
+  void Convert(const FlatMap<K,V>& in, std::map<K,V>& out)
+  {
+    out.clear();
+    for ( const auto& element : in )
+      out.emplace_hint( out.end(), element );
+  }
+
+} // namespace grams
+
+#endif // _grams_flatmap_h_
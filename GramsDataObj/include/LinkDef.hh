@@ -66,6 +66,64 @@
 #pragma link C++ class grams::ReadoutWaveform+;
 #pragma link C++ function operator<<(std::ostream&, const grams::ReadoutWaveform&)+;
 
+// The flat (sorted-vector) versions of the above; see FlatMap.h. ROOT
+// needs the element types as well as the containers.
+#pragma link C++ class std::pair< std::tuple<int,int>, grams::MCLArHit >+;
+#pragma link C++ class std::vector< std::pair< std::tuple<int,int>, grams::MCLArHit > >+;
+#pragma link C++ class grams::FlatMap< std::tuple<int,int>, grams::MCLArHit >+;
+#pragma link C++ typedef grams::FlatMCLArHits;
+#pragma link C++ function operator<<(std::ostream&, const grams::FlatMCLArHits&)+;
+
+#pragma link C++ class std::pair< std::tuple<int,int>, grams::MCScintHit >+;
+#pragma link C++ class std::vector< std::pair< std::tuple<int,int>, grams::MCScintHit > >+;
+#pragma link C++ class grams::FlatMap< std::tuple<int,int>, grams::MCScintHit >+;
+#pragma link C++ typedef grams::FlatMCScintHits;
+#pragma link C++ function operator<<(std::ostream&, const grams::FlatMCScintHits&)+;
+
+#pragma link C++ class std::pair< std::tuple<int,int,int>, grams::ElectronCluster >+;
+#pragma link C++ class std::vector< std::pair< std::tuple<int,int,int>, grams::ElectronCluster > >+;
+#pragma link C++ class grams::FlatMap< std::tuple<int,int,int>, grams::ElectronCluster >+;
+#pragma link C++ typedef grams::FlatElectronClusters;
+#pragma link C++ function operator<<(std::ostream&, const grams::FlatElectronClusters&)+;
+
+#pragma link C++ class std::vector< std::tuple<int,int,int> >+;
+#pragma link C++ class grams::FlatSet< std::tuple<int,int,int> >+;
+#pragma link C++ typedef grams::FlatClusterKeys;
+#pragma link C++ function operator<<(std::ostream&, const grams::FlatClusterKeys&)+;
+#pragma link C++ class std::pair< grams::ReadoutID, grams::FlatSet< std::tuple<int,int,int> > >+;
+#pragma link C++ class std::vector< std::pair< grams::ReadoutID, grams::FlatSet< std::tuple<int,int,int> > > >+;
+#pragma link C++ class grams::FlatMap< grams::ReadoutID, grams::FlatSet< std::tuple<int,int,int> > >+;
+#pragma link C++ typedef grams::FlatReadoutMap;
+#pragma link C++ function operator<<(std::ostream&, const grams::FlatReadoutMap&)+;
+
+#pragma link C++ class std::pair< grams::ReadoutID, grams::ReadoutWaveform >+;
+#pragma link C++ class std::vector< std::pair< grams::ReadoutID, grams::ReadoutWaveform > >+;
+#pragma link C++ class grams::FlatMap< grams::ReadoutID, grams::ReadoutWaveform >+;
+#pragma link C++ typedef grams::FlatReadoutWaveforms;
+#pragma link C++ function operator<<(std::ostream&, const grams::FlatReadoutWaveforms&)+;
+
+// The readout map in compressed sparse row form; see
+// CompactReadoutMap.h. Only its vectors are written.
+#pragma link C++ class std::vector< grams::ReadoutID >+;
+#pragma link C++ class std::vector< unsigned int >+;
+#pragma link C++ class grams::CompactReadoutMap+;
+#pragma link C++ function operator<<(std::ostream&, const grams::CompactReadoutMap&)+;
+
+// The readout waveforms with only their regions of interest; see
+// CompactReadoutWaveforms.h.
+#pragma link C++ class std::vector< unsigned char >+;
+#pragma link C++ class std::vector< float >+;
+#pragma link C++ struct grams::CompactReadoutWaveforms::Regions+;
+#pragma link C++ class grams::CompactReadoutWaveforms+;
+#pragma link C++ function operator<<(std::ostream&, const grams::CompactReadoutWaveforms&)+;
+
+// The description of the pixel readout written by gramsreadoutsim.
+#pragma link C++ struct grams::AnodeTile+;
+#pragma link C++ class std::vector< grams::AnodeTile >+;
+#pragma link C++ class grams::PixelGeometry+;
+#pragma link C++ function operator<<(std::ostream&, const grams::AnodeTile&)+;
+#pragma link C++ function operator<<(std::ostream&, const grams::PixelGeometry&)+;
+
 // The following statements may not be necessary, but I include them
 // for "safety"; see
 // https://root.cern.ch/root/htmldoc/guides/users-guide/AddingaClass.html
@@ -7,6 +7,8 @@
 
 #include <Math/Vector4D.h>
 
+#include "FlatMap.h"
+
 #include <iostream>
 #include <map>
 #include <tuple>
@@ -91,6 +93,10 @@ namespace grams {
 
   typedef std::map< std::tuple<int,int>, MCLArHit > MCLArHits;
 
+  // The same list stored as a sorted vector; see FlatMap.h. It can be
+  // used in the same way as MCLArHits.
+  typedef FlatMap< std::tuple<int,int>, MCLArHit > FlatMCLArHits;
+
 } // namespace grams
 
 // I prefer to define "write" operators for my custom classes to make
@@ -100,5 +106,6 @@ namespace grams {
 
 std::ostream& operator<< (std::ostream& out, const grams::MCLArHit& mcLArHit);
 std::ostream& operator<< (std::ostream& out, const grams::MCLArHits& mcLArHits);
+std::ostream& operator<< (std::ostream& out, const grams::FlatMCLArHits& mcLArHits);
 
 #endif // _grams_mclarhits_h_
@@ -7,6 +7,8 @@
 
 #include <Math/Vector4D.h>
 
+#include "FlatMap.h"
+
 #include <iostream>
 #include <map>
 
@@ -82,6 +84,10 @@ namespace grams {
 
   typedef std::map< std::tuple<int,int>, MCScintHit > MCScintHits;
 
+  // The same list stored as a sorted vector; see FlatMap.h. It can be
+  // used in the same way as MCScintHits.
+  typedef FlatMap< std::tuple<int,int>, MCScintHit > FlatMCScintHits;
+
 } // namespace grams
 
 // I prefer to define "write" operators for my custom classes to make
@@ -91,5 +97,6 @@ namespace grams {
 
 std::ostream& operator<< (std::ostream& out, const grams::MCScintHit& mcScintHit);
 std::ostream& operator<< (std::ostream& out, const grams::MCScintHits& mcScintHits);
+std::ostream& operator<< (std::ostream& out, const grams::FlatMCScintHits& mcScintHits);
 
 #endif // _grams_mcscinthits_h_
@@ -0,0 +1,129 @@
+/// \file PixelGeometry.h
+/// \brief A small description of the pixel readout geometry.
+// 16-Oct-2026
+
+// GramsReadoutSim needs only a few numbers from the detector
+// geometry: the size of the anode, and how it's divided into
+// pixels. Finding them means importing the entire GDML file and
+// searching through every volume in it, which can take longer than
+// the rest of a short job.
+
+// This object holds those numbers. gramsreadoutsim writes it to its
+// output file, next to the copied geometry, under the name
+// "PixelGeometry". A later job can read it from that file (see the
+// pixelGeometryFile option) and skip the GDML import.
+
+// It isn't a per-event data product; there's one per file.
+
+#ifndef _grams_pixelgeometry_h_
+#define _grams_pixelgeometry_h_
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace grams {
+
+  // One rectangular tile of pixels on the anode. "X" and "Y" are
+  // the anode's two coordinates across the drift (see
+  // util/include/DriftAxis.h): (x,y) for the default drift along z,
+  // (y,z) for a drift along x, (z,x) for a drift along y.
+  struct AnodeTile {
+
+    // The center of the tile, as placed in the geometry. The
+    // options readout_centerx and readout_centery are added to this
+    // when the clusters are assigned.
+    double centerX = 0.;
+    double centerY = 0.;
+
+    // The full widths of the tile.
+    double sizeX = 0.;
+    double sizeY = 0.;
+
+    // The number of pixels along each direction.
+    int numPixelsX = 0;
+    int numPixelsY = 0;
+
+    double PitchX() const { return sizeX / numPixelsX; }
+    double PitchY() const { return sizeY / numPixelsY; }
+  };
+
+  class PixelGeometry {
+
+  public:
+
+    // Increase this if the meaning of the fields changes, so that an
+    // old descriptor isn't mistaken for a new one. (ROOT's schema
+    // evolution takes care of fields that are only added.)
+    static constexpr int CurrentVersion = 2;
+
+    int version = CurrentVersion;
+
+    // Where the description came from: the GDML file and the pattern
+    // used to find the anode volume(s) in it. A descriptor only
+    // replaces the GDML import if these match the job's options.
+    std::string gdmlFile;
+    std::string anodeVolume;
+
+    // The contents of 'gdmlFile' when the description was made: its
+    // size in bytes, and a 64-bit FNV-1a hash of its bytes. The file
+    // name alone (usually the default "parsed.gdml") says nothing
+    // about which geometry GramsG4 last wrote to it.
+    std::uint64_t gdmlSize = 0;
+    std::uint64_t gdmlHash = 0;
+
+    // If false, the anode is the first volume that matched
+    // anodeVolume, and its one tile is centered at (0,0). If true,
+    // there's a tile for every placement that matched, at its
+    // position in the geometry.
+    bool multipleTiles = false;
+
+    // The axis the electrons drift along (the DriftCoordinate
+    // option: 0=x, 1=y, 2=z). The anode, and so the tiles, are in
+    // the plane across it.
+    int driftCoordinate = 2;
+
+    // The tiles of pixels. The index of a tile in this vector is the
+    // tile number in grams::ReadoutID.
+    std::vector< AnodeTile > tiles;
+
+    // The options readout_centerx and readout_centery of the job that
+    // made this descriptor. Like the number of pixels in each tile,
+    // these always come from the job's options, not from a saved
+    // descriptor; they're kept so that two jobs can check that they
+    // use the same pixels (see SameGrid below).
+    double readoutCenterX = 0.;
+    double readoutCenterY = 0.;
+
+    // Can this descriptor be used in place of importing 'gdmlFile'
+    // and searching it for 'anodeVolume'? The file's contents must
+    // be the same as when the descriptor was made.
+    bool Matches(const std::string& a_gdmlFile, std::uint64_t a_gdmlSize, std::uint64_t a_gdmlHash,
+		 const std::string& a_anodeVolume,
+		 bool a_multipleTiles, int a_driftCoordinate) const
+    {
+      return version == CurrentVersion
+	&& gdmlFile == a_gdmlFile
+	&& gdmlSize == a_gdmlSize
+	&& gdmlHash == a_gdmlHash
+	&& anodeVolume == a_anodeVolume
+	&& multipleTiles == a_multipleTiles
+	&& driftCoordinate == a_driftCoordinate
+	&& ! tiles.empty();
+    }
+
+    // Do this descriptor and 'other' divide the anode into the same
+    // pixels: the same drift axis, the same tiles, the same number of pixels in each, and
+    // the same readout center? Lengths are compared to within a
+    // small fraction of the tile sizes.
+    bool SameGrid(const PixelGeometry& other) const;
+  };
+
+} // namespace grams
+
+// See ReadoutMap.h for why these are outside the namespace.
+std::ostream& operator<< (std::ostream& out, grams::AnodeTile const& tile);
+std::ostream& operator<< (std::ostream& out, grams::PixelGeometry const& pg);
+
+#endif // _grams_pixelgeometry_h_
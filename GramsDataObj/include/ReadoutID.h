@@ -21,6 +21,7 @@
 
 #include <iostream>
 #include <limits>
+#include <cstdint>
 
 namespace grams {
 
@@ -33,12 +34,15 @@ namespace grams {
     ReadoutID()
       : x_index( std::numeric_limits<int>::min() )
       , y_index( std::numeric_limits<int>::min() )
+      , tile_index( 0 )
     {}
 
-    // Most likely constructor: Set the values explicitly.
-    ReadoutID( int a_x_index, int a_y_index )
+    // Most likely constructor: Set the values explicitly. An anode
+    // with a single tile of pixels only needs (x,y).
+    ReadoutID( int a_x_index, int a_y_index, int a_tile_index = 0 )
       : x_index( a_x_index )
       , y_index( a_y_index )
+      , tile_index( a_tile_index )
     {}
 
     // In EventID, we assigned each ID a unique index. We do the same
@@ -51,26 +55,44 @@ namespace grams {
 
     int Index() const {
       // Note that this scheme assumes that a given readout geometry
-      // won't have more than 1000000 divisions.
+      // won't have more than 1000000 divisions. The index is only
+      // unique within a tile; the operators below compare the tile
+      // first.
       return y_index*1000000 + x_index;
     }
 
+    // A 32-bit number for the cell within its tile, for things like
+    // choosing a random-number stream. It's Index() as an unsigned
+    // number. It does not include the tile; pass Tile() separately
+    // (e.g., to util::RandomService::SetStream) to tell cells in
+    // different tiles apart.
+    uint32_t Key() const {
+      return uint32_t( Index() );
+    }
+
     // Folks working on CNNs will want to have simple access to (X,Y)
     // channel numbers.
     int X() const { return x_index; }
     int Y() const { return y_index; }
 
+    // The anode tile that contains the cell; (X,Y) are numbered
+    // within the tile. See GramsReadoutSim/README.md.
+    int Tile() const { return tile_index; }
+
     // Since we may want to sort by ReadoutID (for maps and such),
     // define the "less-than" operator. 
     bool operator<(const ReadoutID& e) const
     {
+      if ( this->tile_index != e.tile_index )
+	return this->tile_index < e.tile_index;
       return this->Index() < e.Index();
     }
 
     // Test for equality, just in case.. 
     bool operator==(const ReadoutID& e) const
     {
-      return this->Index() == e.Index();
+      return this->tile_index == e.tile_index
+	&& this->Index() == e.Index();
     }
 
   private:
@@ -79,6 +101,9 @@ namespace grams {
     int x_index;   
     int y_index;   
 
+    // Added Oct-2026. In files written before then, it's 0.
+    int tile_index;
+
     // I prefer to include "write" operators for my custom classes to make
     // it easier to examine their contents. For ROOT's dictionary
     // definition to function properly, this must be located outside of
@@ -86,6 +111,8 @@ namespace grams {
     friend ::std::ostream& operator<< (std::ostream& out, grams::ReadoutID const& e) {
       out << "x-index=" << e.x_index
 	  << " y-index=" << e.y_index;
+      if ( e.tile_index != 0 )
+	out << " tile=" << e.tile_index;
       return out;
     }
 
@@ -19,6 +19,7 @@
 
 #include "ReadoutID.h"
 #include "ElectronClusters.h"
+#include "FlatMap.h"
 
 namespace grams {
 
@@ -37,6 +38,18 @@ namespace grams {
 
   typedef std::map< ReadoutID, ClusterKeys > ReadoutMap;
 
+  // The same lists stored as sorted vectors; see FlatMap.h. They can
+  // be used in the same way as ClusterKeys and ReadoutMap.
+  typedef FlatSet< ElectronClusters::key_type > FlatClusterKeys;
+
+  typedef FlatMap< ReadoutID, FlatClusterKeys > FlatReadoutMap;
+
+  // Since the elements of a ReadoutMap are containers themselves,
+  // converting to and from FlatReadoutMap needs its own routines. See
+  // Convert() in FlatMap.h.
+  void Convert(const ReadoutMap& in, FlatReadoutMap& out);
+  void Convert(const FlatReadoutMap& in, ReadoutMap& out);
+
 
   // I prefer to define "write" operators for my custom classes to make
   // it easier to examine their contents. For these to work in ROOT's
@@ -48,4 +61,11 @@ namespace grams {
 
 } // namespace grams
 
+// Unlike the two above, these are outside the namespace; otherwise a
+// FlatClusterKeys, which is itself in namespace grams, would find two
+// different versions of operator<<.
+
+std::ostream& operator<< (std::ostream& out, grams::FlatClusterKeys const& ck);
+std::ostream& operator<< (std::ostream& out, grams::FlatReadoutMap const& rm);
+
 #endif // _grams_readoutmap_h_
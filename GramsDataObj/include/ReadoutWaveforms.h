@@ -7,6 +7,7 @@
 
 // From GramsDataObj
 #include "ReadoutID.h"
+#include "FlatMap.h"
 
 #include <iostream>
 #include <map>
@@ -49,6 +50,10 @@ namespace grams {
 
   typedef std::map< ReadoutID, ReadoutWaveform > ReadoutWaveforms;
 
+  // The same list stored as a sorted vector; see FlatMap.h. It can be
+  // used in the same way as ReadoutWaveforms.
+  typedef FlatMap< ReadoutID, ReadoutWaveform > FlatReadoutWaveforms;
+
 } // namespace grams
 
 // I prefer to define "write" operators for my custom classes to make
@@ -58,5 +63,6 @@ namespace grams {
 
 std::ostream& operator<< (std::ostream& out, const grams::ReadoutWaveform& rw);
 std::ostream& operator<< (std::ostream& out, const grams::ReadoutWaveforms& rws);
+std::ostream& operator<< (std::ostream& out, const grams::FlatReadoutWaveforms& rws);
 
 #endif // _grams_readoutwaveforms_h_
@@ -0,0 +1,61 @@
+/// \file CompactReadoutMap.cc
+/// \brief Conversions between CompactReadoutMap and FlatReadoutMap.
+// 16-Oct-2026
+
+#include "CompactReadoutMap.h"
+#include "ReadoutMap.h"
+#include "ElectronClusters.h"
+
+#include <iostream>
+
+std::ostream& operator<< (std::ostream& out, grams::CompactReadoutMap const& rm) {
+  for ( const auto& [ readoutID, indices ] : rm ) {
+    out << readoutID << std::endl;
+    for ( const auto index : indices )
+      out << "  cluster index=" << index << std::endl;
+    out << std::endl;
+  }
+  return out;
+}
+
+namespace grams {
+
+  bool CompactReadoutMap::Assign(const FlatReadoutMap& a_readoutMap,
+				 const FlatElectronClusters& a_clusters)
+  {
+    clear();
+    size_type numberOfKeys = 0;
+    for ( const auto& [ readoutID, clusterKeys ] : a_readoutMap )
+      numberOfKeys += clusterKeys.size();
+    reserve( a_readoutMap.size(), numberOfKeys );
+
+    bool allFound = true;
+    for ( const auto& [ readoutID, clusterKeys ] : a_readoutMap ) {
+      AddCell( readoutID );
+      for ( const auto& clusterKey : clusterKeys ) {
+	const auto search = a_clusters.find( clusterKey );
+	if ( search == a_clusters.cend() ) {
+	  allFound = false;
+	  continue;
+	}
+	AddCluster( index_type( search - a_clusters.cbegin() ) );
+      }
+    }
+    return allFound;
+  }
+
+  void CompactReadoutMap::ToFlat(const FlatElectronClusters& a_clusters,
+				 FlatReadoutMap& a_readoutMap) const
+  {
+    a_readoutMap.clear();
+    a_readoutMap.reserve( size() );
+    for ( const auto& [ readoutID, indices ] : *this ) {
+      auto& clusterKeys = a_readoutMap[ readoutID ];
+      // Within a cell the indices are in increasing order, so the
+      // keys are appended in order.
+      for ( const auto index : indices )
+	clusterKeys.insert( ( a_clusters.cbegin() + index )->first );
+    }
+  }
+
+} // namespace grams
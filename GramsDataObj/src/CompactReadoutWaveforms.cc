@@ -0,0 +1,214 @@
+/// \file CompactReadoutWaveforms.cc
+/// \brief Conversions between CompactReadoutWaveforms and FlatReadoutWaveforms.
+// 16-Oct-2026
+
+#include "CompactReadoutWaveforms.h"
+#include "ReadoutWaveforms.h"
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+std::ostream& operator<< (std::ostream& out, grams::CompactReadoutWaveforms const& rws) {
+  std::vector<int> digital;
+  for ( std::size_t cell = 0; cell != rws.size(); ++cell ) {
+    out << rws.ID(cell) << std::endl;
+    rws.Digital( cell, digital );
+    out << "   Digital nbins=" << digital.size()
+	<< " baseline=" << rws.Baseline() << ":";
+    for ( std::size_t r = 0; r != rws.NumberOfRegions(cell); ++r ) {
+      const auto [ start, length ] = rws.Region( cell, r );
+      out << " [" << start << "]";
+      for ( auto i = start; i != start + length; ++i )
+	out << " " << digital[i];
+    }
+    out << std::endl << std::endl;
+  }
+  return out;
+}
+
+namespace grams {
+
+  namespace {
+
+    // Add the ROIs of one waveform of 'length' samples to 'regions'.
+    // isSignal(i) tells whether sample i differs from the empty
+    // value, and store(i) is called for each sample that's kept, in
+    // order. Gaps of up to 'maxGap' samples between two ROIs are
+    // kept to join them. Returns the number of samples kept.
+    template <typename IsSignal, typename Store>
+    std::size_t AddRegions(std::size_t a_length, std::size_t a_maxGap,
+			   std::size_t a_samplesSoFar,
+			   CompactReadoutWaveforms::Regions& a_regions,
+			   IsSignal a_isSignal, Store a_store)
+    {
+      typedef CompactReadoutWaveforms::index_type index_type;
+      a_regions.firstRegion.push_back( index_type( a_regions.start.size() ) );
+      a_regions.firstSample.push_back( index_type( a_samplesSoFar ) );
+
+      std::size_t kept = 0;
+      std::size_t i = 0;
+      while ( i < a_length ) {
+	if ( ! a_isSignal(i) ) {
+	  ++i;
+	  continue;
+	}
+
+	// Extend the ROI as long as the next signal is close enough.
+	std::size_t last = i + 1;
+	for (;;) {
+	  std::size_t next = last;
+	  while ( next < a_length  &&  next - last <= a_maxGap  &&  ! a_isSignal(next) )
+	    ++next;
+	  if ( next < a_length  &&  next - last <= a_maxGap )
+	    last = next + 1;
+	  else
+	    break;
+	}
+
+	a_regions.start.push_back( index_type(i) );
+	a_regions.length.push_back( index_type( last - i ) );
+	for ( ; i != last; ++i )
+	  a_store(i);
+	kept += a_regions.length.back();
+      }
+      return kept;
+    }
+
+    // The cost of another ROI, in bytes: its start and length.
+    constexpr std::size_t regionBytes = 2 * sizeof(CompactReadoutWaveforms::index_type);
+
+  } // anonymous namespace
+
+  void CompactReadoutWaveforms::clear()
+  {
+    m_readoutIDs.clear();
+    m_digitalLengths.clear();
+    m_analogLengths.clear();
+    m_digital.clear();
+    m_analog.clear();
+    m_digitalSamples.clear();
+    m_analogSamples.clear();
+  }
+
+  void CompactReadoutWaveforms::Assign(const FlatReadoutWaveforms& a_waveforms,
+				       int a_baseline, bool a_keepAnalog,
+				       double a_analogThreshold)
+  {
+    clear();
+    m_baseline = a_baseline;
+    m_hasAnalog = a_keepAnalog;
+
+    // The narrowest sample size that holds every digital value.
+    int minimum = a_baseline;
+    int maximum = a_baseline;
+    for ( const auto& [ readoutID, waveform ] : a_waveforms ) {
+      for ( const auto value : waveform.digital ) {
+	minimum = std::min( minimum, value );
+	maximum = std::max( maximum, value );
+      }
+    }
+    if ( minimum >= 0  &&  maximum <= int( std::numeric_limits<std::uint8_t>::max() ) )
+      m_sampleBytes = 1;
+    else if ( minimum >= 0  &&  maximum <= int( std::numeric_limits<std::uint16_t>::max() ) )
+      m_sampleBytes = 2;
+    else
+      m_sampleBytes = 4;
+
+    const auto numberOfCells = a_waveforms.size();
+    m_readoutIDs.reserve( numberOfCells );
+    m_digitalLengths.reserve( numberOfCells );
+    m_analogLengths.reserve( numberOfCells );
+    m_digital.firstRegion.reserve( numberOfCells );
+    m_digital.firstSample.reserve( numberOfCells );
+    if ( m_hasAnalog ) {
+      m_analog.firstRegion.reserve( numberOfCells );
+      m_analog.firstSample.reserve( numberOfCells );
+    }
+
+    std::size_t digitalSamples = 0;
+    std::size_t analogSamples = 0;
+    for ( const auto& [ readoutID, waveform ] : a_waveforms ) {
+      m_readoutIDs.push_back( readoutID );
+      m_digitalLengths.push_back( index_type( waveform.digital.size() ) );
+      m_analogLengths.push_back( index_type( waveform.analog.size() ) );
+
+      const auto& digital = waveform.digital;
+      digitalSamples +=
+	AddRegions( digital.size(), regionBytes / m_sampleBytes, digitalSamples, m_digital,
+		    [&]( std::size_t i ) { return digital[i] != a_baseline; },
+		    [&]( std::size_t i ) {
+		      // Little-endian, so the file doesn't depend on
+		      // the machine.
+		      const auto value = std::uint32_t( digital[i] );
+		      for ( unsigned int b = 0; b != m_sampleBytes; ++b )
+			m_digitalSamples.push_back( (unsigned char)( value >> ( 8 * b ) ) );
+		    } );
+
+      if ( m_hasAnalog ) {
+	const auto& analog = waveform.analog;
+	analogSamples +=
+	  AddRegions( analog.size(), regionBytes / sizeof(float), analogSamples, m_analog,
+		      [&]( std::size_t i ) { return std::abs( analog[i] ) > a_analogThreshold; },
+		      [&]( std::size_t i ) { m_analogSamples.push_back( float( analog[i] ) ); } );
+      }
+    }
+  }
+
+  int CompactReadoutWaveforms::m_Sample(size_type a_i) const
+  {
+    const unsigned char* bytes = m_digitalSamples.data() + a_i * m_sampleBytes;
+    std::uint32_t value = 0;
+    for ( unsigned int b = 0; b != m_sampleBytes; ++b )
+      value |= std::uint32_t( bytes[b] ) << ( 8 * b );
+    // Only 4-byte samples can be negative.
+    return int( std::int32_t( value ) );
+  }
+
+  void CompactReadoutWaveforms::Digital(size_type a_cell, std::vector<int>& a_digital) const
+  {
+    a_digital.assign( m_digitalLengths[a_cell], m_baseline );
+    size_type sample = m_digital.firstSample[a_cell];
+    const auto last = m_LastRegion( m_digital, a_cell );
+    for ( auto r = m_digital.firstRegion[a_cell]; r != last; ++r ) {
+      const auto start = m_digital.start[r];
+      for ( index_type i = 0; i != m_digital.length[r]; ++i )
+	a_digital[ start + i ] = m_Sample( sample++ );
+    }
+  }
+
+  void CompactReadoutWaveforms::Analog(size_type a_cell, std::vector<double>& a_analog) const
+  {
+    a_analog.assign( m_analogLengths[a_cell], 0. );
+    if ( ! m_hasAnalog ) return;
+    const float* sample = m_analogSamples.data() + m_analog.firstSample[a_cell];
+    const auto last = m_LastRegion( m_analog, a_cell );
+    for ( auto r = m_analog.firstRegion[a_cell]; r != last; ++r ) {
+      const auto start = m_analog.start[r];
+      for ( index_type i = 0; i != m_analog.length[r]; ++i )
+	a_analog[ start + i ] = *sample++;
+    }
+  }
+
+  ReadoutWaveform CompactReadoutWaveforms::Waveform(size_type a_cell) const
+  {
+    ReadoutWaveform waveform;
+    waveform.readoutID = m_readoutIDs[a_cell];
+    Analog( a_cell, waveform.analog );
+    Digital( a_cell, waveform.digital );
+    return waveform;
+  }
+
+  void CompactReadoutWaveforms::ToFlat(FlatReadoutWaveforms& a_waveforms) const
+  {
+    a_waveforms.clear();
+    a_waveforms.reserve( size() );
+    // The cells are in ReadoutID order, so each is appended.
+    for ( size_type cell = 0; cell != size(); ++cell )
+      a_waveforms.insert( std::make_pair( m_readoutIDs[cell], Waveform(cell) ) );
+  }
+
+} // namespace grams
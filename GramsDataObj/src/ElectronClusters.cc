@@ -36,3 +36,13 @@ std::ostream& operator<< (std::ostream& out, const grams::ElectronClusters& clus
   
   return out;
 }
+
+std::ostream& operator<< (std::ostream& out, const grams::FlatElectronClusters& clusters) {
+
+  for ( const auto& [ key, cluster ] : clusters ) {
+    out << cluster;
+  }
+  out << std::endl;
+  
+  return out;
+}
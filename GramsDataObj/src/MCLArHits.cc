@@ -46,3 +46,13 @@ std::ostream& operator<< (std::ostream& out, const grams::MCLArHits& hits) {
   
   return out;
 }
+
+std::ostream& operator<< (std::ostream& out, const grams::FlatMCLArHits& hits) {
+
+  for ( const auto& [ key, mcLArHit ] : hits ) {
+    out << mcLArHit;
+  }
+  out << std::endl;
+  
+  return out;
+}
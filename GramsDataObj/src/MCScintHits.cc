@@ -43,3 +43,13 @@ std::ostream& operator<< (std::ostream& out, const grams::MCScintHits& hits) {
   
   return out;
 }
+
+std::ostream& operator<< (std::ostream& out, const grams::FlatMCScintHits& hits) {
+  
+  for ( const auto& [ key, mcScintHit ] : hits ) {
+    out << mcScintHit;
+  }
+  out << std::endl;
+  
+  return out;
+}
@@ -0,0 +1,59 @@
+/// \file PixelGeometry.cc
+/// \brief How to display and compare a PixelGeometry.
+// 16-Oct-2026
+
+#include "PixelGeometry.h"
+
+#include <iostream>
+#include <cmath>
+#include <cstddef>
+
+namespace grams {
+
+  bool PixelGeometry::SameGrid(const PixelGeometry& a_other) const
+  {
+    if ( multipleTiles != a_other.multipleTiles  ||  driftCoordinate != a_other.driftCoordinate
+	 ||  tiles.size() != a_other.tiles.size() )
+      return false;
+
+    // The tile positions come from the GDML file, and may have been
+    // through a unit conversion or two.
+    const auto close = [&]( double a_x, double a_y, double a_size ) {
+      return std::abs( a_x - a_y ) <= 1.e-9 * a_size;
+    };
+
+    for ( std::size_t i = 0; i != tiles.size(); ++i ) {
+      const auto& tile = tiles[i];
+      const auto& other = a_other.tiles[i];
+      const double size = std::abs(tile.sizeX) + std::abs(tile.sizeY);
+      if ( tile.numPixelsX != other.numPixelsX  ||  tile.numPixelsY != other.numPixelsY
+	   ||  ! close( tile.sizeX, other.sizeX, size )
+	   ||  ! close( tile.sizeY, other.sizeY, size )
+	   ||  ! close( tile.centerX + readoutCenterX, other.centerX + a_other.readoutCenterX, size )
+	   ||  ! close( tile.centerY + readoutCenterY, other.centerY + a_other.readoutCenterY, size ) )
+	return false;
+    }
+    return true;
+  }
+
+} // namespace grams
+
+std::ostream& operator<< (std::ostream& out, grams::AnodeTile const& tile) {
+  out << "center=(" << tile.centerX << "," << tile.centerY << ")"
+      << " size=(" << tile.sizeX << "," << tile.sizeY << ")"
+      << " pixels=(" << tile.numPixelsX << "," << tile.numPixelsY << ")";
+  return out;
+}
+
+std::ostream& operator<< (std::ostream& out, grams::PixelGeometry const& pg) {
+  out << "PixelGeometry version " << pg.version
+      << " from '" << pg.gdmlFile << "' (" << pg.gdmlSize << " bytes, hash "
+      << std::hex << pg.gdmlHash << std::dec << ") volume '" << pg.anodeVolume << "'"
+      << ( pg.multipleTiles ? ", every placement" : "" )
+      << ", drift along " << "xyz"[ pg.driftCoordinate % 3 ]
+      << ", readout center=(" << pg.readoutCenterX << "," << pg.readoutCenterY << ")"
+      << std::endl;
+  for ( std::size_t i = 0; i != pg.tiles.size(); ++i )
+    out << "  tile " << i << ": " << pg.tiles[i] << std::endl;
+  return out;
+}
@@ -35,3 +35,41 @@ std::ostream& operator<< (std::ostream& out, grams::ReadoutMap const& rm) {
   }
   return out;
 }
+
+std::ostream& operator<< (std::ostream& out, grams::FlatClusterKeys const& ck) {
+
+  for ( const auto& clusterKey : ck ) {
+    const auto& [ trackID, hitID, clusterID ] = clusterKey;
+    out << "  trackID=" << trackID
+	<< " hitID=" << hitID
+	<< " clusterID=" << clusterID
+	<< std::endl;
+  }
+
+  return out;
+}
+
+std::ostream& operator<< (std::ostream& out, grams::FlatReadoutMap const& rm) {
+  for ( const auto& [ readoutID, clusterIDList ] : rm ) {
+    out << readoutID << std::endl;
+    out << clusterIDList << std::endl;
+  }
+  return out;
+}
+
+namespace grams {
+
+  void Convert(const ReadoutMap& a_in, FlatReadoutMap& a_out) {
+    a_out.clear();
+    a_out.reserve( a_in.size() );
+    for ( const auto& [ readoutID, clusterKeys ] : a_in )
+      a_out.push_back( std::make_pair( readoutID, FlatClusterKeys( clusterKeys ) ) );
+  }
+
+  void Convert(const FlatReadoutMap& a_in, ReadoutMap& a_out) {
+    a_out.clear();
+    for ( const auto& [ readoutID, clusterKeys ] : a_in )
+      a_out.emplace_hint( a_out.end(), readoutID, clusterKeys.ToSet() );
+  }
+
+} // namespace grams
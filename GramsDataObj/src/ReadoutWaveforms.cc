@@ -40,3 +40,11 @@ std::ostream& operator<< (std::ostream& out, grams::ReadoutWaveforms const& rws)
   out << std::endl;
   return out;
 }
+
+std::ostream& operator<< (std::ostream& out, grams::FlatReadoutWaveforms const& rws) {
+  for ( const auto& [ readoutID, waveforms ] : rws ) {
+    out << waveforms << std::endl;
+  }
+  out << std::endl;
+  return out;
+}
@@ -3,9 +3,11 @@
 // 21-Sep-2022 Satoshi Takashima and William Seligman
 
 // Our function(s) for the detector response.
-#include "RecombinationModel.h"
-#include "AbsorptionModel.h"
-#include "DiffusionModel.h"
+#include "DetectorResponse.h"
+#include "ParameterScan.h"
+
+// The pixels, if the charge is deposited on them; in GramsReadoutSim/.
+#include "PixelGeometryIO.h"
 
 // For processing command-line and XML file options.
 #include "Options.h" // in util/
@@ -13,6 +15,15 @@
 // For copying and accessing the detectory geometry.
 #include "Geometry.h" // in util/
 
+// For processing events in parallel.
+#include "ThreadPool.h" // in util/
+
+// Per-event random-number streams.
+#include "RandomService.h" // in util/
+
+// For reading and writing either std::map or flat data products.
+#include "ProductIO.h" // in util/
+
 // From GramsDataObj
 #include "EventID.h"
 #include "MCLArHits.h"
@@ -22,7 +33,7 @@
 #include "TFile.h"
 #include "TTreeReader.h"
 #include "TTreeReaderValue.h"
-#include "TRandom.h"
+#include "TROOT.h"
 #include "Math/Vector4D.h"
 
 // C++ includes
@@ -31,6 +42,8 @@
 #include <cmath>
 #include <vector>
 #include <numeric>
+#include <memory>
+#include <utility>
 
 ///////////////////////////////////////
 int main(int argc,char **argv)
@@ -80,14 +93,12 @@ int main(int argc,char **argv)
 	      << "', input tree = '" << inputTreeName
 	      << "'" << std::endl;
 
-  // For any model that requires random-number generation (as of
-  // Sep-2022, only DiffusionModel), get and set the random number
-  // seed.
-  int seed;
-  options->GetOption("rngseed",seed);
-  // Note that the default random-number generator in ROOT is
-  // TRandom3.
-  gRandom->SetSeed(seed);
+  // Any model that requires random-number generation (as of
+  // Sep-2022, only DiffusionModel) draws from a stream that is set at
+  // the start of each event by util::RandomService, using the
+  // rngseed option and the event ID. The results for an event don't
+  // depend on which events came before it.
+  auto randomService = util::RandomService::GetInstance();
 
   // Parameters for computing hit projections onto the readout plane.
   double m_readout_plane_coord;
@@ -120,7 +131,10 @@ int main(int argc,char **argv)
   // Create a TTreeReaderValue for each column in the tree whose
   // value we'll use.
   TTreeReaderValue<grams::EventID> inputEventID = {*reader, "EventID"};
-  TTreeReaderValue<grams::MCLArHits> LArHits    = {*reader, "LArHits"};
+
+  // The hits may have been written as a std::map or as a flat
+  // vector. Either way, LArHits gives us the flat version.
+  util::ProductReader<grams::FlatMCLArHits, grams::MCLArHits> LArHits(*reader, "LArHits");
 
   // Now read in the options associated with the output file and tree. 
   std::string outputFileName;
@@ -153,8 +167,34 @@ int main(int argc,char **argv)
 	      << "gramsdetsim: geometry copied"
 	      << std::endl;
 
-  // Define our output tree.
-  auto outputTree = new TTree(outputTreeName.c_str(),"Detector Response");
+  // If the charge is deposited directly on the pixels, save which
+  // pixels, so that gramsreadoutsim can check that it uses the same
+  // ones.
+  bool diffusion, analyticDiffusion;
+  options->GetOption("diffusion",diffusion);
+  options->GetOption("AnalyticDiffusion",analyticDiffusion);
+  if ( diffusion  &&  analyticDiffusion )
+    gramsreadoutsim::WritePixelGeometry( gramsreadoutsim::JobPixelGeometry(), output );
+
+  // The settings of the models. Unless the parameterScan option is
+  // set, there's only one: the options of this job.
+  gramsdetsim::ParameterScan scan;
+  const size_t numSettings = scan.size();
+
+  // Define our output trees, one for each setting. The tree for the
+  // job's own options has the usual name; the tree for each setting
+  // of a parameter scan has that setting's tag appended, and the
+  // changed options in its title.
+  std::vector< TTree* > outputTrees;
+  for ( size_t s = 0; s != numSettings; ++s ) {
+    if ( s == 0 )
+      outputTrees.push_back( new TTree(outputTreeName.c_str(),"Detector Response") );
+    else {
+      const std::string name = outputTreeName + "_" + scan.Tag(s);
+      const std::string title = "Detector Response: " + scan.Description(s);
+      outputTrees.push_back( new TTree(name.c_str(), title.c_str()) );
+    }
+  }
 
   // Define the columns of the output tree. Since this tree will
   // be "friends" with the input tree, we only have to include
@@ -164,159 +204,217 @@ int main(int argc,char **argv)
   // make it easier for them to be friends.
 
   auto eventID = new grams::EventID();
-  auto clusters = new grams::ElectronClusters();
   // By experimenting, it turns out that setting the splitlevel to 0
   // improves potential issues with ROOT's TBrowser.
-  outputTree->Branch("EventID",          &eventID,  32000, 0);
-  outputTree->Branch("ElectronClusters", &clusters, 32000, 0);
-
-  // Are we using this particular model?
-  bool doRecombination;
-  options->GetOption("recombination",doRecombination);
-
-  // If we're using this model, initialize it. 
-  gramsdetsim::RecombinationModel* recombinationModel = NULL;
-  if ( doRecombination ) {
-    recombinationModel = new gramsdetsim::RecombinationModel();
-    if (verbose)
-      std::cout << "gramsdetsim: RecombinationModel turned on" << std::endl;
-  }
-  else {
-    if (verbose)
-      std::cout << "gramsdetsim: RecombinationModel turned off" << std::endl;
-  }
-
-  //absorption
-  bool doAbsorption;
-  options->GetOption("absorption", doAbsorption);
-
-  // If we're using this model, initialize it. 
-  gramsdetsim::AbsorptionModel* absorptionModel = NULL;
-  if ( doAbsorption ) {
-    absorptionModel = new gramsdetsim::AbsorptionModel();
-    if (verbose)
-      std::cout << "gramsdetsim: AbsorptionModel turned on" << std::endl;
-  }
-  else {
-    if (verbose)
-      std::cout << "gramsdetsim: AbsorptionModel turned off" << std::endl;
-  }
-
-  //diffusion
-  bool doDiffusion;
-  options->GetOption("diffusion", doDiffusion);
-
-  gramsdetsim::DiffusionModel* diffusionModel = NULL;
-  if ( doDiffusion ) {
-    diffusionModel = new gramsdetsim::DiffusionModel();
-    if (verbose)
-      std::cout << "gramsdetsim: DiffusionModel turned on" << std::endl;
-  }
-  else {
-    if (verbose)
-      std::cout << "gramsdetsim: DiffusionModel turned off" << std::endl;
+  for ( auto outputTree : outputTrees )
+    outputTree->Branch("EventID",          &eventID,  32000, 0);
+
+  // The clusters are computed in the flat format. If the user
+  // wants the std::map format, 'clusters' converts them before
+  // each Fill().
+  bool flatDataProducts;
+  options->GetOption("flatDataProducts",flatDataProducts);
+  typedef util::ProductWriter<grams::FlatElectronClusters, grams::ElectronClusters> ClusterWriter;
+  std::vector< std::unique_ptr<ClusterWriter> > clusters;
+  for ( auto outputTree : outputTrees )
+    clusters.push_back( std::make_unique<ClusterWriter>(outputTree, "ElectronClusters", flatDataProducts) );
+
+  // If this is greater than zero, the clusters of a large event are
+  // written in segments of about this many clusters, one row per
+  // segment, so that the whole event never has to be held in
+  // memory. The "Segment" column numbers the rows of each event.
+  int maxClustersPerSegment;
+  options->GetOption("maxClustersPerSegment",maxClustersPerSegment);
+  const bool segmented = ( maxClustersPerSegment > 0 );
+  int segment = 0;
+  if ( segmented )
+    for ( auto outputTree : outputTrees )
+      outputTree->Branch("Segment", &segment);
+
+  // How many worker threads? If this is zero, process the events
+  // serially in this thread.
+  int nthreads;
+  options->GetOption("nthreads",nthreads);
+
+  // The threads would each hold entire events in memory, which
+  // defeats the purpose of the segments.
+  if ( segmented  &&  nthreads > 0 ) {
+    std::cout << "gramsdetsim: maxClustersPerSegment=" << maxClustersPerSegment
+	      << " is set; ignoring nthreads=" << nthreads
+	      << " and processing the events in a single thread" << std::endl;
+    nthreads = 0;
   }
 
-  if (debug) 
-    std::cout << "gramsdetsim.cc - debug 1000" 
-	      << std::endl;
-
-  // For each row in the input tree:
-  while ( (*reader).Next() ) {
+  if ( nthreads <= 0 ) {
 
-    // Increase the clusterID across all the hits in this event.
-    int clusterID = 0;
-    
-    // Clean out any cluster data from the previous event.
-    clusters->clear();
+    // Set up the detector-response models for each setting.
+    util::RandomStream random;
+    std::vector< std::unique_ptr<gramsdetsim::DetectorResponse> > detectorResponses;
+    for ( size_t s = 0; s != numSettings; ++s )
+      detectorResponses.push_back( scan.MakeResponse( s, &random ) );
 
-    // Copy the event ID from one tree to another.
-    (*eventID) = (*inputEventID);
+    if (debug)
+      std::cout << "gramsdetsim.cc - debug 1000"
+		<< std::endl;
 
-    // For each hit in the event:
-    for ( const auto& [ key, hit ] : (*LArHits) ) {
+    // For each row in the input tree:
+    while ( (*reader).Next() ) {
 
       if (debug)
 	std::cout << "gramsdetsim: at entry " << reader->GetCurrentEntry() << std::endl;
 
-      // The total hit energy, which is gradually adjusted by the models
-      // during this routine.
-      double energy_sca = hit.energy;
+      // Copy the event ID from one tree to another.
+      (*eventID) = (*inputEventID);
+
+      // Apply each setting's models to the same hits.
+      for ( size_t s = 0; s != numSettings; ++s ) {
+	auto& detectorResponse = *detectorResponses[s];
+	auto& settingClusters = *clusters[s];
+	auto outputTree = outputTrees[s];
+
+	// Apply the models to all the hits in the event. Every
+	// setting starts from the same random numbers, so the
+	// differences between the settings aren't hidden by
+	// fluctuations.
+	randomService->SetStream( random, util::RandomService::e_gramsdetsim,
+				  eventID->Run(), eventID->Event() );
+
+	if ( ! segmented ) {
+	  detectorResponse.Process( *LArHits, *settingClusters );
+
+	  // After all the model effects have been applied, write the
+	  // detector-response value(s) for all the hits/clusters in the
+	  // event.
+	  settingClusters.Prepare();
+	  outputTree->Fill();
+	}
+	else {
+	  // Write one row for each segment of the event. Every event
+	  // has at least one row, even if it has no clusters.
+	  detectorResponse.Begin( *LArHits );
+	  segment = 0;
+	  bool moreHits;
+	  do {
+	    moreHits = detectorResponse.Next( *settingClusters, maxClustersPerSegment );
+	    settingClusters.Prepare();
+	    outputTree->Fill();
+	    ++segment;
+	  } while ( moreHits );
+
+	  if (debug)
+	    std::cout << "gramsdetsim: event " << (*eventID)
+		      << " written in " << segment << " segment(s)" << std::endl;
+	}
+      } // for each setting
 
-      if (debug)
-        std::cout << "gramsdetsim: before model corrections, energy=" 
-		  << energy_sca
-		  << std::endl;
+    } // for each event
+
+    // Report what the hit filter dropped.
+    if ( detectorResponses.front()->FilterActive() )
+      std::cout << detectorResponses.front()->FilterCounts() << std::endl;
+  }
+  else {
 
-      // Apply the model(s). Handle potential computation errors (i.e.,
-      // if dx is zero) within the different models.
+    // Multi-threaded processing. ROOT I/O stays in this thread: we
+    // read a batch of events, let the workers apply the models to
+    // them in parallel, then write the batch in its original
+    // order. The output tree therefore has the same row order as the
+    // input tree, which is what the friend-tree mechanism requires.
 
-      if ( doRecombination ) {
-	energy_sca = recombinationModel->Calculate(energy_sca, hit);
-	if ( std::isnan(energy_sca) ) 
-	  energy_sca = 0.0;
-      }
+    // Tell ROOT that it's going to be used by more than one thread.
+    ROOT::EnableThreadSafety();
 
-      if (debug)
-	std::cout << "gramsdetsim: after recombination model corrections, energyAtAnode=" 
-		  << energy_sca << std::endl;
-    
-      //absorption
-      if ( doAbsorption  &&  energy_sca > 0. )
-	energy_sca = absorptionModel->Calculate(energy_sca, hit);
-      
-      if (debug)
-	std::cout << "gramsdetsim: after absorption model corrections, energyAtAnode=" 
-		  << energy_sca << std::endl;
-    
-      //diffusion
-      std::vector< grams::ElectronCluster > calcClusters;
-      if ( doDiffusion  &&  energy_sca > 0. ) {
-	// The clusters in this vector returned by DiffusionModel will
-	// replace the "default cluster", if all goes well. Maintain
-	// and increment the cluster ID across all the clusters in
-	// this event.
-	calcClusters = diffusionModel->Calculate(energy_sca, hit, clusterID);
+    if (verbose)
+      std::cout << "gramsdetsim: processing events with "
+		<< nthreads << " threads" << std::endl;
+
+    // Each worker has its own random-number stream and its own
+    // copy of the models for each setting.
+    std::vector< std::unique_ptr<util::RandomStream> > engines;
+    std::vector< std::vector< std::unique_ptr<gramsdetsim::DetectorResponse> > > responses( nthreads );
+    for ( int t = 0; t != nthreads; ++t ) {
+      engines.push_back( std::make_unique<util::RandomStream>() );
+      for ( size_t s = 0; s != numSettings; ++s )
+	responses[t].push_back( scan.MakeResponse( s, engines.back().get() ) );
+    }
+
+    // Each batch holds a few events per thread, to keep the workers
+    // busy if some events take longer than others.
+    const size_t batchSize = 8 * nthreads;
+    std::vector< grams::EventID > batchEventIDs( batchSize );
+    std::vector< grams::FlatMCLArHits > batchHits( batchSize );
+    std::vector< std::vector< grams::FlatElectronClusters > > batchClusters
+      ( numSettings, std::vector< grams::FlatElectronClusters >( batchSize ) );
+
+    util::ThreadPool pool(nthreads);
+
+    bool moreEvents = true;
+    while ( moreEvents ) {
+
+      // Read the next batch of events.
+      size_t numberInBatch = 0;
+      while ( numberInBatch < batchSize ) {
+	moreEvents = (*reader).Next();
+	if ( ! moreEvents ) break;
+
+	if (debug)
+	  std::cout << "gramsdetsim: at entry " << reader->GetCurrentEntry() << std::endl;
+
+	batchEventIDs[ numberInBatch ] = (*inputEventID);
+	// Swapping avoids copying the hits. The reader will clear out
+	// whatever we swapped into it before it reads the next entry.
+	std::swap( batchHits[ numberInBatch ], (*LArHits) );
+	++numberInBatch;
       }
 
-      if (debug) {
-	std::cout << "gramsdetsim: after diffusion model corrections, calcClusters.size()=" 
-		  << calcClusters.size() << std::endl;
-	std::cout << hit << std::endl;
-	for ( const auto& c : calcClusters ) {
-	  std::cout << c << std::endl;
+      // Apply the models to the events in the batch.
+      pool.ParallelFor( numberInBatch, [&](size_t i, int thread) {
+	  for ( size_t s = 0; s != numSettings; ++s ) {
+	    // Select the event's random-number stream, so that its
+	    // clusters don't depend on which thread handled it, or on
+	    // the number of threads.
+	    randomService->SetStream( *engines[thread], util::RandomService::e_gramsdetsim,
+				      batchEventIDs[i].Run(), batchEventIDs[i].Event() );
+	    responses[thread][s]->Process( batchHits[i], batchClusters[s][i] );
+	  }
+	});
+
+      // Write the batch in input order.
+      for ( size_t i = 0; i != numberInBatch; ++i ) {
+	(*eventID) = batchEventIDs[i];
+	for ( size_t s = 0; s != numSettings; ++s ) {
+	  std::swap( *(*clusters[s]), batchClusters[s][i] );
+	  clusters[s]->Prepare();
+	  outputTrees[s]->Fill();
 	}
-	std::cout << std::endl;
       }
 
-      // For each cluster returned by the diffusion model::
-      for ( auto& cluster : calcClusters ) {
-	// Create the key for this cluster.
-	auto ckey = std::make_tuple( cluster.trackID, cluster.hitID, cluster.clusterID );
+    } // for each batch of events
 
-	// Append this cluster to the overall list of clusters for this event.
-	clusters->insert( std::make_pair( ckey, cluster ) );
-      }
-
-    } // for each hit
-
-    // After all the model effects have been applied, write the
-    // detector-response value(s) for all the hits/clusters in the
-    // event.
-    outputTree->Fill();
-
-  } // for each event
+    // Report what the hit filter dropped, summed over the threads.
+    if ( responses.front().front()->FilterActive() ) {
+      gramsdetsim::HitFilter::Counts counts;
+      for ( const auto& response : responses )
+	counts += response.front()->FilterCounts();
+      std::cout << counts << std::endl;
+    }
+  }
 
-  // Build an index for this tree. This will allow downstream
-  // programs to quickly access a given EventID within the tree.
-  outputTree->BuildIndex("EventID.Index()");
+  // Build an index for each tree. This will allow downstream
+  // programs to quickly access a given EventID within the tree. If
+  // an event can have more than one row, the segment number tells
+  // them apart.
+  for ( auto outputTree : outputTrees ) {
+    if ( segmented )
+      outputTree->BuildIndex("EventID.Index()","Segment");
+    else
+      outputTree->BuildIndex("EventID.Index()");
+  }
 
   // Wrap-up. Close all files. Delete any pointers we created.
-  outputTree->Write();
+  for ( auto outputTree : outputTrees )
+    outputTree->Write();
   output->Close();
-  delete recombinationModel;
-  delete absorptionModel;
-  delete diffusionModel;
   delete reader;
   input->Close();
 }
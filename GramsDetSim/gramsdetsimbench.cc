@@ -0,0 +1,424 @@
+// gramsdetsimbench.cc
+// Time the GramsDetSim detector-response models on synthetic
+// populations of LAr hits. See "Benchmarks" in GramsDetSim/README.md.
+// 16-Oct-2026
+
+// The models being timed.
+#include "RecombinationModel.h"
+#include "AbsorptionModel.h"
+#include "DiffusionModel.h"
+#include "AnalyticDiffusionModel.h"
+#include "DetectorResponse.h"
+#include "HitBatch.h"
+
+// For processing command-line and XML file options.
+#include "Options.h" // in util/
+
+// Random-number streams for generating the hits and for the models.
+#include "RandomService.h" // in util/
+
+// From GramsDataObj
+#include "MCLArHits.h"
+#include "ElectronClusters.h"
+#include "PixelGeometry.h"
+
+// ROOT includes
+#include "Math/Vector4D.h"
+
+// C++ includes
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <tuple>
+
+// Count every memory allocation in the program, so that we can
+// report how many allocations a model makes per hit. This replaces
+// the global operator new; operator new[] calls it by default.
+namespace {
+  std::size_t allocations = 0;
+}
+
+void* operator new(std::size_t a_size)
+{
+  ++allocations;
+  if ( void* p = std::malloc( a_size > 0 ? a_size : 1 ) )
+    return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* a_pointer) noexcept { std::free(a_pointer); }
+void operator delete(void* a_pointer, std::size_t) noexcept { std::free(a_pointer); }
+
+namespace {
+
+  // A named set of synthetic events.
+  struct Population {
+    std::string name;
+    std::vector< grams::FlatMCLArHits > events;
+    std::size_t numHits = 0;
+  };
+
+  // Append a straight-line track to 'hits', made of 'numSteps' steps
+  // of length 'stepLength' (cm) starting at (x,y,z) in the direction
+  // (dx,dy,dz), which must be a unit vector. The energy of each step
+  // (MeV) is drawn by 'stepEnergy'.
+  void AddTrack(grams::FlatMCLArHits& a_hits, TRandom& a_random,
+		int a_trackID, int a_pdgCode, int a_numSteps, double a_stepLength,
+		double a_x, double a_y, double a_z,
+		double a_dx, double a_dy, double a_dz,
+		const std::function<double(TRandom&)>& a_stepEnergy)
+  {
+    double t = 0.;
+    for ( int step = 0; step != a_numSteps; ++step ) {
+      grams::MCLArHit hit{};
+      hit.trackID = a_trackID;
+      hit.hitID = step;
+      hit.pdgCode = a_pdgCode;
+      hit.energy = a_stepEnergy(a_random);
+      hit.start = ROOT::Math::XYZTVector( a_x, a_y, a_z, t );
+      a_x += a_dx * a_stepLength;
+      a_y += a_dy * a_stepLength;
+      a_z += a_dz * a_stepLength;
+      t += 0.001;
+      hit.end = ROOT::Math::XYZTVector( a_x, a_y, a_z, t );
+      a_hits[ std::make_tuple( a_trackID, step ) ] = hit;
+    }
+  }
+
+  // A random direction, isotropic in 3D.
+  void Direction(TRandom& a_random, double& a_dx, double& a_dy, double& a_dz)
+  {
+    const double cosTheta = a_random.Uniform(-1.,1.);
+    const double sinTheta = std::sqrt( 1. - cosTheta*cosTheta );
+    const double phi = a_random.Uniform(0., 2.*M_PI);
+    a_dx = sinTheta * std::cos(phi);
+    a_dy = sinTheta * std::sin(phi);
+    a_dz = cosTheta;
+  }
+
+  // The pixels for AnalyticDiffusionModel. Rather than import the
+  // GDML file just to time the model, use a single tile the size of
+  // the standard GRAMS anode (70 cm on a side), centered on the
+  // synthetic hits and divided as in the x_resolution and
+  // y_resolution options. (If AnalyticDiffusion is on, the
+  // "as configured" DetectorResponse uses the job's real pixels.)
+  grams::PixelGeometry BenchPixelGeometry()
+  {
+    auto options = util::Options::GetInstance();
+    grams::AnodeTile tile;
+    tile.sizeX = 70.;
+    tile.sizeY = 70.;
+    options->GetOption("x_resolution",tile.numPixelsX);
+    options->GetOption("y_resolution",tile.numPixelsY);
+    grams::PixelGeometry geometry;
+    geometry.tiles.push_back( tile );
+    return geometry;
+  }
+
+  // The populations. The hits are placed in the drift region below
+  // a readout plane at z=0 cm; only the number of hits, their sizes,
+  // and their energies matter for timing. Each population has its
+  // own random-number stream, so the hits don't depend on 'rngseed'
+  // or on the number of events in the other populations.
+  enum PopulationID { e_mip = 1, e_shower, e_compton };
+
+  // Minimum-ionizing muons crossing the detector: long tracks of
+  // uniform steps of about 2.1 MeV/cm.
+  Population MIPTracks(int a_numEvents)
+  {
+    Population population;
+    population.name = "MIP tracks";
+    util::RandomStream random;
+    for ( int event = 0; event != a_numEvents; ++event ) {
+      random.SetKey( 0, 0, e_mip, event, 0 );
+      grams::FlatMCLArHits hits;
+      double dx, dy, dz;
+      Direction(random, dx, dy, dz);
+      const double stepLength = 0.03;
+      AddTrack( hits, random, 1, 13, 1000, stepLength,
+		random.Uniform(-10.,10.), random.Uniform(-10.,10.), -15.,
+		dx, dy, -std::abs(dz) * 0.5,
+		[=](TRandom& r) { return 2.12 * stepLength * std::max(0.2, r.Gaus(1.,0.3)); } );
+      population.numHits += hits.size();
+      population.events.push_back( std::move(hits) );
+    }
+    return population;
+  }
+
+  // Electromagnetic showers: many short electron and positron tracks
+  // spread about a common axis, with small and widely varying step
+  // energies.
+  Population Showers(int a_numEvents)
+  {
+    Population population;
+    population.name = "showers";
+    util::RandomStream random;
+    for ( int event = 0; event != a_numEvents; ++event ) {
+      random.SetKey( 0, 0, e_shower, event, 0 );
+      grams::FlatMCLArHits hits;
+      const double x0 = random.Uniform(-10.,10.);
+      const double y0 = random.Uniform(-10.,10.);
+      for ( int track = 1; track <= 400; ++track ) {
+	double dx, dy, dz;
+	Direction(random, dx, dy, dz);
+	const double depth = random.Exp(5.);
+	AddTrack( hits, random, track, (track % 2) ? 11 : -11,
+		  1 + int(random.Exp(20.)), random.Uniform(0.01,0.05),
+		  x0 + random.Gaus(0.,1.), y0 + random.Gaus(0.,1.), -2. - depth,
+		  dx, dy, dz,
+		  [](TRandom& r) { return r.Exp(0.02); } );
+      }
+      population.numHits += hits.size();
+      population.events.push_back( std::move(hits) );
+    }
+    return population;
+  }
+
+  // Low-energy Compton electrons: a few dozen short tracks in
+  // random places, each with a handful of steps.
+  Population ComptonElectrons(int a_numEvents)
+  {
+    Population population;
+    population.name = "Compton electrons";
+    util::RandomStream random;
+    for ( int event = 0; event != a_numEvents; ++event ) {
+      random.SetKey( 0, 0, e_compton, event, 0 );
+      grams::FlatMCLArHits hits;
+      for ( int track = 1; track <= 40; ++track ) {
+	double dx, dy, dz;
+	Direction(random, dx, dy, dz);
+	AddTrack( hits, random, track, 11,
+		  5 + int(random.Uniform(0.,25.)), 0.005,
+		  random.Uniform(-15.,15.), random.Uniform(-15.,15.), random.Uniform(-30.,-1.),
+		  dx, dy, dz,
+		  [](TRandom& r) { return r.Uniform(0.005,0.02); } );
+      }
+      population.numHits += hits.size();
+      population.events.push_back( std::move(hits) );
+    }
+    return population;
+  }
+
+  // The result of timing one model on one population.
+  struct Result {
+    double seconds;
+    std::size_t clusters;
+    std::size_t allocations;
+  };
+
+  // Apply 'process' to every event in the population 'repeat'
+  // times. Keep the fastest time, and the number of allocations in
+  // the last pass, after any buffers have grown to their final size.
+  Result Measure(const Population& a_population, int a_repeat,
+		 const std::function<std::size_t(const grams::FlatMCLArHits&)>& a_process)
+  {
+    Result result{ -1., 0, 0 };
+    for ( int pass = 0; pass != a_repeat; ++pass ) {
+      std::size_t clusters = 0;
+      const std::size_t allocationsBefore = allocations;
+      const auto start = std::chrono::steady_clock::now();
+
+      for ( const auto& hits : a_population.events )
+	clusters += a_process(hits);
+
+      const auto stop = std::chrono::steady_clock::now();
+      const double seconds = std::chrono::duration<double>(stop - start).count();
+      if ( result.seconds < 0.  ||  seconds < result.seconds )
+	result.seconds = seconds;
+      result.clusters = clusters;
+      result.allocations = allocations - allocationsBefore;
+    }
+    return result;
+  }
+
+  void Print(const Population& a_population, const std::string& a_model, const Result& a_result)
+  {
+    const double hits = double( a_population.numHits );
+    std::cout << std::left << std::setw(20) << a_population.name
+	      << std::setw(36) << a_model
+	      << std::right << std::scientific << std::setprecision(3)
+	      << std::setw(12) << hits / a_result.seconds;
+    if ( a_result.clusters > 0 )
+      std::cout << std::setw(12) << double(a_result.clusters) / a_result.seconds;
+    else
+      std::cout << std::setw(12) << "-";
+    std::cout << std::fixed << std::setprecision(3)
+	      << std::setw(12) << double(a_result.allocations) / hits
+	      << std::endl;
+  }
+
+} // anonymous namespace
+
+///////////////////////////////////////
+int main(int argc,char **argv)
+{
+  // The models are configured by the <gramsdetsim> options, so that
+  // the benchmark times the same models that gramsdetsim would
+  // use. Any of those options can be changed on the command line.
+  auto options = util::Options::GetInstance();
+  auto result = options->ParseOptions(argc, argv, "gramsdetsimbench,gramsdetsim");
+
+  // Abort if we couldn't parse the job options.
+  if (! result) {
+    std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+	      << "gramsdetsimbench: Aborting job due to failure to parse options"
+	      << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  bool help;
+  options->GetOption("help",help);
+  if (help) {
+    options->PrintHelp();
+    exit(EXIT_SUCCESS);
+  }
+
+  bool verbose;
+  options->GetOption("verbose",verbose);
+  if (verbose) {
+    // Display all program options.
+    options->PrintOptions();
+  }
+
+  int numEvents;
+  int repeat;
+  options->GetOption("benchEvents",numEvents);
+  options->GetOption("benchRepeat",repeat);
+  if ( numEvents <= 0  ||  repeat <= 0 ) {
+    std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+	      << "gramsdetsimbench: benchEvents=" << numEvents
+	      << " and benchRepeat=" << repeat << " must both be positive"
+	      << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<Population> populations;
+  populations.push_back( MIPTracks(numEvents) );
+  populations.push_back( Showers(numEvents) );
+  populations.push_back( ComptonElectrons(numEvents) );
+
+  // The diffusion models draw from the gramsdetsim stream of each
+  // event, as they would in gramsdetsim.
+  auto randomService = util::RandomService::GetInstance();
+  util::RandomStream random;
+
+  // The individual models. They're created whether or not they're
+  // turned on in the options, so that each can be timed.
+  gramsdetsim::RecombinationModel recombination;
+  gramsdetsim::AbsorptionModel absorption;
+  gramsdetsim::DiffusionModel diffusion;
+  diffusion.SetRandom(&random);
+  gramsdetsim::AnalyticDiffusionModel analyticDiffusion( BenchPixelGeometry() );
+  analyticDiffusion.SetRandom(&random);
+
+  // The full chain, with the models selected by the options.
+  gramsdetsim::DetectorResponse detectorResponse(&random);
+
+  // Working storage, kept from one event to the next, as it is in
+  // DetectorResponse.
+  gramsdetsim::HitBatch batch;
+  std::vector< grams::ElectronCluster > clusterBuffer;
+  grams::FlatElectronClusters clusters;
+
+  // Apply a diffusion model to each hit with a positive energy in
+  // 'batch', and return the number of clusters.
+  auto diffuse = [&]( const grams::FlatMCLArHits& a_hits, auto& a_model ) {
+    clusterBuffer.clear();
+    int clusterID = 0;
+    std::size_t index = 0;
+    for ( const auto& [ key, hit ] : a_hits ) {
+      const double energy = batch.energy[ index++ ];
+      if ( energy > 0. )
+	a_model.Calculate( energy, hit, clusterID, clusterBuffer );
+    }
+    return clusterBuffer.size();
+  };
+
+  // Each benchmark takes one event and returns the number of
+  // clusters it made (0 for models that don't make clusters).
+  using Benchmark = std::function<std::size_t(const grams::FlatMCLArHits&)>;
+  std::vector< std::pair<std::string, Benchmark> > benchmarks = {
+
+    { "Recombination", [&](const grams::FlatMCLArHits& a_hits) -> std::size_t {
+	batch.Fill(a_hits);
+	recombination.Calculate(batch);
+	return 0;
+      } },
+
+    { "Absorption", [&](const grams::FlatMCLArHits& a_hits) -> std::size_t {
+	batch.Fill(a_hits);
+	absorption.Calculate(batch);
+	return 0;
+      } },
+
+    { "Diffusion", [&](const grams::FlatMCLArHits& a_hits) -> std::size_t {
+	batch.Fill(a_hits);
+	return diffuse(a_hits, diffusion);
+      } },
+
+    { "AnalyticDiffusion", [&](const grams::FlatMCLArHits& a_hits) -> std::size_t {
+	batch.Fill(a_hits);
+	return diffuse(a_hits, analyticDiffusion);
+      } },
+
+    { "Recombination+Absorption", [&](const grams::FlatMCLArHits& a_hits) -> std::size_t {
+	batch.Fill(a_hits);
+	recombination.Calculate(batch);
+	absorption.Calculate(batch);
+	return 0;
+      } },
+
+    { "Recomb+Absorp+Diffusion", [&](const grams::FlatMCLArHits& a_hits) -> std::size_t {
+	batch.Fill(a_hits);
+	recombination.Calculate(batch);
+	absorption.Calculate(batch);
+	return diffuse(a_hits, diffusion);
+      } },
+
+    { "Recomb+Absorp+AnalyticDiffusion", [&](const grams::FlatMCLArHits& a_hits) -> std::size_t {
+	batch.Fill(a_hits);
+	recombination.Calculate(batch);
+	absorption.Calculate(batch);
+	return diffuse(a_hits, analyticDiffusion);
+      } },
+
+    { "DetectorResponse (as configured)", [&](const grams::FlatMCLArHits& a_hits) -> std::size_t {
+	detectorResponse.Process(a_hits, clusters);
+	return clusters.size();
+      } },
+  };
+
+  std::cout << std::left << std::setw(20) << "population"
+	    << std::setw(36) << "model"
+	    << std::right
+	    << std::setw(12) << "hits/s"
+	    << std::setw(12) << "clusters/s"
+	    << std::setw(12) << "allocs/hit"
+	    << std::endl;
+
+  for ( const auto& population : populations ) {
+    if (verbose)
+      std::cout << "gramsdetsimbench: " << population.name << ": "
+		<< population.events.size() << " events, "
+		<< population.numHits << " hits" << std::endl;
+
+    for ( const auto& [ name, benchmark ] : benchmarks ) {
+      // Every pass over the population starts each event's random
+      // numbers from the beginning, so each pass does the same work.
+      int event = 0;
+      const auto timed = [&](const grams::FlatMCLArHits& a_hits) {
+	randomService->SetStream( random, util::RandomService::e_gramsdetsim,
+				  0, event++ % int(population.events.size()) );
+	return benchmark(a_hits);
+      };
+      Print( population, name, Measure(population, repeat, timed) );
+    }
+  }
+}
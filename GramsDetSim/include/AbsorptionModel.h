@@ -6,11 +6,18 @@
 #ifndef AbsorptionModel_h
 #define AbsorptionModel_h
 
+#include "HitBatch.h"
+
 // From GramsDataObj
 #include "MCLArHits.h"
 
+#include <vector>
+
 namespace gramsdetsim {
 
+  // Forward declaration.
+  class DriftMap;
+
   class AbsorptionModel
   {
   public:
@@ -23,8 +30,23 @@ namespace gramsdetsim {
     // entry of the ntuple, calculate a revised energy.
     double Calculate(double energy, const grams::MCLArHit& hit);
 
+    // The same calculation for all the hits in an event at once. The
+    // energies in 'hits' are replaced by the revised energies; hits
+    // with no energy are left alone. This routine does not print
+    // debugging information.
+    void Calculate(HitBatch& hits);
+
   private:
 
+    // The calculations for a drift along coordinate Axis; see
+    // DiffusionModel::m_Calculate.
+    template <int Axis>
+    double m_Calculate(double energy, const grams::MCLArHit& hit);
+    template <int Axis>
+    void m_CalculateBatch(HitBatch& hits);
+    double (AbsorptionModel::*m_calculate)(double, const grams::MCLArHit&);
+    void (AbsorptionModel::*m_calculateBatch)(HitBatch&);
+
     // Note that it's a convention to prefix variables defined in a
     // class header with "m_" as a visual clue in the ".cc" file that
     // the variable is defined in this ".h" file.
@@ -36,9 +58,19 @@ namespace gramsdetsim {
     double m_RecipDriftVel;
     double m_readout_plane_coord;
 
+    // See DiffusionModel::m_driftMap.
+    const DriftMap* m_driftMap;
+
     // Save the verbose and debug options.
     bool m_verbose;
     bool m_debug;
+
+    // Work space for the batch calculation.
+    std::vector<double> m_work;
+
+    // With a drift map, the midpoints of the hits and the
+    // reciprocal drift velocities found there.
+    std::vector<double> m_midX, m_midY, m_midZ, m_recipDriftVel;
   };
 
 } // namespace gramsdetsim
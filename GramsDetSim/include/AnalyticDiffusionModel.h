@@ -0,0 +1,126 @@
+// 16-Oct-2026
+
+// An alternative to DiffusionModel. Instead of breaking a hit's
+// ionization into clusters and diffusing each cluster with random
+// offsets, integrate the hit's Gaussian diffusion profile over the
+// pixel pitch and the electronics time bins, and sample the number of
+// electrons that arrive in each (pixel, time bin) cell.
+
+// The result is still a list of ElectronClusters, so the rest of the
+// analysis chain is unchanged; but there is one cluster per cell that
+// receives charge, located at the center of that cell.
+
+// The pixels are those of gramsreadoutsim: the same
+// grams::PixelGeometry, turned into the same grid by
+// gramsreadoutsim::AnodeGrid. If the anode has several tiles, each
+// hit's charge is divided among the pixels of the tile under the
+// center of its diffusion profile (or the nearest tile, if it's not
+// over one). Charge that spreads past the edge of that tile is still
+// put at the center of a cell of that tile's grid, extended past its
+// edge; gramsreadoutsim then assigns it to whatever pixel, if any,
+// contains that point.
+
+#ifndef AnalyticDiffusionModel_h
+#define AnalyticDiffusionModel_h
+
+// From GramsDataObj
+#include "MCLArHits.h"
+#include "ElectronClusters.h"
+#include "PixelGeometry.h"
+
+// From GramsReadoutSim
+#include "AnodeGrid.h"
+
+// ROOT includes
+#include "TRandom.h"
+
+#include <vector>
+
+namespace gramsdetsim {
+
+  // Forward declaration.
+  class DriftMap;
+
+  class AnalyticDiffusionModel
+  {
+  public:
+
+    // Constructor. The first form deposits the charge on the pixels
+    // of gramsreadoutsim::JobPixelGeometry(), which is what
+    // gramsdetsim does; the second on those of 'geometry'.
+    AnalyticDiffusionModel();
+    explicit AnalyticDiffusionModel(const grams::PixelGeometry& geometry);
+
+    // See DiffusionModel::SetRandom.
+    void SetRandom(TRandom* a_random) { m_random = a_random; }
+
+    // Divide the electrons from this hit among the cells of the
+    // pixel/time grid, and append a cluster for each cell that
+    // receives any electrons to 'clusters'. The arguments have the
+    // same meaning as those of DiffusionModel::Calculate.
+    void Calculate(double energy,
+		   const grams::MCLArHit& hit,
+		   int& clusterID,
+		   std::vector< grams::ElectronCluster >& clusters);
+
+  private:
+
+    // See DiffusionModel::m_Calculate.
+    template <int Axis>
+    void m_Calculate(double energy,
+		     const grams::MCLArHit& hit,
+		     int& clusterID,
+		     std::vector< grams::ElectronCluster >& clusters);
+    void (AnalyticDiffusionModel::*m_calculate)(double, const grams::MCLArHit&, int&,
+						std::vector< grams::ElectronCluster >&);
+
+    // Fill 'probabilities' with the fraction of a Gaussian with the
+    // given mean and width that falls in each bin of a grid with
+    // the given origin and bin width. Only the bins within
+    // m_nSigma of the mean are included; 'firstBin' is set to the
+    // number of the first of these.
+    void m_BinProbabilities(double mean, double sigma,
+			    double origin, double width,
+			    int& firstBin, std::vector<double>& probabilities) const;
+
+    // Divide n electrons among the bins with the given
+    // probabilities, which need not add up to 1. Each bin's count is
+    // drawn from a binomial distribution conditioned on the counts
+    // in the previous bins, so the counts follow a multinomial
+    // distribution and always add up to n.
+    void m_Divide(int n, const std::vector<double>& probabilities,
+		  std::vector<int>& counts);
+
+    // The constants required for the calculation, from the options.
+    double m_MeVToElectrons;
+    double m_LongitudinalDiffusion;
+    double m_TransverseDiffusion;
+    double m_readout_plane_coord;
+    double m_DriftVel;
+    double m_RecipDriftVel;
+    double m_driftDirection;
+
+    // See DiffusionModel::m_driftMap.
+    const DriftMap* m_driftMap;
+
+    // The pixel/time grid.
+    gramsreadoutsim::AnodeGrid m_grid;
+    double m_timeBinWidth;
+
+    // How far (in units of the diffusion width) the profile is
+    // followed from its center.
+    static constexpr double m_nSigma = 5.0;
+
+    TRandom* m_random;
+
+    // Work space for each hit.
+    std::vector<double> m_probX, m_probY, m_probT;
+    std::vector<int> m_countX, m_countY, m_countT;
+
+    bool m_verbose;
+    bool m_debug;
+  };
+
+} // namespace gramsdetsim
+
+#endif // AnalyticDiffusionModel_h
@@ -0,0 +1,110 @@
+// 16-Oct-2026
+
+// Apply the chain of detector-response models (recombination,
+// absorption, diffusion) to all the LAr hits in an event.
+
+// gramsdetsim.cc used to do this inside its main loop. It's a class
+// of its own so that each worker thread can own a complete, separate
+// set of models.
+
+#ifndef DetectorResponse_h
+#define DetectorResponse_h
+
+#include "RecombinationModel.h"
+#include "AbsorptionModel.h"
+#include "DiffusionModel.h"
+#include "AnalyticDiffusionModel.h"
+#include "HitBatch.h"
+#include "HitFilter.h"
+
+// From GramsDataObj
+#include "MCLArHits.h"
+#include "ElectronClusters.h"
+
+// ROOT includes
+#include "TRandom.h"
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+namespace gramsdetsim {
+
+  class DetectorResponse
+  {
+  public:
+
+    // Constructor. Create the models selected in the options XML
+    // file. If a_random is not null, the diffusion model uses it
+    // instead of gRandom. DetectorResponse does not take ownership
+    // of a_random.
+    DetectorResponse(TRandom* a_random = nullptr);
+
+    // Apply the models to every hit in the event and fill 'clusters'
+    // with the result. Any previous contents of 'clusters' are
+    // discarded. The flat versions of the data products are used
+    // here; util::ProductReader and util::ProductWriter convert
+    // to and from the std::map versions if needed.
+    void Process(const grams::FlatMCLArHits& hits, grams::FlatElectronClusters& clusters);
+
+    // Process an event's hits in segments, to limit the memory used
+    // by a very large event. Call Begin() with the event's hits, then
+    // call Next() until it returns false. Each call to Next() fills
+    // 'clusters' with the clusters of the next group of hits, and
+    // stops taking hits once 'clusters' holds at least 'maxClusters'
+    // of them (0 means no limit). Next() returns true if there are
+    // hits left to process. Taken together, the segments contain the
+    // same clusters as Process() would produce. 'hits' must not
+    // change until the last call to Next().
+    void Begin(const grams::FlatMCLArHits& hits);
+    bool Next(grams::FlatElectronClusters& clusters, std::size_t maxClusters = 0);
+
+    // Is the hit filter turned on? If so, how many hits has it seen,
+    // and how many has it dropped, since this object was created?
+    bool FilterActive() const { return m_hitFilter.Active(); }
+    const HitFilter::Counts& FilterCounts() const { return m_hitFilter.GetCounts(); }
+
+  private:
+
+    // Which models are turned on?
+    bool m_doRecombination;
+    bool m_doAbsorption;
+    bool m_doDiffusion;
+
+    // If diffusion is on, deposit the charge directly on the
+    // pixel/time grid instead of generating individual clusters.
+    bool m_analyticDiffusion;
+
+    std::unique_ptr<RecombinationModel> m_recombinationModel;
+    std::unique_ptr<AbsorptionModel>    m_absorptionModel;
+    std::unique_ptr<DiffusionModel>     m_diffusionModel;
+    std::unique_ptr<AnalyticDiffusionModel> m_analyticDiffusionModel;
+
+    // Drops the hits that aren't worth processing before any of the
+    // models see them.
+    HitFilter m_hitFilter;
+
+    // The event's hits in the layout used by the batch versions of
+    // the models.
+    HitBatch m_batch;
+
+    // The diffusion model appends each hit's clusters here. Like
+    // m_batch, it's cleared but not freed between events.
+    std::vector< grams::ElectronCluster > m_clusterBuffer;
+
+    // The event being processed by Begin() and Next(): the hits that
+    // passed the filter, the index of the next one to process, and
+    // the next cluster ID. Like m_batch, m_hits is kept between
+    // events.
+    std::vector< const grams::MCLArHit* > m_hits;
+    std::size_t m_nextHit;
+    int m_clusterID;
+
+    // Save the verbose and debug options.
+    bool m_verbose;
+    bool m_debug;
+  };
+
+} // namespace gramsdetsim
+
+#endif // DetectorResponse_h
@@ -10,10 +10,16 @@
 #include "MCLArHits.h"
 #include "ElectronClusters.h"
 
+// ROOT includes
+#include "TRandom.h"
+
 #include <vector>
 
 namespace gramsdetsim {
 
+  // Forward declaration.
+  class DriftMap;
+
   class DiffusionModel
   {
   public:
@@ -21,14 +27,43 @@ namespace gramsdetsim {
     // Constructor.
     DiffusionModel();
 
+    // By default the model draws from ROOT's global gRandom. When
+    // several copies of the model run in parallel, give each copy
+    // its own random-number generator. The model does not take
+    // ownership of the generator.
+    void SetRandom(TRandom* a_random) { m_random = a_random; }
+
     // The meat of this routine: Given the variables in the current
-    // entry of the ntuple, calculate a list of clusters.
+    // entry of the ntuple, calculate a list of clusters and append
+    // them to 'clusters'. Nothing already in 'clusters' is changed.
+    void Calculate(double energy,
+		   const grams::MCLArHit& hit,
+		   int& clusterID,
+		   std::vector< grams::ElectronCluster >& clusters);
+
+    // The same, returning the hit's clusters in a vector of their own.
     std::vector< grams::ElectronCluster > Calculate(double energy,
 						    const grams::MCLArHit& hit,
-						    int& clusterID);
+						    int& clusterID)
+    {
+      std::vector< grams::ElectronCluster > clusters;
+      Calculate(energy, hit, clusterID, clusters);
+      return clusters;
+    }
 
   private:
 
+    // The calculation for a drift along coordinate Axis (x:0 y:1
+    // z:2). The constructor picks one of these, according to the
+    // DriftCoordinate option, and Calculate calls it.
+    template <int Axis>
+    void m_Calculate(double energy,
+		     const grams::MCLArHit& hit,
+		     int& clusterID,
+		     std::vector< grams::ElectronCluster >& clusters);
+    void (DiffusionModel::*m_calculate)(double, const grams::MCLArHit&, int&,
+					std::vector< grams::ElectronCluster >&);
+
     // Note that it's a convention to prefix variables defined in a
     // class header with "m_" as a visual clue in the ".cc" file that
     // the variable is defined in this ".h" file.
@@ -41,9 +76,21 @@ namespace gramsdetsim {
     double m_readout_plane_coord;
     double m_DriftVel;
     double m_RecipDriftVel;
+    double m_driftDirection;
     int m_ElectronClusterSize;
     int m_MinNumberOfElCluster;
 
+    // If the field is not uniform, the drift velocity and the
+    // transverse displacement come from this map instead of the
+    // constants above. It's nullptr if the field is uniform.
+    const DriftMap* m_driftMap;
+
+    // The random-number generator used for the diffusion.
+    TRandom* m_random;
+
+    // The Gaussian offsets for the clusters of the current hit.
+    std::vector<double> m_offsets;
+
     // Save the verbose and debug options.
     bool m_verbose;
     bool m_debug;
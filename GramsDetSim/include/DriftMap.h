@@ -0,0 +1,138 @@
+// 16-Oct-2026
+
+// A map of how ionization electrons drift through the LAr when the
+// electric field is not uniform (e.g., due to space charge). For an
+// electron that starts at a point (x,y,z), the map gives its average
+// drift velocity on the way to the readout plane, and how far it's
+// been displaced in x and y by the time it gets there.
+
+// The map is a regular 3D grid of points, read from the file given
+// by the DriftMapFile option; see "Drift map" in README.md for the
+// file formats. Between the grid points, the values are found by
+// trilinear interpolation. Outside the grid, the values at the
+// nearest edge of the grid are used.
+
+#ifndef DriftMap_h
+#define DriftMap_h
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <algorithm>
+
+namespace gramsdetsim {
+
+  class DriftMap
+  {
+  public:
+
+    // The map named by the DriftMapFile option, or nullptr if that
+    // option is empty (i.e., the field is uniform). The file is read
+    // the first time this is called; all the models, in all threads,
+    // share the same map.
+    static const DriftMap* GetInstance();
+
+    // For an electron that starts at (x,y,z): the reciprocal of its
+    // average drift velocity, and its displacement in x and y at the
+    // readout plane.
+    void Lookup(double x, double y, double z,
+		double& recipDriftVel, double& dispX, double& dispY) const
+    {
+      std::size_t index;
+      double wx, wy, wz;
+      m_Locate(x, y, z, index, wx, wy, wz);
+      recipDriftVel = m_Interpolate(&Node::recipDriftVel, index, wx, wy, wz);
+      dispX         = m_Interpolate(&Node::dispX,         index, wx, wy, wz);
+      dispY         = m_Interpolate(&Node::dispY,         index, wx, wy, wz);
+    }
+
+    // The reciprocal of the drift velocity for n points at once. This
+    // is a simple loop with no branches, which the compiler can
+    // vectorize.
+    void RecipDriftVel(std::size_t n,
+		       const double* x, const double* y, const double* z,
+		       double* recipDriftVel) const;
+
+  private:
+
+    // Read the map from a ROOT file (if the name ends in ".root") or
+    // a binary file.
+    explicit DriftMap(const std::string& fileName);
+    void m_ReadROOT(const std::string& fileName);
+    void m_ReadBinary(const std::string& fileName);
+
+    // Check the grid and compute the constants used by m_Locate.
+    void m_Finish(const std::string& fileName);
+
+    // Find the grid cell that contains (x,y,z): the index of its
+    // lowest corner, and the fractional position within the cell
+    // along each axis. A point outside the grid is moved to its
+    // nearest edge, as is a point that's not a number. No branches,
+    // only min and max.
+    void m_Locate(double a_x, double a_y, double a_z,
+		  std::size_t& a_index, double& a_wx, double& a_wy, double& a_wz) const
+    {
+      const double fx = std::min( m_last[0], std::max( 0.0, (a_x - m_min[0]) * m_recipStep[0] ) );
+      const double fy = std::min( m_last[1], std::max( 0.0, (a_y - m_min[1]) * m_recipStep[1] ) );
+      const double fz = std::min( m_last[2], std::max( 0.0, (a_z - m_min[2]) * m_recipStep[2] ) );
+      const std::size_t ix = std::min( std::size_t(fx), m_n[0] - 2 );
+      const std::size_t iy = std::min( std::size_t(fy), m_n[1] - 2 );
+      const std::size_t iz = std::min( std::size_t(fz), m_n[2] - 2 );
+      a_wx = fx - double(ix);
+      a_wy = fy - double(iy);
+      a_wz = fz - double(iz);
+      a_index = ( ix * m_n[1] + iy ) * m_n[2] + iz;
+    }
+
+    // The values at a grid point. They're stored as floats so that
+    // more of the map fits in the cache, and padded to 16 bytes so
+    // that a point never straddles two cache lines.
+    struct Node {
+      float recipDriftVel;
+      float dispX;
+      float dispY;
+      float unused;
+    };
+
+    // Interpolate one quantity within the cell found by m_Locate.
+    double m_Interpolate(float Node::* a_value, std::size_t a_index,
+			 double a_wx, double a_wy, double a_wz) const
+    {
+      const Node* n000 = m_nodes.data() + a_index;
+      const Node* n100 = n000 + m_strideX;
+      const Node* n010 = n000 + m_strideY;
+      const Node* n110 = n100 + m_strideY;
+      // Along z, the two corners are next to each other in memory.
+      const double c00 = n000[0].*a_value + a_wz * ( n000[1].*a_value - n000[0].*a_value );
+      const double c01 = n010[0].*a_value + a_wz * ( n010[1].*a_value - n010[0].*a_value );
+      const double c10 = n100[0].*a_value + a_wz * ( n100[1].*a_value - n100[0].*a_value );
+      const double c11 = n110[0].*a_value + a_wz * ( n110[1].*a_value - n110[0].*a_value );
+      const double c0 = c00 + a_wy * ( c01 - c00 );
+      const double c1 = c10 + a_wy * ( c11 - c10 );
+      return c0 + a_wx * ( c1 - c0 );
+    }
+
+    // The number of grid points along x, y, and z; the position of
+    // the first point; and the spacing between points.
+    std::size_t m_n[3];
+    double m_min[3];
+    double m_step[3];
+    double m_recipStep[3];
+    double m_last[3];
+
+    // The distance in memory between neighboring points along x and
+    // y. Points along z are adjacent.
+    std::size_t m_strideX;
+    std::size_t m_strideY;
+
+    // The grid points, with z varying fastest. All three quantities
+    // for a point are together, since the diffusion models need all
+    // of them.
+    std::vector<Node> m_nodes;
+
+    bool m_verbose;
+  };
+
+} // namespace gramsdetsim
+
+#endif // DriftMap_h
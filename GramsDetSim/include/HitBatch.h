@@ -0,0 +1,42 @@
+// 16-Oct-2026
+
+// The LAr hits of an event, rearranged as a "structure of arrays":
+// one contiguous array per quantity, instead of one struct per
+// hit. This is the layout the batch versions of the detector-response
+// models work on; loops over these arrays can be vectorized by the
+// compiler.
+
+#ifndef HitBatch_h
+#define HitBatch_h
+
+// From GramsDataObj
+#include "MCLArHits.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace gramsdetsim {
+
+  struct HitBatch {
+
+    // The start and end of each step.
+    std::vector<double> startX, startY, startZ;
+    std::vector<double> endX, endY, endZ;
+
+    // The energy of each step. The models modify this array in place.
+    std::vector<double> energy;
+
+    // Copy the hits into the arrays, in the order they appear in the
+    // map. The arrays are resized but never shrunk, so that re-using
+    // a HitBatch for event after event doesn't allocate memory.
+    void Fill(const grams::FlatMCLArHits& hits);
+
+    // The same, for a selection of the hits.
+    void Fill(const std::vector< const grams::MCLArHit* >& hits);
+
+    std::size_t size() const { return energy.size(); }
+  };
+
+} // namespace gramsdetsim
+
+#endif // HitBatch_h
@@ -0,0 +1,112 @@
+// 16-Oct-2026
+
+// Decide which LAr hits are worth sending through the
+// detector-response models. Most of the hits in an event are small
+// deposits at the ends of electron tracks; together they carry
+// almost none of the charge that reaches the anode, but the models
+// spend as much time on each of them as on any other hit. Hits
+// outside the active volume of the TPC never reach the anode at all.
+
+// A hit is dropped if:
+//   - its energy is less than filterMinEnergy; or
+//   - filterVolumeIDs is not empty, and the hit's volumeID is not in
+//     that list; or
+//   - fiducialVolume is not empty, and the middle of the hit is not
+//     inside that volume (or is within fiducialMargin of its surface).
+// The tests are made in that order, and each dropped hit is counted
+// under the first test it fails.
+
+#ifndef HitFilter_h
+#define HitFilter_h
+
+// From GramsDataObj
+#include "MCLArHits.h"
+
+// Forward declarations of ROOT classes.
+class TGeoShape;
+class TGeoHMatrix;
+
+#include <vector>
+#include <cstddef>
+#include <ostream>
+
+namespace gramsdetsim {
+
+  class HitFilter
+  {
+  public:
+
+    // Constructor. Read the filter options; if there's a fiducial
+    // volume, find it in the geometry.
+    HitFilter();
+
+    // Is any of the tests turned on? If not, there's no point in
+    // calling Accept().
+    bool Active() const { return m_active; }
+
+    // Should this hit be processed? The counts are updated.
+    bool Accept(const grams::MCLArHit& hit)
+    {
+      ++m_counts.total;
+      if ( hit.energy < m_minEnergy ) {
+	++m_counts.energy;
+	return false;
+      }
+      if ( ! m_volumeIDs.empty()  &&  ! m_AllowedVolume(hit.volumeID) ) {
+	++m_counts.volume;
+	return false;
+      }
+      if ( m_fiducialShape != nullptr  &&  ! m_InFiducialVolume(hit) ) {
+	++m_counts.fiducial;
+	return false;
+      }
+      return true;
+    }
+
+    // The number of hits seen, and the number dropped by each test.
+    struct Counts {
+      std::size_t total    = 0;
+      std::size_t energy   = 0;
+      std::size_t volume   = 0;
+      std::size_t fiducial = 0;
+
+      Counts& operator+=(const Counts& a_other)
+      {
+	total    += a_other.total;
+	energy   += a_other.energy;
+	volume   += a_other.volume;
+	fiducial += a_other.fiducial;
+	return *this;
+      }
+    };
+    const Counts& GetCounts() const { return m_counts; }
+
+  private:
+
+    bool m_AllowedVolume(int volumeID) const;
+    bool m_InFiducialVolume(const grams::MCLArHit& hit) const;
+
+    bool m_active;
+    double m_minEnergy;
+
+    // The allowed volume IDs, sorted.
+    std::vector<int> m_volumeIDs;
+
+    // The fiducial volume's shape, and the transformation from the
+    // detector's coordinates to the shape's. These belong to the
+    // geometry, which is shared by all the filters in the job.
+    const TGeoShape* m_fiducialShape;
+    const TGeoHMatrix* m_fiducialMatrix;
+    double m_fiducialMargin;
+
+    Counts m_counts;
+  };
+
+} // namespace gramsdetsim
+
+// Print a summary of the counts: how many hits there were, and how
+// many were dropped by each test. Like the data objects' operators,
+// it's outside the namespace.
+std::ostream& operator<<(std::ostream& out, const gramsdetsim::HitFilter::Counts& counts);
+
+#endif // HitFilter_h
@@ -0,0 +1,78 @@
+// 16-Oct-2026
+
+// Run the detector-response models with several sets of parameters
+// in a single pass over the input. For studies of systematic
+// uncertainties, gramsdetsim is often run many times on the same
+// gramsg4 file with different values of (e.g.) box_alpha or
+// ElectronLifeTimeCorr; when the models are fast, most of that time
+// goes into reading the hits again.
+
+// The parameter sets are read from the file named by the
+// parameterScan option. Each line of the file has a tag, followed
+// by the options to change and their new values:
+
+//   # tag      option=value ...
+//   alphaLow   box_alpha=0.90
+//   fieldHigh  ElectricField=0.55 box_beta=0.20
+
+// Blank lines and anything after a '#' are ignored. The options not
+// mentioned on a line keep the values they have for the job.
+
+#ifndef ParameterScan_h
+#define ParameterScan_h
+
+#include "DetectorResponse.h"
+
+// ROOT includes
+#include "TRandom.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+namespace gramsdetsim {
+
+  class ParameterScan
+  {
+  public:
+
+    // Read the file named by the parameterScan option. Setting 0 is
+    // always the job's own options (the "nominal" setting); the
+    // settings in the file, if any, follow it.
+    ParameterScan();
+
+    // The number of settings, including the nominal one.
+    std::size_t size() const { return m_settings.size(); }
+
+    // The tag of a setting. It's empty for the nominal setting.
+    const std::string& Tag(std::size_t i) const { return m_settings[i].tag; }
+
+    // The changed options of a setting, in the form
+    // "option=value option=value".
+    std::string Description(std::size_t i) const;
+
+    // Create the models with the options of setting i. See
+    // DetectorResponse for the meaning of 'random'.
+    std::unique_ptr<DetectorResponse> MakeResponse(std::size_t i, TRandom* random = nullptr) const;
+
+  private:
+
+    struct Setting {
+      std::string tag;
+      std::vector< std::pair<std::string,std::string> > changes;
+    };
+    std::vector<Setting> m_settings;
+
+    // Set the options of a setting, or put back the job's values.
+    void m_Apply(const Setting& setting) const;
+    void m_Restore() const;
+
+    // The job's values of every option that any setting changes.
+    std::vector< std::pair<std::string,std::string> > m_nominal;
+  };
+
+} // namespace gramsdetsim
+
+#endif // ParameterScan_h
@@ -5,6 +5,8 @@
 #ifndef RecombinationModel_h
 #define RecombinationModel_h
 
+#include "HitBatch.h"
+
 // From GramsDataObj
 #include "MCLArHits.h"
 
@@ -23,6 +25,13 @@ namespace gramsdetsim {
     // entry of the ntuple, calculate a revised energy.
     double Calculate(double energy, const grams::MCLArHit& hit);
 
+    // The same calculation for all the hits in an event at once. The
+    // energies in 'hits' are replaced by the revised energies. Unlike
+    // the single-hit version above, a result that's not a number
+    // (e.g., from a step of zero length) is set to zero. This
+    // routine does not print debugging information.
+    void Calculate(HitBatch& hits) { (this->*m_batchCalculate)(hits); }
+
   private:
 
     // Note that it's a convention to prefix variables defined in a
@@ -43,6 +52,61 @@ namespace gramsdetsim {
     // Save the verbose and debug options.
     bool m_verbose;
     bool m_debug;
+
+    // The batch versions of the models. The constructor points
+    // m_batchCalculate at the one chosen by the user, so that there's
+    // no test of the model number inside the loop over hits.
+    void m_BoxCalculate(HitBatch& hits);
+    void m_BirksCalculate(HitBatch& hits);
+    void m_TableCalculate(HitBatch& hits);
+    void (RecombinationModel::*m_batchCalculate)(HitBatch&);
+
+    // Both models depend only on the "reduced" dE/dx,
+    //   u = (dE/dx) / (field * density),
+    // so the correction can be tabulated as a function of u once per
+    // job. A field that varies with position only changes u, not the
+    // table. m_Effect is the correction computed from the formula;
+    // for the box model, it's before the lower limit of 1.0e-6 is
+    // applied.
+    double m_Effect(double u) const;
+
+    // The correction from the table. If u is outside the table, the
+    // formula is used instead.
+    double m_TableEffect(double u) const;
+
+    // Fill the table, making its bins smaller until the
+    // interpolation error is below m_tableTolerance.
+    void m_BuildTable();
+
+    // Use the table instead of the formula?
+    bool m_useTable;
+    double m_tableTolerance;
+
+    // The table is indexed by the bits of u as an IEEE double: the
+    // exponent and the leading m_tableBits bits of the mantissa. That
+    // makes the bins evenly spaced in log2(u) from one power of 2 to
+    // the next, and the bin of any u can be found with a shift and a
+    // subtraction instead of a logarithm. Within a bin, the
+    // correction is a straight line.
+    struct TableBin {
+      double u;      // lower edge of the bin
+      double value;  // correction at the lower edge
+      double slope;  // change in the correction per unit of u
+    };
+    std::vector<TableBin> m_table;
+    int m_tableBits;
+    int m_tableShift;
+    long long m_tableBase;
+    double m_tableMin;
+    double m_tableMax;
+
+    // The lower limit on the correction: 1.0e-6 for the box model,
+    // no limit for Birks' model.
+    double m_minEffect;
+
+    // Work space for the batch calculations.
+    std::vector<double> m_dEdx;
+    std::vector<double> m_work;
   };
 
 } // namespace gramsdetsim
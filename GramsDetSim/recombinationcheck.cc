@@ -0,0 +1,130 @@
+// recombinationcheck.cc
+// Check the tabulated recombination correction (RecombinationTable)
+// against the formula it replaces. See "Benchmarks" in
+// GramsDetSim/README.md.
+// 16-Oct-2026
+
+#include "RecombinationModel.h"
+#include "HitBatch.h"
+
+// For processing command-line and XML file options.
+#include "Options.h" // in util/
+
+// C++ includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstddef>
+
+namespace {
+
+  // A batch of hits along z whose dE/dx runs evenly in log10 from
+  // 'minLog' to 'maxLog' over 'n' hits. The step lengths vary, so
+  // the same dE/dx is reached with different energies.
+  gramsdetsim::HitBatch LogSpacedHits(std::size_t a_n, double a_minLog, double a_maxLog)
+  {
+    gramsdetsim::HitBatch hits;
+    hits.startX.assign(a_n, 0.);
+    hits.startY.assign(a_n, 0.);
+    hits.startZ.assign(a_n, 0.);
+    hits.endX.assign(a_n, 0.);
+    hits.endY.assign(a_n, 0.);
+    hits.endZ.resize(a_n);
+    hits.energy.resize(a_n);
+    for ( std::size_t i = 0; i != a_n; ++i ) {
+      const double length = 0.001 + 0.05 * double( ( i * 7919 ) % 1000 ) / 1000.;
+      const double dEdx = std::pow( 10., a_minLog + ( a_maxLog - a_minLog ) * double(i) / double(a_n) );
+      hits.endZ[i] = length;
+      hits.energy[i] = dEdx * length;
+    }
+    return hits;
+  }
+
+  void Set(const std::string& a_name, const std::string& a_value)
+  {
+    if ( ! util::Options::GetInstance()->SetOption(a_name, a_value) ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "recombinationcheck: could not set option " << a_name
+		<< "=" << a_value << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+} // anonymous namespace
+
+int main(int argc,char **argv)
+{
+  // The models are configured by the <gramsdetsim> options, apart
+  // from RecombinationModel and RecombinationTable, which this
+  // program sets itself.
+  auto options = util::Options::GetInstance();
+  auto result = options->ParseOptions(argc, argv, "gramsdetsim");
+
+  // Abort if we couldn't parse the job options.
+  if (! result) {
+    std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+	      << "recombinationcheck: Aborting job due to failure to parse options"
+	      << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  bool help;
+  options->GetOption("help",help);
+  if (help) {
+    options->PrintHelp();
+    exit(EXIT_SUCCESS);
+  }
+
+  double tolerance;
+  options->GetOption("RecombinationTableTolerance",tolerance);
+
+  // From far below a MIP to far above a stopping alpha, in the
+  // units of options.xml. Hits above or below the table use the
+  // formula, so they test the fallback too.
+  const std::size_t numHits = 200000;
+  const double minLog = -3.;
+  const double maxLog = 6.;
+
+  const char* names[2] = { "box", "Birks" };
+  bool passed = true;
+  for ( int model = 0; model != 2; ++model ) {
+    Set( "RecombinationModel", std::to_string(model) );
+    Set( "RecombinationTable", "0" );
+    gramsdetsim::RecombinationModel formula;
+    Set( "RecombinationTable", "1" );
+    gramsdetsim::RecombinationModel table;
+
+    auto formulaHits = LogSpacedHits( numHits, minLog, maxLog );
+    auto tableHits = formulaHits;
+    const auto original = formulaHits.energy;
+    formula.Calculate( formulaHits );
+    table.Calculate( tableHits );
+
+    // The difference in the correction, the ratio of the revised
+    // energy to the original one.
+    double worst = 0.;
+    double worstDEdx = 0.;
+    for ( std::size_t i = 0; i != numHits; ++i ) {
+      const double difference
+	= std::abs( formulaHits.energy[i] - tableHits.energy[i] ) / original[i];
+      if ( difference > worst ) {
+	worst = difference;
+	worstDEdx = original[i] / formulaHits.endZ[i];
+      }
+    }
+
+    const bool ok = ( worst <= tolerance );
+    passed &= ok;
+    std::cout << "recombinationcheck: " << names[model] << " model, "
+	      << numHits << " hits with dE/dx from 1e" << minLog << " to 1e" << maxLog
+	      << ": largest difference in the correction " << worst
+	      << " at dE/dx=" << worstDEdx
+	      << " (RecombinationTableTolerance=" << tolerance << ")"
+	      << ( ok ? "" : " FAILED" ) << std::endl;
+  }
+
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -2,6 +2,8 @@
 // Implement a absorption model calculation.
 
 #include "AbsorptionModel.h"
+#include "DriftMap.h"
+#include "DriftAxis.h" // in util/
 
 // For processing command-line and XML file options.
 #include "Options.h" // in util/
@@ -12,6 +14,8 @@
 // C++ includes
 #include <iostream>
 #include <cmath>
+#include <vector>
+#include <cstddef>
 
 namespace gramsdetsim {
 
@@ -37,24 +41,68 @@ namespace gramsdetsim {
     }
 
     m_RecipDriftVel = 1.0 / m_DriftVel;
+
+    m_driftMap = DriftMap::GetInstance();
+
+    // See DiffusionModel. The absorption only depends on the drift
+    // time, not its direction.
+    int driftAxis;
+    double driftDirection;
+    util::GetDriftAxisOptions(driftAxis, driftDirection);
+    switch (driftAxis) {
+    case 0:
+      m_calculate = &AbsorptionModel::m_Calculate<0>;
+      m_calculateBatch = &AbsorptionModel::m_CalculateBatch<0>;
+      break;
+    case 1:
+      m_calculate = &AbsorptionModel::m_Calculate<1>;
+      m_calculateBatch = &AbsorptionModel::m_CalculateBatch<1>;
+      break;
+    default:
+      m_calculate = &AbsorptionModel::m_Calculate<2>;
+      m_calculateBatch = &AbsorptionModel::m_CalculateBatch<2>;
+      break;
+    }
   }
 
   // Note that the "a_" prefix is a convention to remind us that the
   // variable was an argument in this method.
 
   double AbsorptionModel::Calculate( double a_energy, const grams::MCLArHit& hit ) {
+    return (this->*m_calculate)(a_energy, hit);
+  }
 
-    double z_mean = 0.5 * ( hit.StartZ() + hit.EndZ() );
+  void AbsorptionModel::Calculate( HitBatch& a_hits ) {
+    (this->*m_calculateBatch)(a_hits);
+  }
+
+  template <int Axis>
+  double AbsorptionModel::m_Calculate( double a_energy, const grams::MCLArHit& hit ) {
+
+    // The names are those of a drift along the z-axis.
+    using Drift = util::DriftAxis<Axis>;
+    double z_mean = 0.5 * ( Drift::Along(hit.start) + Drift::Along(hit.end) );
+
+    // With a drift map, the drift velocity depends on where the
+    // electrons start.
+    double recipDriftVel = m_RecipDriftVel;
+    if ( m_driftMap != nullptr ) {
+      double dispX, dispY;
+      m_driftMap->Lookup( 0.5 * ( hit.StartX() + hit.EndX() ),
+			  0.5 * ( hit.StartY() + hit.EndY() ),
+			  0.5 * ( hit.StartZ() + hit.EndZ() ),
+			  recipDriftVel, dispX, dispY );
+    }
 
     double DriftDistance = m_readout_plane_coord - z_mean;
-    double TDrift = std::abs(DriftDistance * m_RecipDriftVel);
+    double TDrift = std::abs(DriftDistance * recipDriftVel);
 
     double effect = std::exp( -1.0 * TDrift / m_LifeTimeCorr_const);
 
     if (m_debug) {
       std::cout << "GramsDetSim::AbsorptionModel - "
-		<< " hit.StartZ()=" << hit.StartZ()
-		<< " hit.EndZ()=" << hit.EndZ()
+		<< " start=" << Drift::Along(hit.start)
+		<< " end=" << Drift::Along(hit.end)
 		<< " z_mean=" << z_mean
 		<< " DriftDistance=" << DriftDistance
 		<< " TDrift=" << TDrift
@@ -67,4 +115,72 @@ namespace gramsdetsim {
     return a_energy *  effect;
   }
 
+  // The same formula as above, written as simple loops over arrays so
+  // that the compiler can turn them into vector instructions. std::exp
+  // can't be vectorized without giving up strict IEEE math, so it's
+  // done in a loop of its own.
+
+  template <int Axis>
+  void AbsorptionModel::m_CalculateBatch( HitBatch& a_hits ) {
+
+    const std::size_t n = a_hits.size();
+    m_work.resize(n);
+
+    // The start and end of each hit along the drift axis.
+    using Drift = util::DriftAxis<Axis>;
+    const double* sa = Drift::template Pick<Axis>( a_hits.startX.data(), a_hits.startY.data(), a_hits.startZ.data() );
+    const double* ea = Drift::template Pick<Axis>( a_hits.endX.data(),   a_hits.endY.data(),   a_hits.endZ.data() );
+    double* energy = a_hits.energy.data();
+    double* effect = m_work.data();
+
+    const double readoutPlane = m_readout_plane_coord;
+    const double recipDriftVel = m_RecipDriftVel;
+    const double lifeTime = m_LifeTimeCorr_const;
+
+    if ( m_driftMap == nullptr ) {
+      for ( std::size_t i = 0; i < n; ++i ) {
+	const double z_mean = 0.5 * ( sa[i] + ea[i] );
+	const double TDrift = std::abs( (readoutPlane - z_mean) * recipDriftVel );
+	effect[i] = -1.0 * TDrift / lifeTime;
+      }
+    }
+    else {
+      // Look up the drift velocities for all the hits' midpoints at
+      // once, then use them in the same loop as above.
+      m_midX.resize(n);
+      m_midY.resize(n);
+      m_midZ.resize(n);
+      m_recipDriftVel.resize(n);
+      const double* sx = a_hits.startX.data();
+      const double* ex = a_hits.endX.data();
+      const double* sy = a_hits.startY.data();
+      const double* ey = a_hits.endY.data();
+      const double* sz = a_hits.startZ.data();
+      const double* ez = a_hits.endZ.data();
+      double* mx = m_midX.data();
+      double* my = m_midY.data();
+      double* mz = m_midZ.data();
+      for ( std::size_t i = 0; i < n; ++i ) {
+	mx[i] = 0.5 * ( sx[i] + ex[i] );
+	my[i] = 0.5 * ( sy[i] + ey[i] );
+	mz[i] = 0.5 * ( sz[i] + ez[i] );
+      }
+      const double* recip = m_recipDriftVel.data();
+      m_driftMap->RecipDriftVel( n, mx, my, mz, m_recipDriftVel.data() );
+      const double* mAlong = Drift::template Pick<Axis>( mx, my, mz );
+      for ( std::size_t i = 0; i < n; ++i ) {
+	const double TDrift = std::abs( (readoutPlane - mAlong[i]) * recip[i] );
+	effect[i] = -1.0 * TDrift / lifeTime;
+      }
+    }
+
+    // Hits with no energy are multiplied by 1 rather than skipped, so
+    // the last loop has no branches.
+    for ( std::size_t i = 0; i < n; ++i )
+      effect[i] = ( energy[i] > 0. ) ? std::exp( effect[i] ) : 1.0;
+
+    for ( std::size_t i = 0; i < n; ++i )
+      energy[i] *= effect[i];
+  }
+
 } // namespace gramsdetsim
@@ -0,0 +1,251 @@
+// 16-Oct-2026
+// Deposit the diffused charge of each hit directly onto the
+// pixel/time grid.
+
+#include "AnalyticDiffusionModel.h"
+#include "DriftMap.h"
+#include "DriftAxis.h" // in util/
+
+// For processing command-line and XML file options.
+#include "Options.h" // in util/
+
+// From GramsDataObj
+#include "MCLArHits.h"
+#include "ElectronClusters.h"
+#include "PixelGeometry.h"
+
+// From GramsReadoutSim
+#include "AnodeGrid.h"
+#include "PixelGeometryIO.h"
+
+// ROOT includes
+#include "Math/Vector4D.h"
+#include "TRandom.h"
+
+// C++ includes
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <cstddef>
+
+namespace gramsdetsim {
+
+  // Constructor: Initializes the class.
+  AnalyticDiffusionModel::AnalyticDiffusionModel()
+    : AnalyticDiffusionModel( gramsreadoutsim::JobPixelGeometry() )
+  {}
+
+  AnalyticDiffusionModel::AnalyticDiffusionModel(const grams::PixelGeometry& a_geometry)
+    : m_grid( a_geometry )
+  {
+    auto options = util::Options::GetInstance();
+
+    options->GetOption("verbose",            m_verbose);
+    options->GetOption("debug",              m_debug);
+
+    options->GetOption("MeVToElectrons",        m_MeVToElectrons);
+    options->GetOption("LongitudinalDiffusion", m_LongitudinalDiffusion);
+    options->GetOption("TransverseDiffusion",   m_TransverseDiffusion);
+    options->GetOption("ReadoutPlaneCoord",     m_readout_plane_coord);
+    options->GetOption("ElectronDriftVelocity", m_DriftVel);
+
+    // The time bins are those of gramselecsim.
+    options->GetOption("timebin_width", m_timeBinWidth);
+
+    if ( m_grid.size() == 0  ||  m_timeBinWidth <= 0 ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramsdetsim::AnalyticDiffusionModel: "
+		<< "the pixel geometry has no tiles, or timebin_width is not positive"
+		<< std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    m_RecipDriftVel = 1.0 / m_DriftVel;
+
+    m_driftMap = DriftMap::GetInstance();
+
+    // See DiffusionModel.
+    int driftAxis;
+    util::GetDriftAxisOptions(driftAxis, m_driftDirection);
+    switch (driftAxis) {
+    case 0:  m_calculate = &AnalyticDiffusionModel::m_Calculate<0>; break;
+    case 1:  m_calculate = &AnalyticDiffusionModel::m_Calculate<1>; break;
+    default: m_calculate = &AnalyticDiffusionModel::m_Calculate<2>; break;
+    }
+
+    m_random = gRandom;
+
+    if (m_verbose || m_debug) {
+      std::cout << "gramsdetsim::AnalyticDiffusionModel - "
+		<< "LongitudinalDiffusion= " << m_LongitudinalDiffusion
+		<< " TransverseDiffusion= " << m_TransverseDiffusion
+		<< " tiles=" << m_grid.size()
+		<< " tile 0 pitch=(" << m_grid[0].pitchX << "," << m_grid[0].pitchY << ")"
+		<< " origin=(" << m_grid[0].offsetX << "," << m_grid[0].offsetY << ")"
+		<< " timebin_width=" << m_timeBinWidth
+		<< std::endl;
+    }
+  }
+
+  void AnalyticDiffusionModel::m_BinProbabilities(double a_mean, double a_sigma,
+						  double a_origin, double a_width,
+						  int& a_firstBin,
+						  std::vector<double>& a_probabilities) const
+  {
+    // Without diffusion, everything goes into one bin.
+    if ( a_sigma <= 0.0 ) {
+      a_firstBin = int( std::floor( (a_mean - a_origin) / a_width ) );
+      a_probabilities.assign( 1, 1.0 );
+      return;
+    }
+
+    a_firstBin   = int( std::floor( (a_mean - m_nSigma * a_sigma - a_origin) / a_width ) );
+    const int lastBin = int( std::floor( (a_mean + m_nSigma * a_sigma - a_origin) / a_width ) );
+    a_probabilities.resize( lastBin - a_firstBin + 1 );
+
+    // The fraction of the Gaussian below x is
+    // 0.5*erfc( -(x-mean) / (sqrt(2)*sigma) ).
+    const double scale = -1.0 / ( std::sqrt(2.0) * a_sigma );
+    double lowerEdge = a_origin + a_firstBin * a_width;
+    double lower = 0.5 * std::erfc( (lowerEdge - a_mean) * scale );
+    for ( std::size_t i = 0; i != a_probabilities.size(); ++i ) {
+      const double upperEdge = lowerEdge + a_width;
+      const double upper = 0.5 * std::erfc( (upperEdge - a_mean) * scale );
+      a_probabilities[i] = upper - lower;
+      lowerEdge = upperEdge;
+      lower = upper;
+    }
+  }
+
+  void AnalyticDiffusionModel::m_Divide(int a_n, const std::vector<double>& a_probabilities,
+					std::vector<int>& a_counts)
+  {
+    a_counts.assign( a_probabilities.size(), 0 );
+
+    double remaining = 0.0;
+    for ( const auto p : a_probabilities ) remaining += p;
+
+    for ( std::size_t i = 0; i != a_probabilities.size()  &&  a_n > 0; ++i ) {
+      // The probability that an electron is in this bin, given that
+      // it's not in any of the previous ones.
+      const double p = ( remaining > 0.0 ) ? a_probabilities[i] / remaining : 1.0;
+      const int count = ( p >= 1.0  ||  i + 1 == a_probabilities.size() )
+	? a_n : m_random->Binomial( a_n, p );
+      a_counts[i] = count;
+      a_n -= count;
+      remaining -= a_probabilities[i];
+    }
+  }
+
+  void AnalyticDiffusionModel::Calculate(double a_energy,
+					 const grams::MCLArHit& a_hit,
+					 int& a_clusterID,
+					 std::vector< grams::ElectronCluster >& a_clusters)
+  {
+    (this->*m_calculate)(a_energy, a_hit, a_clusterID, a_clusters);
+  }
+
+  template <int Axis>
+  void AnalyticDiffusionModel::m_Calculate(double a_energy,
+					   const grams::MCLArHit& a_hit,
+					   int& a_clusterID,
+					   std::vector< grams::ElectronCluster >& a_clusters)
+  {
+    // As in DiffusionModel, the hit is treated as a point at the
+    // middle of the step. The names are those of a drift along the
+    // z-axis; the pixel grid is across the drift.
+    using Drift = util::DriftAxis<Axis>;
+    double x_mean = 0.5 * (Drift::Across1(a_hit.start) + Drift::Across1(a_hit.end));
+    double y_mean = 0.5 * (Drift::Across2(a_hit.start) + Drift::Across2(a_hit.end));
+    const double z_mean = 0.5 * (Drift::Along(a_hit.start) + Drift::Along(a_hit.end));
+
+    // See DiffusionModel::Calculate.
+    double recipDriftVel = m_RecipDriftVel;
+    if ( m_driftMap != nullptr ) {
+      double dispX, dispY;
+      m_driftMap->Lookup( 0.5 * (a_hit.StartX() + a_hit.EndX()),
+			  0.5 * (a_hit.StartY() + a_hit.EndY()),
+			  0.5 * (a_hit.StartZ() + a_hit.EndZ()),
+			  recipDriftVel, dispX, dispY );
+      x_mean += dispX;
+      y_mean += dispY;
+    }
+
+    const double DriftDistance = m_driftDirection * (m_readout_plane_coord - z_mean);
+    const double mean_TDrift = std::abs(DriftDistance * recipDriftVel);
+    const double SqrtT = std::sqrt(mean_TDrift);
+
+    const double LDiffSig = SqrtT * std::sqrt(2. * m_LongitudinalDiffusion);
+    const double TDiffSig = SqrtT * std::sqrt(2. * m_TransverseDiffusion);
+
+    // The arrival time, and its spread due to longitudinal
+    // diffusion.
+    const double t_mean = DriftDistance * recipDriftVel;
+    const double t_sigma = LDiffSig * std::abs(recipDriftVel);
+
+    const double nElectrons = a_energy * m_MeVToElectrons;
+    const int n = int( std::lround(nElectrons) );
+    if ( n <= 0 ) return;
+
+    // The profile is a product of independent Gaussians in x, y,
+    // and t, so the electrons can be divided among the x bins, then
+    // each x bin's electrons among the y bins, and so on. The
+    // result has the same distribution as dividing them among the
+    // (x,y,t) cells directly, but skips the cells of any x or y bin
+    // that received no electrons.
+    // The pixel boundaries of the tile are at its offset plus a
+    // multiple of its pitch; see AnodeGrid.
+    const auto& tile = m_grid[ m_grid.NearestTile( x_mean, y_mean ) ];
+    int firstX, firstY, firstT;
+    m_BinProbabilities( x_mean, TDiffSig, tile.offsetX, tile.pitchX, firstX, m_probX );
+    m_BinProbabilities( y_mean, TDiffSig, tile.offsetY, tile.pitchY, firstY, m_probY );
+    m_BinProbabilities( t_mean, t_sigma,  0.0,          m_timeBinWidth, firstT, m_probT );
+
+    if ( m_debug ) {
+      std::cout << "gramsdetsim::AnalyticDiffusionModel::Calculate - "
+		<< " n=" << n
+		<< " TDiffSig=" << TDiffSig
+		<< " t_mean=" << t_mean
+		<< " t_sigma=" << t_sigma
+		<< " x bins=" << m_probX.size()
+		<< " y bins=" << m_probY.size()
+		<< " t bins=" << m_probT.size()
+		<< std::endl;
+    }
+
+    const double energyPerElectron = a_energy / nElectrons;
+
+    m_Divide( n, m_probX, m_countX );
+    for ( std::size_t ix = 0; ix != m_countX.size(); ++ix ) {
+      if ( m_countX[ix] == 0 ) continue;
+      const double x = tile.offsetX + ( firstX + int(ix) + 0.5 ) * tile.pitchX;
+
+      m_Divide( m_countX[ix], m_probY, m_countY );
+      for ( std::size_t iy = 0; iy != m_countY.size(); ++iy ) {
+	if ( m_countY[iy] == 0 ) continue;
+	const double y = tile.offsetY + ( firstY + int(iy) + 0.5 ) * tile.pitchY;
+
+	m_Divide( m_countY[iy], m_probT, m_countT );
+	for ( std::size_t it = 0; it != m_countT.size(); ++it ) {
+	  if ( m_countT[it] == 0 ) continue;
+	  const double t = ( firstT + int(it) + 0.5 ) * m_timeBinWidth;
+
+	  grams::ElectronCluster cluster;
+	  cluster.trackID = a_hit.trackID;
+	  cluster.hitID = a_hit.hitID;
+	  cluster.clusterID = a_clusterID++;
+	  cluster.numElectrons = m_countT[it];
+	  cluster.energy = energyPerElectron * m_countT[it];
+
+	  // As in DiffusionModel, z is the value that corresponds to
+	  // the arrival time.
+	  const double z = z_mean + ( t / recipDriftVel - DriftDistance );
+	  cluster.position = Drift::Position( z, x, y, t );
+
+	  a_clusters.push_back( cluster );
+	}
+      }
+    }
+  }
+
+} // namespace gramsdetsim
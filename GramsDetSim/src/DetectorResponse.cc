@@ -0,0 +1,226 @@
+// 16-Oct-2026
+// Apply the detector-response models to the hits in an event.
+
+#include "DetectorResponse.h"
+#include "RecombinationModel.h"
+#include "AbsorptionModel.h"
+#include "DiffusionModel.h"
+#include "AnalyticDiffusionModel.h"
+#include "HitBatch.h"
+#include "HitFilter.h"
+
+// For processing command-line and XML file options.
+#include "Options.h" // in util/
+
+// From GramsDataObj
+#include "MCLArHits.h"
+#include "ElectronClusters.h"
+
+// ROOT includes
+#include "TRandom.h"
+
+// C++ includes
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace gramsdetsim {
+
+  // Constructor: Initializes the class.
+  DetectorResponse::DetectorResponse(TRandom* a_random)
+    : m_nextHit(0)
+    , m_clusterID(0)
+  {
+    // Get the options class. This contains all the program options
+    // from options.xml and the command line.
+    auto options = util::Options::GetInstance();
+
+    options->GetOption("verbose",m_verbose);
+    options->GetOption("debug",m_debug);
+
+    // Are we using this particular model?
+    options->GetOption("recombination",m_doRecombination);
+
+    // If we're using this model, initialize it.
+    if ( m_doRecombination ) {
+      m_recombinationModel = std::make_unique<RecombinationModel>();
+      if (m_verbose)
+	std::cout << "gramsdetsim: RecombinationModel turned on" << std::endl;
+    }
+    else {
+      if (m_verbose)
+	std::cout << "gramsdetsim: RecombinationModel turned off" << std::endl;
+    }
+
+    //absorption
+    options->GetOption("absorption", m_doAbsorption);
+
+    if ( m_doAbsorption ) {
+      m_absorptionModel = std::make_unique<AbsorptionModel>();
+      if (m_verbose)
+	std::cout << "gramsdetsim: AbsorptionModel turned on" << std::endl;
+    }
+    else {
+      if (m_verbose)
+	std::cout << "gramsdetsim: AbsorptionModel turned off" << std::endl;
+    }
+
+    //diffusion
+    options->GetOption("diffusion", m_doDiffusion);
+    options->GetOption("AnalyticDiffusion", m_analyticDiffusion);
+
+    if ( m_doDiffusion  &&  m_analyticDiffusion ) {
+      m_analyticDiffusionModel = std::make_unique<AnalyticDiffusionModel>();
+      if ( a_random != nullptr )
+	m_analyticDiffusionModel->SetRandom(a_random);
+      if (m_verbose)
+	std::cout << "gramsdetsim: AnalyticDiffusionModel turned on" << std::endl;
+    }
+    else if ( m_doDiffusion ) {
+      m_diffusionModel = std::make_unique<DiffusionModel>();
+      if ( a_random != nullptr )
+	m_diffusionModel->SetRandom(a_random);
+      if (m_verbose)
+	std::cout << "gramsdetsim: DiffusionModel turned on" << std::endl;
+    }
+    else {
+      if (m_verbose)
+	std::cout << "gramsdetsim: DiffusionModel turned off" << std::endl;
+    }
+  }
+
+  // Note that the "a_" prefix is a convention to remind us that the
+  // variable was an argument in this method.
+
+  void DetectorResponse::Process(const grams::FlatMCLArHits& a_hits,
+				 grams::FlatElectronClusters& a_clusters)
+  {
+    // All the hits in one segment.
+    Begin(a_hits);
+    Next(a_clusters);
+  }
+
+  void DetectorResponse::Begin(const grams::FlatMCLArHits& a_hits)
+  {
+    // Select the hits to process. The pointers refer to 'a_hits',
+    // which is why it must not change until the last call to Next().
+    m_hits.clear();
+    if ( m_hitFilter.Active() ) {
+      for ( const auto& [ key, hit ] : a_hits )
+	if ( m_hitFilter.Accept(hit) )
+	  m_hits.push_back( &hit );
+    }
+    else {
+      for ( const auto& [ key, hit ] : a_hits )
+	m_hits.push_back( &hit );
+    }
+    m_nextHit = 0;
+
+    // Increase the clusterID across all the hits in this event, even
+    // if they're split into segments.
+    m_clusterID = 0;
+
+    // Apply the recombination and absorption models to all the hits
+    // in the event at once. In debug mode, use the single-hit
+    // versions of the models instead, since they print their
+    // intermediate results.
+    if ( ! m_debug ) {
+      m_batch.Fill(m_hits);
+      if ( m_doRecombination )
+	m_recombinationModel->Calculate(m_batch);
+      if ( m_doAbsorption )
+	m_absorptionModel->Calculate(m_batch);
+    }
+  }
+
+  bool DetectorResponse::Next(grams::FlatElectronClusters& a_clusters,
+			      std::size_t a_maxClusters)
+  {
+    // Clean out any cluster data from the previous segment.
+    a_clusters.clear();
+    m_clusterBuffer.clear();
+
+    const std::size_t numHits = m_hits.size();
+
+    // For each remaining hit in the event, until the segment is full:
+    for ( ; m_nextHit != numHits; ++m_nextHit ) {
+
+      if ( a_maxClusters > 0  &&  m_clusterBuffer.size() >= a_maxClusters )
+	break;
+
+      const auto& hit = *m_hits[ m_nextHit ];
+
+      // The total hit energy after recombination and absorption.
+      double energy_sca;
+
+      if ( ! m_debug ) {
+	energy_sca = m_batch.energy[ m_nextHit ];
+      }
+      else {
+	energy_sca = hit.energy;
+
+        std::cout << "gramsdetsim: before model corrections, energy="
+		  << energy_sca
+		  << std::endl;
+
+	// Apply the model(s). Handle potential computation errors (i.e.,
+	// if dx is zero) within the different models.
+
+	if ( m_doRecombination ) {
+	  energy_sca = m_recombinationModel->Calculate(energy_sca, hit);
+	  if ( std::isnan(energy_sca) )
+	    energy_sca = 0.0;
+	}
+
+	std::cout << "gramsdetsim: after recombination model corrections, energyAtAnode="
+		  << energy_sca << std::endl;
+
+	//absorption
+	if ( m_doAbsorption  &&  energy_sca > 0. )
+	  energy_sca = m_absorptionModel->Calculate(energy_sca, hit);
+
+	std::cout << "gramsdetsim: after absorption model corrections, energyAtAnode="
+		  << energy_sca << std::endl;
+      }
+
+      //diffusion
+      const std::size_t firstCluster = m_clusterBuffer.size();
+      if ( m_doDiffusion  &&  energy_sca > 0. ) {
+	// The diffusion model appends this hit's clusters to the
+	// buffer. Maintain and increment the cluster ID across all the
+	// clusters in this event.
+	if ( m_analyticDiffusion )
+	  m_analyticDiffusionModel->Calculate(energy_sca, hit, m_clusterID, m_clusterBuffer);
+	else
+	  m_diffusionModel->Calculate(energy_sca, hit, m_clusterID, m_clusterBuffer);
+      }
+
+      if (m_debug) {
+	std::cout << "gramsdetsim: after diffusion model corrections, calcClusters.size()="
+		  << m_clusterBuffer.size() - firstCluster << std::endl;
+	std::cout << hit << std::endl;
+	for ( std::size_t c = firstCluster; c != m_clusterBuffer.size(); ++c ) {
+	  std::cout << m_clusterBuffer[c] << std::endl;
+	}
+	std::cout << std::endl;
+      }
+
+    } // for each hit
+
+    // Copy the clusters into the segment's list. The hits are visited
+    // in key order and the cluster IDs increase, so the clusters are
+    // already sorted by key and each one is appended to the end of
+    // the list.
+    a_clusters.reserve( m_clusterBuffer.size() );
+    for ( const auto& cluster : m_clusterBuffer ) {
+      // Create the key for this cluster.
+      auto ckey = std::make_tuple( cluster.trackID, cluster.hitID, cluster.clusterID );
+      a_clusters.emplace_hint( a_clusters.end(), ckey, cluster );
+    }
+
+    return m_nextHit != numHits;
+  }
+
+} // namespace gramsdetsim
@@ -5,10 +5,15 @@
 // https://github.com/LArSoft/larsim/blob/develop/larsim/ElectronDrift/SimDriftElectrons_module.cc
 
 #include "DiffusionModel.h"
+#include "DriftMap.h"
+#include "DriftAxis.h" // in util/
 
 // For processing command-line and XML file options.
 #include "Options.h" // in util/
 
+// For bulk Gaussian random numbers.
+#include "RandomService.h" // in util/
+
 // From GramsDataObj
 #include "MCLArHits.h"
 #include "ElectronClusters.h"
@@ -21,6 +26,7 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
+#include <cstddef>
 
 namespace gramsdetsim {
 
@@ -46,6 +52,20 @@ namespace gramsdetsim {
 
     m_RecipDriftVel = 1.0 / m_DriftVel;
 
+    m_driftMap = DriftMap::GetInstance();
+
+    // Pick the version of the calculation for the drift axis.
+    int driftAxis;
+    util::GetDriftAxisOptions(driftAxis, m_driftDirection);
+    switch (driftAxis) {
+    case 0:  m_calculate = &DiffusionModel::m_Calculate<0>; break;
+    case 1:  m_calculate = &DiffusionModel::m_Calculate<1>; break;
+    default: m_calculate = &DiffusionModel::m_Calculate<2>; break;
+    }
+
+    // Unless told otherwise, use ROOT's global random-number generator.
+    m_random = gRandom;
+
     if (m_verbose || m_debug) {
       std::cout << "gramsdetsim::DiffusionModel - "
 		<< "LongitudinalDiffusion= " << m_LongitudinalDiffusion
@@ -66,22 +86,47 @@ namespace gramsdetsim {
   // in the calling routine. That's to keep the clusterID increasing
   // over all the hits in the events.
   
-  std::vector< grams::ElectronCluster > 
-      DiffusionModel::Calculate(double a_energy, 
-				const grams::MCLArHit& a_hit,
-				int& a_clusterID ) {
-
-    // Note that we're drifting along the z-axis, so the cluster
-    // positions on the 1 and 2 axes (the x and y axes) are diffused
-    // using "transverse" rules, while the cluster position on the
-    // z-axis is drifting with "longitudinal" diffusion. For other
-    // detector setups or coordinate systems, the following code must
-    // be adjusted.
-
-    double z_mean = 0.5 * (a_hit.StartZ() + a_hit.EndZ());
-
-    double DriftDistance = m_readout_plane_coord - z_mean;
-    double mean_TDrift = std::abs(DriftDistance * m_RecipDriftVel);
+  void DiffusionModel::Calculate(double a_energy, 
+				 const grams::MCLArHit& a_hit,
+				 int& a_clusterID,
+				 std::vector< grams::ElectronCluster >& a_clusters ) {
+    (this->*m_calculate)(a_energy, a_hit, a_clusterID, a_clusters);
+  }
+
+  template <int Axis>
+  void DiffusionModel::m_Calculate(double a_energy, 
+				   const grams::MCLArHit& a_hit,
+				   int& a_clusterID,
+				   std::vector< grams::ElectronCluster >& a_clusters ) {
+
+    // The cluster positions across the drift axis (x and y, for a
+    // drift along z) are diffused using "transverse" rules, while
+    // the cluster position along the drift axis is drifting with
+    // "longitudinal" diffusion. The names below are those of the
+    // default drift along z; see DriftAxis.h for the others.
+    using Drift = util::DriftAxis<Axis>;
+
+    double z_mean = 0.5 * (Drift::Along(a_hit.start) + Drift::Along(a_hit.end));
+    double averagetransversePos1  = 0.5 * (Drift::Across1(a_hit.start) + Drift::Across1(a_hit.end));
+    double averagetransversePos2  = 0.5 * (Drift::Across2(a_hit.start) + Drift::Across2(a_hit.end));
+
+    // With a drift map, look up the drift velocity and the
+    // displacement once for the hit, since all of its clusters start
+    // from the same point. The displacement moves the center of the
+    // transverse diffusion.
+    double recipDriftVel = m_RecipDriftVel;
+    if ( m_driftMap != nullptr ) {
+      double dispX, dispY;
+      m_driftMap->Lookup( 0.5 * (a_hit.StartX() + a_hit.EndX()),
+			  0.5 * (a_hit.StartY() + a_hit.EndY()),
+			  0.5 * (a_hit.StartZ() + a_hit.EndZ()),
+			  recipDriftVel, dispX, dispY );
+      averagetransversePos1 += dispX;
+      averagetransversePos2 += dispY;
+    }
+
+    double DriftDistance = m_driftDirection * (m_readout_plane_coord - z_mean);
+    double mean_TDrift = std::abs(DriftDistance * recipDriftVel);
     double SqrtT = std::sqrt(mean_TDrift);
   
     double fLDiff_const = std::sqrt(2. * m_LongitudinalDiffusion);
@@ -144,17 +189,27 @@ namespace gramsdetsim {
 		<< std::endl;
     }
 
-    // The vector of electron clusters that will be returned by this
-    // model.
-    std::vector< grams::ElectronCluster > vecCluster(nClus);
+    // The new clusters go at the end of the caller's vector. If the
+    // caller re-uses the vector from hit to hit and event to event,
+    // this eventually stops allocating memory.
+    const std::size_t firstCluster = a_clusters.size();
+    a_clusters.resize( firstCluster + nClus );
 
-    double averagetransversePos1  = 0.5 * (a_hit.StartX() + a_hit.EndX());
-    double averagetransversePos2  = 0.5 * (a_hit.StartY() + a_hit.EndY());
     double averagelongitudinalPos = z_mean;
 
-    // For each cluster:
-    int clusterCount = 0;
-    for ( auto& cluster : vecCluster ) {
+    // Generate all the Gaussian offsets for this hit's clusters at
+    // once: nClus each for x, y, and z. This is much faster than
+    // calling m_random->Gaus() three times per cluster.
+    const bool transverse = ( TDiffSig > 0.0 );
+    const bool longitudinal = ( LDiffSig > 0.0 );
+    const std::size_t nOffsets = std::size_t(nClus) * ( (transverse ? 2 : 0) + (longitudinal ? 1 : 0) );
+    m_offsets.resize( nOffsets );
+    util::GausArray( m_random, nOffsets, m_offsets.data() );
+    const double* offset = m_offsets.data();
+
+    // For each new cluster:
+    for ( std::size_t c = firstCluster; c != a_clusters.size(); ++c ) {
+      auto& cluster = a_clusters[c];
       cluster.trackID = a_hit.trackID;
       cluster.hitID = a_hit.hitID;
       // An arbitrary assignment of cluster ID, incremented across all
@@ -166,8 +221,7 @@ namespace gramsdetsim {
       // cluster is the same (electronclsize). However, the last
       // cluster will contain the "leftover" electrons after dividing
       // the total number of electrons by the electron-cluster size.
-      clusterCount++;
-      if ( clusterCount == vecCluster.size() )
+      if ( c + 1 == a_clusters.size() )
 	cluster.numElectrons = nElectrons - (nClus - 1) * electronclsize;
 
       if (nElectrons > 0)
@@ -178,9 +232,9 @@ namespace gramsdetsim {
       double xDiff, yDiff, zDiff, tDiff;
 
       // Transverse diffusion of the electron clusters.
-      if (TDiffSig > 0.0) {
-	xDiff = gRandom->Gaus(averagetransversePos1, TDiffSig);
-	yDiff = gRandom->Gaus(averagetransversePos2, TDiffSig);
+      if (transverse) {
+	xDiff = averagetransversePos1 + TDiffSig * (*offset++);
+	yDiff = averagetransversePos2 + TDiffSig * (*offset++);
       }
       else {
 	xDiff = averagetransversePos1;
@@ -188,24 +242,19 @@ namespace gramsdetsim {
       }
 
       // Longitudinal diffusion of the electron clusters. 
-      if (LDiffSig > 0.0) {
-	double sample_sigL = gRandom->Gaus(0.0,  LDiffSig);
-	tDiff = (DriftDistance + sample_sigL) * m_RecipDriftVel;
+      if (longitudinal) {
+	double sample_sigL = LDiffSig * (*offset++);
+	tDiff = (DriftDistance + sample_sigL) * recipDriftVel;
 	zDiff  = averagelongitudinalPos + sample_sigL;
       }   
       else {
 	zDiff = DriftDistance;
-	tDiff = DriftDistance * m_RecipDriftVel;
+	tDiff = DriftDistance * recipDriftVel;
       }
 
-      cluster.position 
-	= ROOT::Math::XYZTVector( xDiff, yDiff, zDiff, tDiff );
+      cluster.position = Drift::Position( zDiff, xDiff, yDiff, tDiff );
 
     } // for each cluster
-
-    // Return the vector containing the per-cluster values (units
-    // defined in the options XML file):
-    return vecCluster;
   }
 
 } // namespace gramsdetsim
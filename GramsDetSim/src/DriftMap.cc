@@ -0,0 +1,243 @@
+// 16-Oct-2026
+// Read a drift map and interpolate within it.
+
+#include "DriftMap.h"
+
+// For processing command-line and XML file options.
+#include "Options.h" // in util/
+
+// ROOT includes
+#include "TFile.h"
+#include "TH3.h"
+#include "TAxis.h"
+
+// C++ includes
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gramsdetsim {
+
+  const DriftMap* DriftMap::GetInstance()
+  {
+    // A function-level static is initialized only once, even if
+    // several threads get here at the same time.
+    static const std::unique_ptr<DriftMap> instance = []() {
+      std::string fileName;
+      util::Options::GetInstance()->GetOption("DriftMapFile", fileName);
+      if ( fileName.empty() )
+	return std::unique_ptr<DriftMap>();
+      return std::unique_ptr<DriftMap>( new DriftMap(fileName) );
+    }();
+    return instance.get();
+  }
+
+  DriftMap::DriftMap(const std::string& a_fileName)
+  {
+    util::Options::GetInstance()->GetOption("verbose",m_verbose);
+
+    const std::string extension = ".root";
+    if ( a_fileName.size() > extension.size()
+	 &&  a_fileName.compare( a_fileName.size() - extension.size(), extension.size(), extension ) == 0 )
+      m_ReadROOT(a_fileName);
+    else
+      m_ReadBinary(a_fileName);
+
+    m_Finish(a_fileName);
+  }
+
+  // A ROOT file contains three TH3 histograms with the same
+  // equal-width binning: "DriftVelocity", "DisplacementX", and
+  // "DisplacementY". The grid points are the bin centers.
+  void DriftMap::m_ReadROOT(const std::string& a_fileName)
+  {
+    auto file = std::unique_ptr<TFile>( TFile::Open(a_fileName.c_str()) );
+    if ( !file  ||  file->IsZombie() ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramsdetsim::DriftMap: Could not open file '" << a_fileName << "'"
+		<< std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    const char* names[3] = { "DriftVelocity", "DisplacementX", "DisplacementY" };
+    TH3* histograms[3];
+    for ( int h = 0; h != 3; ++h ) {
+      histograms[h] = file->Get<TH3>(names[h]);
+      if ( histograms[h] == nullptr ) {
+	std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		  << "gramsdetsim::DriftMap: Could not find TH3 '" << names[h]
+		  << "' in file '" << a_fileName << "'"
+		  << std::endl;
+	exit(EXIT_FAILURE);
+      }
+    }
+
+    // The grid points are found from the number of bins and the
+    // limits of each axis, which only works if the bins are all the
+    // same width. All three histograms must have the same grid.
+    const char* axisNames[3] = { "x", "y", "z" };
+    const TAxis* axes[3] = { histograms[0]->GetXaxis(),
+			     histograms[0]->GetYaxis(),
+			     histograms[0]->GetZaxis() };
+    for ( int h = 0; h != 3; ++h ) {
+      const TAxis* other[3] = { histograms[h]->GetXaxis(),
+				histograms[h]->GetYaxis(),
+				histograms[h]->GetZaxis() };
+      for ( int a = 0; a != 3; ++a ) {
+	if ( other[a]->GetXbins()->GetSize() != 0 ) {
+	  std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		    << "gramsdetsim::DriftMap: the " << axisNames[a] << " axis of TH3 '"
+		    << names[h] << "' in file '" << a_fileName
+		    << "' has variable-width bins; the map needs equal-width bins"
+		    << std::endl;
+	  exit(EXIT_FAILURE);
+	}
+
+	const double tolerance = 1.e-9 * ( std::abs(axes[a]->GetXmin()) + std::abs(axes[a]->GetXmax()) );
+	if ( other[a]->GetNbins() != axes[a]->GetNbins()
+	     ||  std::abs( other[a]->GetXmin() - axes[a]->GetXmin() ) > tolerance
+	     ||  std::abs( other[a]->GetXmax() - axes[a]->GetXmax() ) > tolerance ) {
+	  std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		    << "gramsdetsim::DriftMap: TH3 '" << names[h]
+		    << "' does not have the same " << axisNames[a] << " bins as '" << names[0]
+		    << "' in file '" << a_fileName << "'"
+		    << std::endl;
+	  exit(EXIT_FAILURE);
+	}
+      }
+    }
+
+    for ( int a = 0; a != 3; ++a ) {
+      m_n[a] = axes[a]->GetNbins();
+      m_step[a] = ( axes[a]->GetXmax() - axes[a]->GetXmin() ) / m_n[a];
+      m_min[a] = axes[a]->GetXmin() + 0.5 * m_step[a];
+    }
+
+    m_nodes.resize( m_n[0] * m_n[1] * m_n[2] );
+    std::size_t index = 0;
+    for ( std::size_t ix = 0; ix != m_n[0]; ++ix )
+      for ( std::size_t iy = 0; iy != m_n[1]; ++iy )
+	for ( std::size_t iz = 0; iz != m_n[2]; ++iz ) {
+	  auto& node = m_nodes[index++];
+	  // Remember that ROOT's bin numbers start at 1.
+	  node.recipDriftVel = histograms[0]->GetBinContent( ix+1, iy+1, iz+1 );
+	  node.dispX         = histograms[1]->GetBinContent( ix+1, iy+1, iz+1 );
+	  node.dispY         = histograms[2]->GetBinContent( ix+1, iy+1, iz+1 );
+	  node.unused        = 0.;
+	}
+
+    file->Close();
+  }
+
+  // A binary file is:
+  //   8 bytes:  the characters "GRAMSDM1"
+  //   3 int32:  the number of grid points along x, y, and z
+  //   6 double: xmin, xmax, ymin, ymax, zmin, zmax; the positions of
+  //             the first and last grid points along each axis
+  //   for each grid point, with z varying fastest, then y, then x:
+  //     3 float: drift velocity, x displacement, y displacement
+  // with the byte order of the computer that reads the file.
+  void DriftMap::m_ReadBinary(const std::string& a_fileName)
+  {
+    std::ifstream file( a_fileName, std::ios::binary );
+    if ( ! file ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramsdetsim::DriftMap: Could not open file '" << a_fileName << "'"
+		<< std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    char magic[8];
+    int32_t n[3];
+    double limits[6];
+    file.read( magic, sizeof(magic) );
+    file.read( reinterpret_cast<char*>(n), sizeof(n) );
+    file.read( reinterpret_cast<char*>(limits), sizeof(limits) );
+    if ( ! file  ||  std::memcmp( magic, "GRAMSDM1", sizeof(magic) ) != 0 ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramsdetsim::DriftMap: '" << a_fileName
+		<< "' is not a drift-map file"
+		<< std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    for ( int a = 0; a != 3; ++a ) {
+      m_n[a] = ( n[a] > 0 ) ? std::size_t(n[a]) : 0;
+      m_min[a] = limits[2*a];
+      m_step[a] = ( m_n[a] > 1 ) ? ( limits[2*a+1] - limits[2*a] ) / double(m_n[a] - 1) : 0.;
+    }
+
+    const std::size_t size = m_n[0] * m_n[1] * m_n[2];
+    std::vector<float> values( 3 * size );
+    file.read( reinterpret_cast<char*>(values.data()), values.size() * sizeof(float) );
+    if ( ! file ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramsdetsim::DriftMap: '" << a_fileName
+		<< "' is shorter than its header says"
+		<< std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    m_nodes.resize( size );
+    for ( std::size_t i = 0; i != size; ++i )
+      m_nodes[i] = { values[3*i], values[3*i+1], values[3*i+2], 0.f };
+  }
+
+  void DriftMap::m_Finish(const std::string& a_fileName)
+  {
+    // Trilinear interpolation needs at least two points along each
+    // axis.
+    for ( int a = 0; a != 3; ++a ) {
+      if ( m_n[a] < 2  ||  !( m_step[a] > 0. ) ) {
+	std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		  << "gramsdetsim::DriftMap: the map in '" << a_fileName
+		  << "' needs at least two evenly-spaced points along each axis"
+		  << std::endl;
+	exit(EXIT_FAILURE);
+      }
+      m_recipStep[a] = 1.0 / m_step[a];
+      m_last[a] = double(m_n[a] - 1);
+    }
+    m_strideY = m_n[2];
+    m_strideX = m_n[1] * m_n[2];
+
+    // The files contain the drift velocity; the models want its
+    // reciprocal.
+    for ( auto& node : m_nodes ) {
+      if ( !( node.recipDriftVel > 0.f ) ) {
+	std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		  << "gramsdetsim::DriftMap: the map in '" << a_fileName
+		  << "' contains a drift velocity that's not positive"
+		  << std::endl;
+	exit(EXIT_FAILURE);
+      }
+      node.recipDriftVel = 1.0f / node.recipDriftVel;
+    }
+
+    if (m_verbose) {
+      std::cout << "gramsdetsim::DriftMap - read '" << a_fileName << "': "
+		<< m_n[0] << "x" << m_n[1] << "x" << m_n[2] << " points"
+		<< " starting at (" << m_min[0] << "," << m_min[1] << "," << m_min[2] << ")"
+		<< " with spacing (" << m_step[0] << "," << m_step[1] << "," << m_step[2] << ")"
+		<< std::endl;
+    }
+  }
+
+  void DriftMap::RecipDriftVel(std::size_t a_n,
+			       const double* a_x, const double* a_y, const double* a_z,
+			       double* a_recipDriftVel) const
+  {
+    for ( std::size_t i = 0; i < a_n; ++i ) {
+      std::size_t index;
+      double wx, wy, wz;
+      m_Locate( a_x[i], a_y[i], a_z[i], index, wx, wy, wz );
+      a_recipDriftVel[i] = m_Interpolate( &Node::recipDriftVel, index, wx, wy, wz );
+    }
+  }
+
+} // namespace gramsdetsim
@@ -0,0 +1,65 @@
+// 16-Oct-2026
+// Copy the hits of an event into a structure of arrays.
+
+#include "HitBatch.h"
+
+// From GramsDataObj
+#include "MCLArHits.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace gramsdetsim {
+
+  void HitBatch::Fill(const grams::FlatMCLArHits& a_hits)
+  {
+    const std::size_t n = a_hits.size();
+
+    // std::vector::resize only allocates memory if the new size is
+    // larger than the capacity.
+    startX.resize(n);
+    startY.resize(n);
+    startZ.resize(n);
+    endX.resize(n);
+    endY.resize(n);
+    endZ.resize(n);
+    energy.resize(n);
+
+    std::size_t i = 0;
+    for ( const auto& [ key, hit ] : a_hits ) {
+      startX[i] = hit.StartX();
+      startY[i] = hit.StartY();
+      startZ[i] = hit.StartZ();
+      endX[i]   = hit.EndX();
+      endY[i]   = hit.EndY();
+      endZ[i]   = hit.EndZ();
+      energy[i] = hit.energy;
+      ++i;
+    }
+  }
+
+  void HitBatch::Fill(const std::vector< const grams::MCLArHit* >& a_hits)
+  {
+    const std::size_t n = a_hits.size();
+
+    startX.resize(n);
+    startY.resize(n);
+    startZ.resize(n);
+    endX.resize(n);
+    endY.resize(n);
+    endZ.resize(n);
+    energy.resize(n);
+
+    for ( std::size_t i = 0; i != n; ++i ) {
+      const auto& hit = *a_hits[i];
+      startX[i] = hit.StartX();
+      startY[i] = hit.StartY();
+      startZ[i] = hit.StartZ();
+      endX[i]   = hit.EndX();
+      endY[i]   = hit.EndY();
+      endZ[i]   = hit.EndZ();
+      energy[i] = hit.energy;
+    }
+  }
+
+} // namespace gramsdetsim
@@ -0,0 +1,172 @@
+// 16-Oct-2026
+// Select the LAr hits to send through the detector-response models.
+
+#include "HitFilter.h"
+
+// For processing command-line and XML file options.
+#include "Options.h" // in util/
+
+// From GramsDataObj
+#include "MCLArHits.h"
+
+// ROOT includes
+#include "TGeoManager.h"
+#include "TGeoNode.h"
+#include "TGeoVolume.h"
+#include "TGeoShape.h"
+#include "TGeoMatrix.h"
+#include "TString.h"
+#include "TRegexp.h"
+
+// C++ includes
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+namespace gramsdetsim {
+
+  namespace {
+
+    // The fiducial volume is found in the geometry only once, no
+    // matter how many filters there are (e.g., one per thread).
+    struct FiducialVolume {
+      const TGeoShape* shape = nullptr;
+      TGeoHMatrix matrix;
+    };
+
+    const FiducialVolume& GetFiducialVolume(const std::string& a_gdml,
+					    const std::string& a_volume)
+    {
+      static const FiducialVolume fiducial = [&]() {
+	FiducialVolume result;
+
+	auto geom = TGeoManager::Import(a_gdml.c_str());
+	if ( geom == nullptr ) {
+	  std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		    << "gramsdetsim::HitFilter: Could not read geometry from '"
+		    << a_gdml << "'"
+		    << std::endl;
+	  exit(EXIT_FAILURE);
+	}
+
+	// As in GramsReadoutSim, look for the first node whose path
+	// matches the volume name.
+	TRegexp searchFor( a_volume.c_str() );
+	TGeoIterator next( geom->GetTopVolume() );
+	TGeoNode* current;
+	TString nodePath;
+	while ( (current = next()) ) {
+	  next.GetPath(nodePath);
+	  if ( nodePath.Contains(searchFor) ) {
+	    result.shape = current->GetVolume()->GetShape();
+	    // The transformation from the top volume to this node.
+	    result.matrix = *next.GetCurrentMatrix();
+	    break;
+	  }
+	}
+
+	if ( result.shape == nullptr ) {
+	  std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		    << "gramsdetsim::HitFilter: Could not find volume '" << a_volume
+		    << "' in '" << a_gdml << "'. Check the fiducialVolume option"
+		    << std::endl;
+	  exit(EXIT_FAILURE);
+	}
+	return result;
+      }();
+      return fiducial;
+    }
+
+  } // anonymous namespace
+
+  HitFilter::HitFilter()
+    : m_fiducialShape(nullptr)
+    , m_fiducialMatrix(nullptr)
+  {
+    auto options = util::Options::GetInstance();
+
+    bool verbose;
+    options->GetOption("verbose",verbose);
+
+    options->GetOption("filterMinEnergy", m_minEnergy);
+
+    // The volume IDs can be separated by commas or spaces.
+    std::string volumeIDs;
+    options->GetOption("filterVolumeIDs", volumeIDs);
+    std::replace( volumeIDs.begin(), volumeIDs.end(), ',', ' ' );
+    std::istringstream stream( volumeIDs );
+    std::string token;
+    while ( stream >> token ) {
+      char* end;
+      const long id = std::strtol( token.c_str(), &end, 10 );
+      if ( *end != '\0' ) {
+	std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		  << "gramsdetsim::HitFilter: '" << token
+		  << "' in filterVolumeIDs is not a volume ID"
+		  << std::endl;
+	exit(EXIT_FAILURE);
+      }
+      m_volumeIDs.push_back( int(id) );
+    }
+    std::sort( m_volumeIDs.begin(), m_volumeIDs.end() );
+
+    std::string fiducialVolume;
+    options->GetOption("fiducialVolume", fiducialVolume);
+    options->GetOption("fiducialMargin", m_fiducialMargin);
+    if ( ! fiducialVolume.empty() ) {
+      std::string gdml;
+      options->GetOption("fiducialGDML", gdml);
+      const auto& fiducial = GetFiducialVolume( gdml, fiducialVolume );
+      m_fiducialShape = fiducial.shape;
+      m_fiducialMatrix = &fiducial.matrix;
+    }
+
+    m_active = ( m_minEnergy > 0.  ||  ! m_volumeIDs.empty()  ||  m_fiducialShape != nullptr );
+
+    if (verbose) {
+      std::cout << "gramsdetsim::HitFilter - "
+		<< "filterMinEnergy=" << m_minEnergy
+		<< " filterVolumeIDs=";
+      for ( const auto id : m_volumeIDs )
+	std::cout << id << " ";
+      std::cout << "fiducialVolume='" << fiducialVolume << "'"
+		<< " fiducialMargin=" << m_fiducialMargin
+		<< std::endl;
+    }
+  }
+
+  bool HitFilter::m_AllowedVolume(int a_volumeID) const
+  {
+    return std::binary_search( m_volumeIDs.cbegin(), m_volumeIDs.cend(), a_volumeID );
+  }
+
+  bool HitFilter::m_InFiducialVolume(const grams::MCLArHit& a_hit) const
+  {
+    const double master[3] = { 0.5 * ( a_hit.StartX() + a_hit.EndX() ),
+			       0.5 * ( a_hit.StartY() + a_hit.EndY() ),
+			       0.5 * ( a_hit.StartZ() + a_hit.EndZ() ) };
+    double local[3];
+    m_fiducialMatrix->MasterToLocal( master, local );
+
+    if ( ! m_fiducialShape->Contains( local ) )
+      return false;
+
+    // Safety() is the distance to the nearest surface.
+    return ( m_fiducialMargin <= 0.  ||  m_fiducialShape->Safety( local, true ) >= m_fiducialMargin );
+  }
+
+} // namespace gramsdetsim
+
+std::ostream& operator<<(std::ostream& a_out, const gramsdetsim::HitFilter::Counts& a_counts)
+{
+  const std::size_t dropped = a_counts.energy + a_counts.volume + a_counts.fiducial;
+  a_out << "gramsdetsim: " << a_counts.total << " hits, "
+	<< dropped << " dropped ("
+	<< a_counts.energy << " below filterMinEnergy, "
+	<< a_counts.volume << " not in filterVolumeIDs, "
+	<< a_counts.fiducial << " outside fiducialVolume)";
+  return a_out;
+}
@@ -0,0 +1,184 @@
+// 16-Oct-2026
+// Create the detector-response models for each set of parameters in
+// a scan.
+
+#include "ParameterScan.h"
+#include "DetectorResponse.h"
+
+// For processing command-line and XML file options.
+#include "Options.h" // in util/
+
+// ROOT includes
+#include "TRandom.h"
+
+// C++ includes
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <cctype>
+#include <cstdlib>
+
+namespace gramsdetsim {
+
+  // The options that the models read when they're created, so they
+  // can differ from one setting to the next. The others are read
+  // once per job (e.g., DriftMapFile, fiducialVolume, the readout
+  // geometry), or must be the same for the whole job and the
+  // programs that follow it (e.g., nthreads, timebin_width,
+  // diffusion, AnalyticDiffusion); a scan that changes them is an
+  // error.
+  static const std::set<std::string> scannableOptions = {
+    "recombination", "RecombinationModel", "RecombinationTable", "RecombinationTableTolerance",
+    "ElectricField", "LArDensity", "box_alpha", "box_beta", "birks_AB", "birks_kB",
+    "absorption", "ElectronLifeTimeCorr", "ElectronDriftVelocity", "MeVToElectrons",
+    "LongitudinalDiffusion", "TransverseDiffusion", "ElectronClusterSize", "MinNumberOfElCluster",
+    "filterMinEnergy", "filterVolumeIDs", "fiducialMargin"
+  };
+
+  ParameterScan::ParameterScan()
+  {
+    auto options = util::Options::GetInstance();
+
+    bool verbose;
+    options->GetOption("verbose",verbose);
+
+    // The nominal setting changes nothing.
+    m_settings.emplace_back();
+
+    std::string fileName;
+    options->GetOption("parameterScan", fileName);
+    if ( fileName.empty() )
+      return;
+
+    std::ifstream file( fileName );
+    if ( ! file ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramsdetsim::ParameterScan: Could not open file '" << fileName << "'"
+		<< std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    std::set<std::string> tags;
+    std::set<std::string> changed;
+    std::string line;
+    int lineNumber = 0;
+    while ( std::getline( file, line ) ) {
+      ++lineNumber;
+      line = line.substr( 0, line.find('#') );
+      std::istringstream stream( line );
+
+      Setting setting;
+      if ( ! ( stream >> setting.tag ) )
+	continue; // blank line
+
+      // The tag becomes part of a tree name, so keep it simple.
+      bool validTag = tags.insert( setting.tag ).second;
+      for ( const unsigned char c : setting.tag )
+	if ( ! std::isalnum(c)  &&  c != '_' ) validTag = false;
+      if ( ! validTag ) {
+	std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		  << "gramsdetsim::ParameterScan: '" << fileName << "' line " << lineNumber
+		  << ": the tag '" << setting.tag
+		  << "' is repeated or contains characters other than letters, digits, and '_'"
+		  << std::endl;
+	exit(EXIT_FAILURE);
+      }
+
+      std::string change;
+      while ( stream >> change ) {
+	const auto equals = change.find('=');
+	if ( equals == std::string::npos  ||  equals == 0 ) {
+	  std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		    << "gramsdetsim::ParameterScan: '" << fileName << "' line " << lineNumber
+		    << ": '" << change << "' is not of the form option=value"
+		    << std::endl;
+	  exit(EXIT_FAILURE);
+	}
+	const auto name = change.substr(0, equals);
+	if ( scannableOptions.count(name) == 0 ) {
+	  std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		    << "gramsdetsim::ParameterScan: '" << fileName << "' line " << lineNumber
+		    << ": the option '" << name << "' can't be scanned; "
+		    << "see 'Parameter scans' in GramsDetSim/README.md"
+		    << std::endl;
+	  exit(EXIT_FAILURE);
+	}
+	setting.changes.emplace_back( name, change.substr(equals + 1) );
+	changed.insert( name );
+      }
+
+      m_settings.push_back( setting );
+    }
+
+    // Save the job's values of the options that will be changed, so
+    // they can be put back after each setting's models are created.
+    for ( std::size_t i = 0; i != options->NumberOfOptions(); ++i ) {
+      const auto name = options->GetOptionName(i);
+      if ( changed.count(name) != 0 )
+	m_nominal.emplace_back( name, options->GetOptionValue(i) );
+    }
+
+    // Check that every change can be made.
+    for ( std::size_t s = 1; s != m_settings.size(); ++s ) {
+      for ( const auto& [ name, value ] : m_settings[s].changes ) {
+	if ( ! options->SetOption( name, value ) ) {
+	  std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		    << "gramsdetsim::ParameterScan: in '" << fileName
+		    << "', setting '" << m_settings[s].tag << "': "
+		    << "there's no option '" << name
+		    << "', or it can't have the value '" << value << "'"
+		    << std::endl;
+	  exit(EXIT_FAILURE);
+	}
+      }
+      m_Restore();
+    }
+
+    if (verbose) {
+      std::cout << "gramsdetsim::ParameterScan - " << m_settings.size() - 1
+		<< " settings read from '" << fileName << "'" << std::endl;
+      for ( std::size_t s = 1; s != m_settings.size(); ++s )
+	std::cout << "   " << m_settings[s].tag << ": " << Description(s) << std::endl;
+    }
+  }
+
+  std::string ParameterScan::Description(std::size_t a_i) const
+  {
+    std::string result;
+    for ( const auto& [ name, value ] : m_settings[a_i].changes ) {
+      if ( ! result.empty() ) result += " ";
+      result += name + "=" + value;
+    }
+    return result;
+  }
+
+  void ParameterScan::m_Apply(const Setting& a_setting) const
+  {
+    auto options = util::Options::GetInstance();
+    for ( const auto& [ name, value ] : a_setting.changes )
+      options->SetOption( name, value );
+  }
+
+  void ParameterScan::m_Restore() const
+  {
+    auto options = util::Options::GetInstance();
+    for ( const auto& [ name, value ] : m_nominal )
+      options->SetOption( name, value );
+  }
+
+  std::unique_ptr<DetectorResponse> ParameterScan::MakeResponse(std::size_t a_i,
+								TRandom* a_random) const
+  {
+    // The models read their options when they're created, so the
+    // options only have to be changed while that happens.
+    m_Apply( m_settings[a_i] );
+    auto response = std::make_unique<DetectorResponse>( a_random );
+    m_Restore();
+    return response;
+  }
+
+} // namespace gramsdetsim
@@ -13,6 +13,31 @@
 #include <iostream>
 #include <cmath>
 #include <numeric>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+  // Reinterpret a double as its IEEE bits, and back again. For
+  // positive numbers, the bits increase as the number does.
+  inline uint64_t DoubleBits(double a_value)
+  {
+    uint64_t bits;
+    std::memcpy(&bits, &a_value, sizeof(bits));
+    return bits;
+  }
+  inline double BitsDouble(uint64_t a_bits)
+  {
+    double value;
+    std::memcpy(&value, &a_bits, sizeof(value));
+    return value;
+  }
+
+} // anonymous namespace
 
 namespace gramsdetsim {
 
@@ -36,6 +61,9 @@ namespace gramsdetsim {
     options->GetOption("birks_AB", m_A_B);
     options->GetOption("birks_kB", m_kB);
 
+    options->GetOption("RecombinationTable", m_useTable);
+    options->GetOption("RecombinationTableTolerance", m_tableTolerance);
+
     if (m_verbose) {
       std::cout << "gramsdetsim::RecombinationModel - "
 		<< "field= " << m_field
@@ -43,6 +71,30 @@ namespace gramsdetsim {
 		<< " b= " << m_beta
 		<< " rho= " << m_rho << std::endl;
     }
+
+    // Select the batch calculation for this model.
+    switch (m_recom_model) {
+    case 0 :
+      m_batchCalculate = &RecombinationModel::m_BoxCalculate;
+      m_minEffect = 1.0e-6;
+      break;
+    case 1 :
+      m_batchCalculate = &RecombinationModel::m_BirksCalculate;
+      m_minEffect = std::numeric_limits<double>::lowest();
+      break;
+    default :
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramsdetsim::RecombinationModel: Invalid value " << m_recom_model 
+		<< " for recombination_model"
+		<< std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    // If the user asked for it, replace the formula with a table.
+    if ( m_useTable ) {
+      m_BuildTable();
+      m_batchCalculate = &RecombinationModel::m_TableCalculate;
+    }
   }
 
   // Note that the "a_" prefix is a convention to remind us that the
@@ -80,6 +132,16 @@ namespace gramsdetsim {
     if ( std::isnan(dEdx) ) 
       return (0.0);
 
+    // The tabulated version of either model.
+    if ( m_useTable ) {
+      const double effect = m_TableEffect( dEdx / (m_field * m_rho) );
+      if (m_debug)
+	std::cout << "gramsdetsim::RecombinationModel - "
+		  << "dEdx= " << dEdx
+		  << " effect from table= " << effect << std::endl;
+      return a_energy * effect;
+    }
+
     // The following calculations are based off of the modified box
     // model used in the ICARUS experiment, with constant values taken
     // from the Brookhaven page on liquid argon TPCs.
@@ -147,4 +209,218 @@ namespace gramsdetsim {
   return a_energy * effect;
 }
 
+  // The batch calculations. These are the same formulas as above,
+  // written as simple loops over arrays with no branches, so that the
+  // compiler can turn them into vector instructions. std::log can't
+  // be vectorized without giving up strict IEEE math, so it's done in
+  // a loop of its own. Each loop writes only one array; otherwise the
+  // compiler gives up on proving that the arrays don't overlap.
+
+  void RecombinationModel::m_BoxCalculate( HitBatch& a_hits ) {
+
+    const std::size_t n = a_hits.size();
+    m_dEdx.resize(n);
+    m_work.resize(n);
+
+    const double* sx = a_hits.startX.data();
+    const double* sy = a_hits.startY.data();
+    const double* sz = a_hits.startZ.data();
+    const double* ex = a_hits.endX.data();
+    const double* ey = a_hits.endY.data();
+    const double* ez = a_hits.endZ.data();
+    double* energy = a_hits.energy.data();
+    double* effective_efield = m_dEdx.data();
+    double* logArg = m_work.data();
+
+    const double alpha = m_alpha;
+    const double beta = m_beta;
+    const double fieldRho = m_field * m_rho;
+
+    for ( std::size_t i = 0; i < n; ++i ) {
+      const double dX = sx[i] - ex[i];
+      const double dY = sy[i] - ey[i];
+      const double dZ = sz[i] - ez[i];
+      const double dx = std::sqrt( dX*dX + dY*dY + dZ*dZ );
+      const double dEdx = energy[i] / dx;
+      effective_efield[i] = (beta * dEdx) / fieldRho;
+    }
+
+    for ( std::size_t i = 0; i < n; ++i )
+      logArg[i] = std::log( alpha + effective_efield[i] );
+
+    for ( std::size_t i = 0; i < n; ++i ) {
+      const double effect = std::max( logArg[i] / effective_efield[i], 1.0e-6 );
+      const double result = energy[i] * effect;
+      energy[i] = std::isnan(result) ? 0.0 : result;
+    }
+  }
+
+  void RecombinationModel::m_BirksCalculate( HitBatch& a_hits ) {
+
+    const std::size_t n = a_hits.size();
+
+    const double* sx = a_hits.startX.data();
+    const double* sy = a_hits.startY.data();
+    const double* sz = a_hits.startZ.data();
+    const double* ex = a_hits.endX.data();
+    const double* ey = a_hits.endY.data();
+    const double* ez = a_hits.endZ.data();
+    double* energy = a_hits.energy.data();
+
+    const double A_B = m_A_B;
+    const double kB = m_kB;
+    const double fieldRho = m_field * m_rho;
+
+    for ( std::size_t i = 0; i < n; ++i ) {
+      const double dX = sx[i] - ex[i];
+      const double dY = sy[i] - ey[i];
+      const double dZ = sz[i] - ez[i];
+      const double dx = std::sqrt( dX*dX + dY*dY + dZ*dZ );
+      const double dEdx = energy[i] / dx;
+      const double effect = A_B / (1 + kB * dEdx / fieldRho);
+      const double result = energy[i] * effect;
+      energy[i] = std::isnan(result) ? 0.0 : result;
+    }
+  }
+
+  // The tabulated correction.
+
+  double RecombinationModel::m_Effect( double a_u ) const {
+    if ( m_recom_model == 0 ) {
+      const double effective_efield = m_beta * a_u;
+      return std::log(m_alpha + effective_efield) / effective_efield;
+    }
+    return m_A_B / (1 + m_kB * a_u);
+  }
+
+  double RecombinationModel::m_TableEffect( double a_u ) const {
+    // This test is also false if u is NaN.
+    if ( !( a_u >= m_tableMin  &&  a_u < m_tableMax ) )
+      return std::max( m_Effect(a_u), m_minEffect );
+
+    const auto& bin = m_table[ (long long)( DoubleBits(a_u) >> m_tableShift ) - m_tableBase ];
+    return std::max( bin.value + bin.slope * (a_u - bin.u), m_minEffect );
+  }
+
+  void RecombinationModel::m_BuildTable() {
+
+    // The range of u in the table, 2^-8 to 2^22. With the default
+    // field and density, that's dE/dx from about 0.003 to 3.0e6
+    // MeV/cm.
+    m_tableMin = std::ldexp(1.0, -8);
+    m_tableMax = std::ldexp(1.0, 22);
+
+    // Start with 16 bins per power of 2, and double that until the
+    // interpolation is good enough. The error is checked at three
+    // points within each bin; the largest difference between the
+    // interpolated and the calculated correction is the error bound
+    // reported below.
+    double maxError = 0.;
+    for ( m_tableBits = 4; m_tableBits <= 12; ++m_tableBits ) {
+      m_tableShift = 52 - m_tableBits;
+      m_tableBase = (long long)( DoubleBits(m_tableMin) >> m_tableShift );
+      const long long size = (long long)( DoubleBits(m_tableMax) >> m_tableShift ) - m_tableBase;
+
+      m_table.resize(size);
+      for ( long long j = 0; j != size; ++j ) {
+	const double lower = BitsDouble( uint64_t(m_tableBase + j) << m_tableShift );
+	const double upper = BitsDouble( uint64_t(m_tableBase + j + 1) << m_tableShift );
+	const double value = m_Effect(lower);
+	m_table[j] = { lower, value, ( m_Effect(upper) - value ) / ( upper - lower ) };
+      }
+
+      maxError = 0.;
+      for ( long long j = 0; j != size; ++j ) {
+	const auto& bin = m_table[j];
+	const double width = BitsDouble( uint64_t(m_tableBase + j + 1) << m_tableShift ) - bin.u;
+	for ( const double fraction : { 0.25, 0.5, 0.75 } ) {
+	  const double u = bin.u + fraction * width;
+	  const double error = std::abs( std::max( bin.value + bin.slope * (u - bin.u), m_minEffect )
+					 - std::max( m_Effect(u), m_minEffect ) );
+	  maxError = std::max( maxError, error );
+	}
+      }
+
+      if ( maxError <= m_tableTolerance )
+	break;
+    }
+
+    if ( maxError > m_tableTolerance ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramsdetsim::RecombinationModel: Could not build a table with "
+		<< "RecombinationTableTolerance=" << m_tableTolerance
+		<< "; the smallest error was " << maxError
+		<< std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    if (m_verbose) {
+      std::cout << "gramsdetsim::RecombinationModel - table of "
+		<< m_table.size() << " bins, "
+		<< (1 << m_tableBits) << " per factor of 2 in dE/dx, "
+		<< "maximum error in the correction= " << maxError
+		<< std::endl;
+    }
+  }
+
+  // The batch calculation with the table. As in the other batch
+  // calculations, each step is a simple loop. The lookup has no
+  // branches: the bin number is clamped to the table, and the few
+  // hits outside the table are recalculated afterwards.
+
+  void RecombinationModel::m_TableCalculate( HitBatch& a_hits ) {
+
+    const std::size_t n = a_hits.size();
+    m_dEdx.resize(n);
+    m_work.resize(n);
+
+    const double* sx = a_hits.startX.data();
+    const double* sy = a_hits.startY.data();
+    const double* sz = a_hits.startZ.data();
+    const double* ex = a_hits.endX.data();
+    const double* ey = a_hits.endY.data();
+    const double* ez = a_hits.endZ.data();
+    double* energy = a_hits.energy.data();
+    double* reduced = m_dEdx.data();
+    double* effect = m_work.data();
+
+    const double fieldRho = m_field * m_rho;
+
+    for ( std::size_t i = 0; i < n; ++i ) {
+      const double dX = sx[i] - ex[i];
+      const double dY = sy[i] - ey[i];
+      const double dZ = sz[i] - ez[i];
+      const double dx = std::sqrt( dX*dX + dY*dY + dZ*dZ );
+      reduced[i] = energy[i] / (dx * fieldRho);
+    }
+
+    const TableBin* table = m_table.data();
+    const long long lastBin = (long long)( m_table.size() ) - 1;
+    const int shift = m_tableShift;
+    const long long base = m_tableBase;
+    const double minEffect = m_minEffect;
+    const double tableMin = m_tableMin;
+    const double tableMax = m_tableMax;
+
+    std::size_t outside = 0;
+    for ( std::size_t i = 0; i < n; ++i ) {
+      const double u = reduced[i];
+      const long long j = std::min( std::max( (long long)( DoubleBits(u) >> shift ) - base, 0LL ), lastBin );
+      const TableBin& bin = table[j];
+      effect[i] = std::max( bin.value + bin.slope * (u - bin.u), minEffect );
+      outside += !( u >= tableMin  &&  u < tableMax );
+    }
+
+    if ( outside > 0 ) {
+      for ( std::size_t i = 0; i < n; ++i )
+	if ( !( reduced[i] >= tableMin  &&  reduced[i] < tableMax ) )
+	  effect[i] = std::max( m_Effect(reduced[i]), minEffect );
+    }
+
+    for ( std::size_t i = 0; i < n; ++i ) {
+      const double result = energy[i] * effect[i];
+      energy[i] = std::isnan(result) ? 0.0 : result;
+    }
+  }
+
 } // namespace gramsdetsim
@@ -11,10 +11,8 @@
 
 // Our function(s) for the electronics response.
 #include "UtilFunctions.h"
-#include "AddNoise.h"
-#include "ADConvert.h"
+#include "ElectronicsResponse.h"
 #include "ElecStructure.h"
-#include "PreampProcessor.h"
 #include "LoadOptionFile.h"
 
 // For processing command-line and XML file options.
@@ -23,19 +21,23 @@
 // For copying and accessing the detectory geometry.
 #include "Geometry.h" // in util/
 
+// For reading and writing either std::map or flat data products.
+#include "ProductIO.h" // in util/
+
 // From GramsDataObj
 #include "EventID.h"
 #include "ElectronClusters.h"
 #include "ReadoutID.h"
 #include "ReadoutMap.h"
+#include "CompactReadoutMap.h"
 #include "ReadoutWaveforms.h"
+#include "CompactReadoutWaveforms.h"
 
 // ROOT includes
 #include "TFile.h"
 #include "TTree.h"
 #include "TTreeReader.h"
 #include "TTreeReaderValue.h"
-#include "TRandom.h"
 
 // C++ includes
 #include <iostream>
@@ -43,6 +45,7 @@
 #include <cmath>
 #include <vector>
 #include <ctime>
+#include <memory>
 
 ///////////////////////////////////////
 
@@ -75,14 +78,6 @@ int main(int argc,char **argv)
     options->PrintOptions();
   }
   
-  // For any model that requires random-number generation, get and set
-  // the random number seed.
-  int seed;
-  options->GetOption("rngseed",seed);
-  // Note that the default random-number generator in ROOT is
-  // TRandom3.
-  gRandom->SetSeed(seed);
-
   // This program reads two trees; or, if you wish, a single tree
   // that's divided into two files, with different columns in each
   // file. 
@@ -146,7 +141,8 @@ int main(int argc,char **argv)
   // Define the trees from the above two files as friends with each
   // other. Note that when these trees were created in GramsDetSim and
   // GramsElecSim, we took care to make sure that each had the same
-  // number of rows, indexed by EventID.
+  // number of rows, indexed by EventID (and by Segment, if
+  // gramsdetsim wrote large events in segments).
   mapTree->AddFriend(clustersTree);
 
   // Define the TTreeReader for this combined tree.
@@ -157,8 +153,21 @@ int main(int argc,char **argv)
   // "EventID" in the combined tree, so specify which one to use.
   std::string eventColumn = inputMapTreeName + ".EventID";
   TTreeReaderValue<grams::EventID> inputEventID      = {*reader, eventColumn.c_str()};
-  TTreeReaderValue<grams::ElectronClusters> clusters = {*reader, "ElectronClusters"};
-  TTreeReaderValue<grams::ReadoutMap> readoutMap     = {*reader, "ReadoutMap"};
+
+  // The clusters and the readout map may each be stored as a
+  // std::map or a flat vector; we see the flat version.
+  util::ProductReader<grams::FlatElectronClusters, grams::ElectronClusters>
+    clusters(*reader, "ElectronClusters");
+  // The readout map may also be in the compressed sparse row form
+  // (see compactReadoutMap in options.xml), which is used as it is.
+  const bool compactMap
+    = util::ColumnHolds<grams::CompactReadoutMap>( reader->GetTree(), "ReadoutMap" );
+  std::unique_ptr< util::ProductReader<grams::FlatReadoutMap, grams::ReadoutMap> > readoutMap;
+  std::unique_ptr< TTreeReaderValue<grams::CompactReadoutMap> > compactReadoutMap;
+  if ( compactMap )
+    compactReadoutMap = std::make_unique< TTreeReaderValue<grams::CompactReadoutMap> >( *reader, "ReadoutMap" );
+  else
+    readoutMap = std::make_unique< util::ProductReader<grams::FlatReadoutMap, grams::ReadoutMap> >( *reader, "ReadoutMap" );
 
   // These functions, defined in GramsElecSim/include/Elecstructure.h,
   // return the ROOT ntuple specification for how to store the options
@@ -205,11 +214,24 @@ int main(int argc,char **argv)
   // the input trees in other analysis programs.
 
   auto eventID = new grams::EventID();
-  auto readoutWaveforms = new grams::ReadoutWaveforms();
   // By experimenting, it turns out that setting the splitlevel to 0
   // improves potential issues with ROOT's TBrowser.
   outputTree->Branch("EventID",          &eventID         , 32000, 0);
-  outputTree->Branch("ReadoutWaveforms", &readoutWaveforms, 32000, 0);
+
+  // The waveforms are collected in the flat format, and converted
+  // before each Fill() if the user wants the std::map format.
+  bool flatDataProducts;
+  options->GetOption("flatDataProducts",flatDataProducts);
+  // If the user asked for them, only the regions of interest of the
+  // waveforms are written (see compactWaveforms in options.xml).
+  bool compact;
+  options->GetOption("compactWaveforms",compact);
+  util::ProductWriter<grams::FlatReadoutWaveforms, grams::ReadoutWaveforms>
+    readoutWaveforms(compact ? nullptr : outputTree, "ReadoutWaveforms", flatDataProducts);
+  grams::CompactReadoutWaveforms compactWaveforms;
+  auto compactWaveformsPointer = &compactWaveforms;
+  if ( compact )
+    outputTree->Branch("ReadoutWaveforms", &compactWaveformsPointer, 32000, 0);
 
   if (debug) {
     std::cout << "gramselecsim main: output tree defined" << std::endl;
@@ -226,30 +248,16 @@ int main(int argc,char **argv)
   // Read in the options for the various electronics-simulation models.
   auto optionloader = gramselecsim::LoadOptionFile::GetInstance();
   optionloader->Load();
-  gramselecsim::general_header    header_gen      = optionloader->GeneralHeader();
-  gramselecsim::preamp_header     header_pre      = optionloader->PreampHeader();
-  gramselecsim::noise_header      header_noise    = optionloader->NoiseHeader();
-  gramselecsim::adc_header        header_adc      = optionloader->ADCHeader();
 
   if (debug) {
     std::cout << "gramselecsim main: ElecStructure options accessed" << std::endl;
   }
 
-  const double sample_freq = header_adc.sample_freq;
-
-  // The number of time bins for the analog waveform. 
-  const int num_tbin = int(header_gen.time_window / header_gen.timebin_width);
-
-  if (verbose) {
-    std::cout << "gramselecsim main: number of analog time bins=" << num_tbin << std::endl;
-  }
-
-  // Algorithms for computing waveforms.  Use make_shared for these
-  // model routines so that we don't have to worry about deleting them
-  // later.
-  auto adconverter = std::make_shared<gramselecsim::ADConvert>();
-  auto addNoise = std::make_shared<gramselecsim::AddNoise>();
-  auto preampProcessor = std::make_shared<gramselecsim::PreampProcessor>(num_tbin);
+  // The electronics models. Any model that requires random-number
+  // generation draws from a stream set by util::RandomService for
+  // each readout cell in each event, using the rngseed option, the
+  // EventID, and the ReadoutID.
+  gramselecsim::ElectronicsResponse electronicsResponse;
 
   if (debug) {
     std::cout << "gramselecsim main: model routines defined" << std::endl;
@@ -262,95 +270,9 @@ int main(int argc,char **argv)
     std::cout << "gramselecsim main: about to process input" << std::endl;
   }
 
-  // For each row in the input tree:
-  while ( (*reader).Next() ) {
-
-    // Copy the event ID from input to output.
-    (*eventID) = (*inputEventID);
-
-    // Clear out any waveform information from the previous event.
-    readoutWaveforms->clear();
-
-    // For each readout cell that received any electron clusters:
-    for ( const auto& [ readoutID, clusterKeys ] : (*readoutMap) ) {
-
-      // We'll create new waveforms for each readout cell.
-      grams::ReadoutWaveform readoutWaveform;
-      readoutWaveform.readoutID = readoutID;
-
-      // For accumulating the electrons arriving within each time bin. 
-      std::vector<int> num_arrival_electrons( num_tbin, 0 );
-
-      // for each electron cluster assigned to this readout cell:
-      for ( const auto& clusterKey: clusterKeys ) {
-
-	// Find the key for this cluster in our list of electron
-	// clusters. (By the way, this is the point at which we're
-	// making use of columns in two different files.)
-	const auto search = clusters->find( clusterKey );
-
-	if ( search == clusters->cend() ) {
-	  // This should not happen. It means that GramsReadoutSim
-	  // inserted a cluster key that was never defined in
-	  // GramsDetSim.
-	  std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
-		    << "gramselecsim: Aborting due to mis-match between:" << std::endl
-		    << "file " << inputClustersFileName << " tree " << inputClustersTreeName
-		    << " and "
-		    << "file " << inputMapFileName << " tree " << inputMapTreeName
-		    << std::endl;
-	  exit(EXIT_FAILURE);
-	}
-
-	// We found the cluster's key in the list of electron
-	// clusters. Fetch that cluster; remember that a map consists
-	// of pairs (first,second).
-	const auto& cluster = (*search).second;
-
-	if (debug) {
-	  std::cout << "gramselecsim main: about to process cluster: " << std::endl
-		    << cluster << std::endl;
-	}
-
-	// The integer time bin in which the cluster arrived.
-	int ti = std::max(0, 
-			  std::min(num_tbin-1, int(std::floor( cluster.TAtAnode() / header_gen.timebin_width)))
-                     );
-
-	// Accumulate the number of electrons to arrive at the cell
-	// within each time bin.
-	num_arrival_electrons[ ti ] += cluster.NumElectrons();
-
-      } // for each cluster within a readout cell
-
-      if (debug) {
-	std::cout << "gramselecsim main: about to compute waveform for "
-		  << "ReadoutID=" << readoutID << std::endl;
-	std::cout << "gramselecsim main: AddNoise..." << std::endl;
-      }
-
-      // Add noise to the number of electrons.
-      const auto num_arrival_electron_with_noise 
-	= addNoise->ProcessElectronNoise( num_arrival_electrons );
-
-      if (debug) {
-	std::cout << "gramselecsim main: PreAmp..." << std::endl;
-      }
-            
-      //Add a response function
-      readoutWaveform.analog = preampProcessor->ConvoluteResponse( num_arrival_electron_with_noise );
-
-      if (debug) {
-	std::cout << "gramselecsim main: ADConvert..." << std::endl;
-      }
-
-      // Convert analog into digital
-      readoutWaveform.digital = adconverter->Process( readoutWaveform.analog );
-
-      // Add the waveforms to our list of readout cells with a signal.
-      readoutWaveforms->insert( std::make_pair( readoutID, readoutWaveform ) );
-
-    } // for each cell with arriving electrons
+  // Compute the waveforms for the event in 'eventID' and write them.
+  auto writeEvent = [&]() {
+    electronicsResponse.Finish( *eventID, *readoutWaveforms );
 
     if (debug) {
       std::cout << "gramselecsim main: Readout waveforms for event " << (*eventID) 
@@ -359,13 +281,47 @@ int main(int argc,char **argv)
 		<< std::endl;
     }
 
+    if ( compact )
+      electronicsResponse.Compact( *readoutWaveforms, compactWaveforms );
+    else
+      readoutWaveforms.Prepare();
     outputTree->Fill();
 
     if (debug) {
       std::cout << "gramselecsim main: Output ntuple filled" << std::endl;
     }
+  };
+
+  // If gramsdetsim divided a large event into segments (see
+  // maxClustersPerSegment in options.xml), the segments are in
+  // consecutive rows with the same EventID. The electrons from all
+  // the rows of an event are collected before its waveforms are
+  // computed, so there's one output row per event either way.
+  bool eventPending = false;
+
+  // For each row in the input tree:
+  while ( (*reader).Next() ) {
+
+    // Is this the first row of a new event?
+    if ( eventPending  &&  !( (*inputEventID) == (*eventID) ) )
+      writeEvent();
+
+    // Copy the event ID from input to output.
+    (*eventID) = (*inputEventID);
+
+    // Add the electrons from the clusters in this row to those
+    // arriving at each readout cell.
+    if ( compactMap )
+      electronicsResponse.Accumulate( *eventID, *clusters, *(*compactReadoutMap) );
+    else
+      electronicsResponse.Accumulate( *eventID, *clusters, *(*readoutMap) );
+    eventPending = true;
+
+  } // for each row
 
-  } // for each event
+  // The last event.
+  if ( eventPending )
+    writeEvent();
 
   if (verbose) {
     time_t t2 = time(NULL);
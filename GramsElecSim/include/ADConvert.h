@@ -8,6 +8,7 @@
 #include "LoadOptionFile.h"
 
 #include <vector>
+#include <utility>
 
 namespace gramselecsim {
 
@@ -16,7 +17,22 @@ namespace gramselecsim {
     public:
 
         ADConvert();
-        std::vector<int> Process(std::vector<double>&);
+        // Neither version changes the object, so one ADConvert can
+        // be used by several threads at once.
+        std::vector<int> Process(std::vector<double>&) const;
+
+        // Convert only the digital bins that overlap the given
+        // [first,last) ranges of analog bins. The analog waveform is
+        // taken to be zero outside them, so the other digital bins
+        // are set to Baseline().
+        std::vector<int> Process(const std::vector<double>& analog,
+                                 const std::vector< std::pair<int,int> >& regions) const;
+
+        // The digital value of an analog waveform of zero.
+        int Baseline() const { return baseline_; }
+
+        // The analog value of one ADC count.
+        double LSB() const { return lsb_; }
 
         virtual ~ADConvert();
 
@@ -26,6 +42,10 @@ namespace gramselecsim {
         adc_header header_adc_;
         int r_adcbin_width_to_origin_width_;
         double lsb_;
+        int baseline_;
+
+        // Compute digital bin i from the analog waveform.
+        int Digitize(const std::vector<double>& analog, int i) const;
 
         bool m_verbose;
         bool m_debug;
@@ -4,6 +4,9 @@
 
 #include "ElecStructure.h"
 
+// ROOT includes
+#include "TRandom.h"
+
 #include <vector>
 
 namespace gramselecsim {
@@ -13,6 +16,12 @@ namespace gramselecsim {
   public:
 
     AddNoise();
+
+    // By default the noise is generated with gRandom. Use this to
+    // supply a different generator. AddNoise does not take ownership
+    // of the generator.
+    void SetRandom(TRandom* a_random) { m_random = a_random; }
+
     std::vector<double> GenSeedNoiseArray(int);
     std::vector<double> ProcessCurrentNoise(const std::vector<double>&);
     std::vector<int> ProcessElectronNoise(const std::vector<int>&);
@@ -26,6 +35,9 @@ namespace gramselecsim {
 
     // Use the central options classes in ElecStructure.
     noise_header m_header;
+
+    // The random-number generator.
+    TRandom* m_random;
   };
 }
 
@@ -0,0 +1,202 @@
+// 16-Oct-2026
+
+// Apply the chain of electronics models (noise, preamp, ADC) to all
+// the readout cells in an event.
+
+// gramselecsim.cc used to do this inside its main loop. It's a class
+// of its own so that other programs (e.g., gramschainsim) can apply
+// the same models to events they hold in memory.
+
+#ifndef ElectronicsResponse_h
+#define ElectronicsResponse_h
+
+#include "AddNoise.h"
+#include "ADConvert.h"
+#include "PreampProcessor.h"
+#include "NoiseLibrary.h"
+
+// Per-event random-number streams.
+#include "RandomService.h" // in util/
+
+// For computing the readout cells of an event in parallel.
+#include "ThreadPool.h" // in util/
+
+// From GramsDataObj
+#include "EventID.h"
+#include "ElectronClusters.h"
+#include "ReadoutMap.h"
+#include "CompactReadoutMap.h"
+#include "ReadoutWaveforms.h"
+#include "CompactReadoutWaveforms.h"
+#include "ReadoutID.h"
+#include "FlatMap.h"
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <cstddef>
+
+namespace gramselecsim {
+
+  class ElectronicsResponse
+  {
+  public:
+
+    // Constructor. Create the models. LoadOptionFile::Load() must
+    // have been called before this.
+    ElectronicsResponse();
+
+    // Compute the waveforms for every readout cell in 'readoutMap',
+    // using the electron clusters it refers to, and fill 'waveforms'
+    // with the result. Any previous contents of 'waveforms' are
+    // discarded. The noise for each cell is drawn from a stream
+    // determined by the event ID and the cell's readout ID.
+    //
+    // If the nthreads option is greater than zero, the readout cells
+    // are divided among that many threads. Each cell's random numbers
+    // depend only on its stream, so the waveforms don't depend on
+    // the number of threads.
+    void Process(const grams::EventID& eventID,
+		 const grams::FlatElectronClusters& clusters,
+		 const grams::FlatReadoutMap& readoutMap,
+		 grams::FlatReadoutWaveforms& waveforms);
+
+    // The same as Process(), for an event whose clusters are divided
+    // into segments (see maxClustersPerSegment in options.xml). Call
+    // Accumulate() for each segment, then Finish() once to compute
+    // the event's waveforms. The electrons that arrive at a readout
+    // cell are summed over all the segments before the noise, preamp,
+    // and ADC models are applied.
+    void Accumulate(const grams::EventID& eventID,
+		    const grams::FlatElectronClusters& clusters,
+		    const grams::FlatReadoutMap& readoutMap);
+    void Finish(const grams::EventID& eventID,
+		grams::FlatReadoutWaveforms& waveforms);
+
+    // The same, for a readout map in the compressed sparse row form
+    // (see GramsDataObj/include/CompactReadoutMap.h). The clusters
+    // are found by their index instead of a search for their keys.
+    void Process(const grams::EventID& eventID,
+		 const grams::FlatElectronClusters& clusters,
+		 const grams::CompactReadoutMap& readoutMap,
+		 grams::FlatReadoutWaveforms& waveforms);
+    void Accumulate(const grams::EventID& eventID,
+		    const grams::FlatElectronClusters& clusters,
+		    const grams::CompactReadoutMap& readoutMap);
+
+    // Keep only the regions of interest of 'waveforms' (see
+    // GramsDataObj/include/CompactReadoutWaveforms.h), using the
+    // ADC's baseline and the compactAnalog option. Analog values
+    // much smaller than one ADC count are treated as zero.
+    void Compact(const grams::FlatReadoutWaveforms& waveforms,
+		 grams::CompactReadoutWaveforms& compactWaveforms) const;
+
+  private:
+
+    // The electrons that arrive at a readout cell: (time bin, number
+    // of electrons) for each cluster, in the order the clusters were
+    // added. A cell that receives a few clusters only needs a few
+    // entries, instead of a histogram with every time bin.
+    typedef std::vector< std::pair<int,int> > Arrivals;
+
+    // Add the electrons of one cluster to the arrivals of its
+    // readout cell.
+    void m_AddCluster(const grams::ElectronCluster& cluster,
+		      Arrivals& arrivals) const;
+
+    // Start (or continue) the arrivals of a readout cell.
+    Arrivals& m_Arrivals(const grams::ReadoutID& readoutID);
+
+    // Set m_cells to the arrivals of each cell in a readout map, in
+    // the map's order, adding any cells that aren't in m_arrivals
+    // yet.
+    template <typename Map>
+    void m_FindCells(const Map& readoutMap);
+
+    // Call func(cell, thread) for each cell in [0,n), in parallel if
+    // there's more than one thread.
+    void m_ForEachCell(std::size_t n,
+		       const std::function<void(std::size_t cell, int thread)>& func);
+
+    // What each thread needs to compute the waveforms of a readout
+    // cell: its own random-number stream and noise model, and work
+    // space. 'electrons' is the number of electrons in every time
+    // bin of one cell; it's returned to all zeros after each cell.
+    struct Worker {
+      Worker(const AddNoise& a_addNoise, int a_numTimeBins)
+	: addNoise(a_addNoise)
+	, electrons(a_numTimeBins, 0)
+      {
+	addNoise.SetRandom( &random );
+      }
+
+      util::RandomStream random;
+      AddNoise addNoise;
+      std::vector<int> electrons;
+      std::vector<int> bins;
+      std::vector<int> counts;
+      std::vector< std::pair<int,int> > regions;
+    };
+
+    // Compute the waveforms of one readout cell, in the full or
+    // sparse way (see sparseWaveforms in options.xml). The worker's
+    // random-number stream must have been set for the cell.
+    // 'noiseOffset' is where the cell's window of m_noiseLibrary
+    // starts.
+    void m_Waveform(Worker& worker, Arrivals& arrivals, std::size_t noiseOffset,
+		    grams::ReadoutWaveform& waveform) const;
+    void m_SparseWaveform(Worker& worker, Arrivals& arrivals, std::size_t noiseOffset,
+			  grams::ReadoutWaveform& waveform) const;
+
+    // The ADC and preamp models don't change as they're used, so all
+    // the threads share them.
+    std::unique_ptr<ADConvert>       m_adconverter;
+    std::unique_ptr<PreampProcessor> m_preampProcessor;
+
+    // The noise with a measured spectrum, if noiseSpectrumFile is
+    // set; otherwise nullptr. Also shared among the threads.
+    std::unique_ptr<NoiseLibrary>    m_noiseLibrary;
+
+    // The window of m_noiseLibrary for the first cell in the current
+    // event (the others follow it), and where the noise shared by
+    // every cell in the event starts in the coherent library.
+    util::RandomStream m_eventRandom;
+    std::size_t m_eventNoiseWindow = 0;
+    std::size_t m_eventNoiseOffset = 0;
+    bool m_warnedNoiseWindows = false;
+
+    // One Worker for each thread, and the threads (if nthreads > 0).
+    std::vector< std::unique_ptr<Worker> > m_workers;
+    std::unique_ptr<util::ThreadPool> m_pool;
+
+    // The number of time bins in the analog waveform, and their
+    // width.
+    int m_numTimeBins;
+    double m_timeBinWidth;
+
+    // Sets the random-number stream of each readout cell.
+    util::RandomService* m_randomService;
+
+    // For accumulating the electrons arriving within each time bin,
+    // for each readout cell in the event.
+    grams::FlatMap< grams::ReadoutID, Arrivals > m_arrivals;
+
+    // The cells of the readout map passed to Accumulate().
+    std::vector< Arrivals* > m_cells;
+
+    // Only compute the waveforms near the arrival times?
+    bool m_sparse = false;
+
+    // For Compact(): keep the analog waveforms, and the size below
+    // which an analog value is zero.
+    bool m_keepAnalog = true;
+    double m_analogThreshold = 0.;
+
+    bool m_verbose;
+    bool m_debug;
+  };
+
+} // namespace gramselecsim
+
+#endif // ElectronicsResponse_h
@@ -0,0 +1,126 @@
+// 16-Oct-2026
+
+// Electronics noise with a given power spectrum, added to the analog
+// waveforms.
+
+// The noise of real electronics isn't white: neighboring time bins
+// are correlated, and the spectrum has a shape set by the preamp and
+// shaper. Given a measured spectrum, this class synthesizes one long
+// noise waveform when the program starts: a random Gaussian
+// amplitude and phase for each frequency bin, scaled by the square
+// root of the power spectrum, then an inverse FFT. The result is
+// periodic, so any window of it (wrapping around at the end) is a
+// noise waveform with that spectrum.
+
+// The library is divided into windows of one waveform's length that
+// don't overlap. The cells of an event get consecutive windows,
+// starting from one chosen at random for the event, so no two cells
+// in an event share any noise as long as there are no more cells than
+// windows. This costs one random number per event instead of one per
+// time bin.
+
+// A fraction of the noise power can be made common to all the cells
+// in an event (coherent noise), by mixing in a window of a second
+// library, synthesized from its own random numbers, whose offset is
+// chosen once per event.
+
+// The noise is only added to the waveforms that are computed; that
+// is, those of the readout cells that received electrons. Cells with
+// no electrons have no waveform, and the coherent noise is only
+// shared among the cells that do.
+
+#ifndef NoiseLibrary_h
+#define NoiseLibrary_h
+
+#include "FFT.h" // in util/
+
+// ROOT includes
+#include "TRandom.h"
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace gramselecsim {
+
+  class NoiseLibrary
+  {
+  public:
+
+    // Read the spectrum from 'spectrumFile' and synthesize the noise
+    // for waveforms of 'numTimeBins' bins of width 'timeBinWidth'
+    // [ns]. The other parameters (the RMS, the length of the library,
+    // the coherent fraction) come from the options; see options.xml.
+    NoiseLibrary(const std::string& spectrumFile,
+		 int numTimeBins, double timeBinWidth);
+
+    // The number of samples in the library (a power of two).
+    std::size_t Size() const { return m_samples.size(); }
+
+    // The number of non-overlapping windows of a waveform's length in
+    // the library, and where window 'window' (modulo that number)
+    // starts.
+    std::size_t NumberOfWindows() const { return m_numWindows; }
+    std::size_t WindowOffset(std::size_t window) const
+    {
+      return ( window % m_numWindows ) * m_windowLength;
+    }
+
+    // A random window number, for the first cell of an event.
+    std::size_t RandomWindow(TRandom* random) const;
+
+    // A random starting point in the coherent library.
+    std::size_t RandomCoherentOffset(TRandom* random) const;
+
+    // Add noise to 'analog', using the library starting at 'offset'
+    // for this cell and the coherent library starting at
+    // 'eventOffset' for the noise shared by all the cells in the
+    // event. This doesn't change the object, so it can be called by
+    // several threads at once.
+    void Add(std::vector<double>& analog,
+	     std::size_t offset, std::size_t eventOffset) const;
+
+    // Is any of the noise shared among the cells of an event?
+    bool HasCoherentNoise() const { return m_commonWeight != 0.; }
+
+  private:
+
+    // Read (frequency, power) pairs from the spectrum file.
+    void m_ReadSpectrum(const std::string& spectrumFile);
+
+    // The noise power at frequency f [MHz], interpolated from the
+    // spectrum file.
+    double m_Power(double f) const;
+
+    // Synthesize a library of noise with the spectrum, scaled to
+    // 'rms', from the random-number stream 'subID'.
+    std::vector<float> m_Synthesize(util::RealFFT& fft, double frequencyStep,
+				    double rms, int subID,
+				    const std::string& spectrumFile) const;
+
+    std::vector<double> m_frequency;
+    std::vector<double> m_power;
+
+    // The noise waveforms of the cells and of the coherent noise,
+    // scaled to the requested RMS. A float is plenty for noise, and
+    // halves the memory. m_coherentSamples is empty if there's no
+    // coherent noise.
+    std::vector<float> m_samples;
+    std::vector<float> m_coherentSamples;
+    std::size_t m_mask;
+
+    std::size_t m_windowLength;
+    std::size_t m_numWindows;
+
+    // The weights of the cell's own window and of the event's
+    // common window, such that the sum of their squares is 1.
+    double m_ownWeight;
+    double m_commonWeight;
+
+    bool m_verbose;
+    bool m_debug;
+  };
+
+} // namespace gramselecsim
+
+#endif // NoiseLibrary_h
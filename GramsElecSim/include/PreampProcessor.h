@@ -3,10 +3,14 @@
 #define PreampProcessor_h
 
 #include <vector>
+#include <complex>
+#include <memory>
 
 #include "ElecStructure.h"
 #include "LoadOptionFile.h" 
 
+#include "FFT.h" // in util/
+
 namespace gramselecsim {
 
     class PreampProcessor
@@ -16,10 +20,44 @@ namespace gramselecsim {
         PreampProcessor(int);
         virtual ~PreampProcessor();
 
-        std::vector<double> ConvoluteResponse(const std::vector<int>&);
+        // Convolve the number of electrons in each time bin with the
+        // preamp response. Depending on the option preampConvolution,
+        // this is done directly or with FFTs; with "auto", the method
+        // is chosen for each waveform by estimating which is faster
+        // from the number of occupied time bins.
+        // These don't change the object, so one PreampProcessor can
+        // be used by several threads at once.
+        std::vector<double> ConvoluteResponse(const std::vector<int>&) const;
+
+        // The two methods. They give the same results, apart from
+        // rounding.
+        std::vector<double> ConvoluteDirect(const std::vector<int>&) const;
+        std::vector<double> ConvoluteFFT(const std::vector<int>&) const;
+
+        // The same convolution, for a waveform given by its occupied
+        // time bins (in increasing order) and the number of electrons
+        // in each. 'output' is set to zero and only the responses to
+        // those bins are computed; there's no scan over the empty
+        // bins, in the convolution or in the choice of method.
+        void ConvoluteSparse(const std::vector<int>& bins, const std::vector<int>& counts,
+                             std::vector<double>& output) const;
+
+        // The response to the electrons in time bin i covers bins
+        // [i + ResponseStart(), i + ResponseStart() + ResponseLength()),
+        // clipped to the waveform.
+        int ResponseStart() const { return shift_; }
+        int ResponseLength() const { return kernel_length_; }
 
     private:
 
+        // For the FFT method: convolve the input bins [begin,end), which
+        // are at the start of 'buffer' (the rest is zeros), with the
+        // response, and add the result to 'output'. 'buffer' and
+        // 'spectrum' are work space of the FFT's size.
+        void m_ConvoluteBlock(int begin, int end, std::vector<double>& buffer,
+                              std::vector< std::complex<double> >& spectrum,
+                              std::vector<double>& output) const;
+
         bool m_verbose;
         bool m_debug;
 
@@ -30,6 +68,29 @@ namespace gramselecsim {
         std::vector<int> preamp_time_bin_;
         std::vector<double> preamp_response_;
 
+        // The response is applied to bins [i + shift_, i + shift_ +
+        // kernel_length_) for the electrons in time bin i.
+        int kernel_length_;
+        int shift_;
+
+        // How to do the convolution: 0 = choose for each waveform, 1
+        // = direct, 2 = FFT.
+        int method_;
+
+        // For the FFT method (overlap-add): the input is cut into
+        // blocks of block_length_ bins. Each block is padded with
+        // zeros to the FFT size, transformed, multiplied by the
+        // transform of the response (computed once, with the gain
+        // included), and transformed back. Blocks with no electrons
+        // are skipped.
+        std::unique_ptr<util::RealFFT> fft_;
+        int block_length_;
+        std::vector< std::complex<double> > response_spectrum_;
+
+        // The estimated cost of one FFT block, in units of the
+        // multiply-adds of the direct method.
+        double fft_block_cost_;
+
         general_header                  header_gen_;
         preamp_header                   header_preamp_;
 
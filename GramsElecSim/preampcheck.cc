@@ -0,0 +1,161 @@
+// preampcheck.cc
+// Check the FFT used by the electronics simulation against a direct
+// DFT, and the FFT preamp convolution against the direct one. See
+// "Preamp convolution" in GramsElecSim/README.md.
+// 16-Oct-2026
+
+#include "PreampProcessor.h"
+#include "LoadOptionFile.h"
+
+// For processing command-line and XML file options.
+#include "Options.h" // in util/
+
+// The transform being checked, and random numbers for the inputs.
+#include "FFT.h" // in util/
+#include "RandomService.h" // in util/
+
+// C++ includes
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstddef>
+
+namespace {
+
+  // The largest difference between util::RealFFT and a direct
+  // evaluation of the DFT of random values, relative to the sum of
+  // their magnitudes (the largest a transform bin could be); and
+  // the largest difference after the inverse transform, relative to
+  // the largest value.
+  void CheckFFT(std::size_t a_size, util::RandomStream& a_random,
+		double& a_forwardError, double& a_inverseError)
+  {
+    util::RealFFT fft( a_size );
+    std::vector<double> input( a_size );
+    double sum = 0.;
+    double largest = 0.;
+    for ( auto& value : input ) {
+      value = a_random.Gaus();
+      sum += std::abs(value);
+      largest = std::max( largest, std::abs(value) );
+    }
+
+    std::vector< std::complex<double> > spectrum( fft.NumberOfBins() );
+    fft.Forward( input.data(), spectrum.data() );
+
+    a_forwardError = 0.;
+    for ( std::size_t k = 0; k != fft.NumberOfBins(); ++k ) {
+      std::complex<double> dft = 0.;
+      for ( std::size_t n = 0; n != a_size; ++n )
+	dft += input[n] * std::polar( 1., -2. * M_PI * double( ( k * n ) % a_size ) / double(a_size) );
+      a_forwardError = std::max( a_forwardError, std::abs( dft - spectrum[k] ) / sum );
+    }
+
+    std::vector<double> output( a_size );
+    fft.Inverse( spectrum.data(), output.data() );
+    a_inverseError = 0.;
+    for ( std::size_t n = 0; n != a_size; ++n )
+      a_inverseError = std::max( a_inverseError, std::abs( output[n] - input[n] ) / largest );
+  }
+
+  // The largest difference between two waveforms, and the largest
+  // value in the first.
+  void Compare(const std::vector<double>& a_reference, const std::vector<double>& a_other,
+	       double& a_difference, double& a_peak)
+  {
+    for ( std::size_t i = 0; i != a_reference.size(); ++i ) {
+      a_difference = std::max( a_difference, std::abs( a_other[i] - a_reference[i] ) );
+      a_peak = std::max( a_peak, std::abs( a_reference[i] ) );
+    }
+  }
+
+} // anonymous namespace
+
+int main(int argc,char **argv)
+{
+  // The preamp is configured by the <gramselecsim> options, as it
+  // would be in gramselecsim.
+  auto options = util::Options::GetInstance();
+  auto result = options->ParseOptions(argc, argv, "gramselecsim");
+
+  // Abort if we couldn't parse the job options.
+  if (! result) {
+    std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+	      << "preampcheck: Aborting job due to failure to parse options"
+	      << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  bool help;
+  options->GetOption("help",help);
+  if (help) {
+    options->PrintHelp();
+    exit(EXIT_SUCCESS);
+  }
+
+  auto optionloader = gramselecsim::LoadOptionFile::GetInstance();
+  optionloader->Load();
+
+  // Both checks should be at the level of double-precision rounding.
+  const double tolerance = 1.e-12;
+  bool passed = true;
+
+  util::RandomStream random;
+  random.SetKey( 1, 0, 0, 0, 0 );
+
+  double worstForward = 0.;
+  double worstInverse = 0.;
+  for ( std::size_t size = 4; size <= 4096; size *= 2 ) {
+    double forward, inverse;
+    CheckFFT( size, random, forward, inverse );
+    worstForward = std::max( worstForward, forward );
+    worstInverse = std::max( worstInverse, inverse );
+  }
+  const bool fftOK = ( worstForward <= tolerance  &&  worstInverse <= tolerance );
+  passed &= fftOK;
+  std::cout << "preampcheck: util::RealFFT sizes 4 to 4096: largest difference from a direct DFT "
+	    << worstForward << ", after the inverse " << worstInverse
+	    << " (relative)" << ( fftOK ? "" : " FAILED" ) << std::endl;
+
+  // Waveforms from a few occupied bins to every bin occupied.
+  const gramselecsim::general_header header_gen = optionloader->GeneralHeader();
+  const int numTimeBins = int( header_gen.time_window / header_gen.timebin_width );
+  gramselecsim::PreampProcessor preamp( numTimeBins );
+
+  double difference = 0.;
+  double sparseDifference = 0.;
+  double peak = 0.;
+  for ( int trial = 0; trial != 100; ++trial ) {
+    const double occupancy = std::pow( 10., -3. + 3. * double(trial) / 99. );
+    std::vector<int> electrons( numTimeBins, 0 );
+    std::vector<int> bins, counts;
+    for ( int i = 0; i != numTimeBins; ++i ) {
+      if ( random.Rndm() < occupancy ) {
+	electrons[i] = 1 + int( random.Rndm() * 1000. );
+	bins.push_back( i );
+	counts.push_back( electrons[i] );
+      }
+    }
+
+    const auto direct = preamp.ConvoluteDirect( electrons );
+    const auto fft = preamp.ConvoluteFFT( electrons );
+    std::vector<double> sparse;
+    preamp.ConvoluteSparse( bins, counts, sparse );
+    double ignored = 0.;
+    Compare( direct, fft, difference, peak );
+    Compare( direct, sparse, sparseDifference, ignored );
+  }
+  const double relative = ( peak > 0. ) ? difference / peak : difference;
+  const double sparseRelative = ( peak > 0. ) ? sparseDifference / peak : sparseDifference;
+  const bool convolutionOK = ( relative <= tolerance  &&  sparseRelative <= tolerance );
+  passed &= convolutionOK;
+  std::cout << "preampcheck: " << numTimeBins << "-bin waveforms: largest difference from "
+	    << "ConvoluteDirect " << relative << " for ConvoluteFFT and "
+	    << sparseRelative << " for ConvoluteSparse (relative to the peak)"
+	    << ( convolutionOK ? "" : " FAILED" ) << std::endl;
+
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
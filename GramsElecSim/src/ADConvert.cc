@@ -12,6 +12,9 @@
 // C++ includes
 #include <iostream>
 #include <cmath>
+#include <vector>
+#include <utility>
+#include <algorithm>
 
 namespace gramselecsim {
 
@@ -38,6 +41,9 @@ namespace gramselecsim {
 
     r_adcbin_width_to_origin_width_ = ( 1000.0 / header_adc_.sample_freq ) / header_gen_.timebin_width;
 
+    // The value for a stretch of waveform with no signal.
+    baseline_ = Digitize( std::vector<double>( r_adcbin_width_to_origin_width_, 0.0 ), 0 );
+
     if (m_verbose) {
       std::cout << "gramselecsim::ADConvert - "
         	<< " Resolution = " <<  header_adc_.bit_resolution 
@@ -49,33 +55,57 @@ namespace gramselecsim {
 
   ADConvert::~ADConvert() {}
 
+  // Compute one digital bin by averaging the analog bins within it.
+  int ADConvert::Digitize( const std::vector<double>& analog_waveform, int i ) const {
+
+    Double_t analog_val = 0.0;
+
+    // For each analog bin to be summed into a digital bin:
+    for (int j=0; j<r_adcbin_width_to_origin_width_; j++) {
+
+      // "Clip" the analog signal to the limits of the ADC
+      analog_val += std::min( std::max(
+				       analog_waveform[i * r_adcbin_width_to_origin_width_ + j], 
+				       header_adc_.input_min), 
+			      header_adc_.input_max);
+    }
+
+    analog_val /= r_adcbin_width_to_origin_width_;
+    return std::floor( (analog_val - header_adc_.input_min) / lsb_ );
+  }
+
   // Convert the analog waveform into ADC counts.
-  std::vector<int> ADConvert::Process( std::vector<double>& analog_waveform ) {
+  std::vector<int> ADConvert::Process( std::vector<double>& analog_waveform ) const {
 
-    Double_t analog_val;
     // The length (in bins) of the digitized ADC waveform. 
     int length_waveform = analog_waveform.size() / r_adcbin_width_to_origin_width_;
     std::vector<int> digital_waveform(length_waveform, 0);
 
     // For each of the bins in the (destination) digital waveform:
     for (int i=0; i<length_waveform; i++) {
+      digital_waveform[i] = Digitize( analog_waveform, i );
+    } // for each digital bin
 
-      analog_val = 0.0;
+    return digital_waveform;
+  }
 
-      // For each analog bin to be summed into a digital bin:
-      for (int j=0; j<r_adcbin_width_to_origin_width_; j++) {
+  // Convert only the regions of the waveform that have a signal.
+  std::vector<int> ADConvert::Process( const std::vector<double>& analog_waveform,
+				       const std::vector< std::pair<int,int> >& regions ) const {
 
-	// "Clip" the analog signal to the limits of the ADC
-	analog_val += std::min( std::max(
-					 analog_waveform[i * r_adcbin_width_to_origin_width_ + j], 
-					 header_adc_.input_min), 
-				header_adc_.input_max);
+    int length_waveform = analog_waveform.size() / r_adcbin_width_to_origin_width_;
+    std::vector<int> digital_waveform(length_waveform, baseline_);
+
+    for ( const auto& [ first, last ] : regions ) {
+      // The digital bins that contain any of the analog bins in
+      // [first,last).
+      const int firstDigital = std::max( first, 0 ) / r_adcbin_width_to_origin_width_;
+      const int lastDigital = std::min( ( last + r_adcbin_width_to_origin_width_ - 1 )
+					/ r_adcbin_width_to_origin_width_, length_waveform );
+      for (int i=firstDigital; i<lastDigital; i++) {
+	digital_waveform[i] = Digitize( analog_waveform, i );
       }
-
-      analog_val /= r_adcbin_width_to_origin_width_;
-      digital_waveform[i] = std::floor( (analog_val - header_adc_.input_min) / lsb_ );
-
-    } // for each digital bin
+    }
 
     return digital_waveform;
   }
@@ -35,6 +35,9 @@ namespace gramselecsim {
     auto optionloader = LoadOptionFile::GetInstance();
     m_header = optionloader->NoiseHeader();
 
+    // Unless told otherwise, use ROOT's default generator.
+    m_random = gRandom;
+
     if (m_verbose_) {
       std::cout << "gramselecsim::AddNoise() - "
 		<< " noise_param0 = " << m_header.noise_param0 
@@ -49,7 +52,7 @@ namespace gramselecsim {
     std::vector<double> random_vec(vec_length);
 
     for (int i=0; i<vec_length; i++) {
-      random_vec[i] = gRandom->Gaus(0.0,1.0);
+      random_vec[i] = m_random->Gaus(0.0,1.0);
     }
 
     return random_vec;
@@ -0,0 +1,440 @@
+// 16-Oct-2026
+// Apply the electronics models to the readout cells in an event.
+
+#include "ElectronicsResponse.h"
+#include "AddNoise.h"
+#include "ADConvert.h"
+#include "PreampProcessor.h"
+#include "LoadOptionFile.h"
+#include "ElecStructure.h"
+
+// For processing command-line and XML file options.
+#include "Options.h" // in util/
+
+// Per-event random-number streams.
+#include "RandomService.h" // in util/
+
+// For computing the readout cells of an event in parallel.
+#include "ThreadPool.h" // in util/
+
+// From GramsDataObj
+#include "EventID.h"
+#include "ElectronClusters.h"
+#include "ReadoutID.h"
+#include "ReadoutMap.h"
+#include "CompactReadoutMap.h"
+#include "ReadoutWaveforms.h"
+#include "CompactReadoutWaveforms.h"
+
+// C++ includes
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <utility>
+#include <string>
+#include <cstdlib>
+#include <cstddef>
+#include <functional>
+
+namespace gramselecsim {
+
+  // Constructor: Initializes the class.
+  ElectronicsResponse::ElectronicsResponse()
+  {
+    auto options = util::Options::GetInstance();
+    options->GetOption("verbose",m_verbose);
+    options->GetOption("debug",m_debug);
+
+    auto optionloader = LoadOptionFile::GetInstance();
+    general_header header_gen = optionloader->GeneralHeader();
+
+    // The number of time bins for the analog waveform.
+    m_timeBinWidth = header_gen.timebin_width;
+    m_numTimeBins = int(header_gen.time_window / header_gen.timebin_width);
+
+    if (m_verbose) {
+      std::cout << "gramselecsim::ElectronicsResponse: number of analog time bins="
+		<< m_numTimeBins << std::endl;
+    }
+
+    // Algorithms for computing waveforms.
+    m_adconverter = std::make_unique<ADConvert>();
+    m_preampProcessor = std::make_unique<PreampProcessor>(m_numTimeBins);
+
+    // Noise with a measured spectrum, added to the analog waveform.
+    std::string noiseSpectrumFile;
+    options->GetOption("noiseSpectrumFile",noiseSpectrumFile);
+    if ( ! noiseSpectrumFile.empty() )
+      m_noiseLibrary = std::make_unique<NoiseLibrary>( noiseSpectrumFile,
+						       m_numTimeBins, m_timeBinWidth );
+
+    // The noise model has a random-number stream, so each thread
+    // gets its own copy.
+    int nthreads;
+    options->GetOption("nthreads",nthreads);
+    const AddNoise addNoise;
+    for ( int t = 0; t < std::max( nthreads, 1 ); ++t )
+      m_workers.push_back( std::make_unique<Worker>( addNoise, m_numTimeBins ) );
+    if ( nthreads > 0 ) {
+      m_pool = std::make_unique<util::ThreadPool>( nthreads );
+      if (m_verbose) {
+	std::cout << "gramselecsim::ElectronicsResponse: computing the readout cells of each event with "
+		  << nthreads << " threads" << std::endl;
+      }
+    }
+
+    // How to keep the analog waveforms when they're written in the
+    // compact form (see compactWaveforms in options.xml).
+    std::string compactAnalog;
+    options->GetOption("compactAnalog",compactAnalog);
+    if ( compactAnalog == "none" )
+      m_keepAnalog = false;
+    else if ( compactAnalog != "float" ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramselecsim::ElectronicsResponse - compactAnalog='" << compactAnalog
+		<< "' should be 'float' or 'none'" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    // A millionth of an ADC count is far below anything the ADC
+    // could see, but well above the rounding errors of the FFT
+    // convolution.
+    m_analogThreshold = 1.e-6 * m_adconverter->LSB();
+
+    options->GetOption("sparseWaveforms",m_sparse);
+    const auto header_noise = optionloader->NoiseHeader();
+    if ( m_sparse  &&  m_noiseLibrary  &&  m_verbose ) {
+      std::cout << "gramselecsim::ElectronicsResponse: with noiseSpectrumFile, "
+		<< "sparseWaveforms still skips the empty time bins in the "
+		<< "preamp convolution, but every ADC sample is computed" << std::endl;
+    }
+    // The sparse path draws the noise of the k-th occupied bin from
+    // the k-th random number, rather than the random number of the
+    // bin itself; so it matches the full waveforms only if there's
+    // no noise at all.
+    const bool noise = ( header_noise.noise_param0 != 0.
+			 ||  header_noise.noise_param1 != 0.
+			 ||  header_noise.noise_param2 != 0. );
+    if ( m_sparse  &&  noise  &&  m_verbose ) {
+      std::cout << "gramselecsim::ElectronicsResponse: with sparseWaveforms, "
+		<< "the noise (noise_param0=" << header_noise.noise_param0
+		<< " noise_param1=" << header_noise.noise_param1
+		<< " noise_param2=" << header_noise.noise_param2
+		<< ") has the same distribution but different random numbers, "
+		<< "so the waveforms differ from those without the flag";
+      if ( header_noise.noise_param0 != 0. )
+	std::cout << "; the noise in time bins with no electrons is left out";
+      std::cout << std::endl;
+    }
+
+    // Any model that requires random-number generation draws from a
+    // stream set by util::RandomService for each readout cell in each
+    // event, using the rngseed option, the EventID, and the ReadoutID.
+    m_randomService = util::RandomService::GetInstance();
+  }
+
+  void ElectronicsResponse::Process(const grams::EventID& a_eventID,
+				    const grams::FlatElectronClusters& a_clusters,
+				    const grams::FlatReadoutMap& a_readoutMap,
+				    grams::FlatReadoutWaveforms& a_waveforms)
+  {
+    // An event in a single segment.
+    Accumulate( a_eventID, a_clusters, a_readoutMap );
+    Finish( a_eventID, a_waveforms );
+  }
+
+  ElectronicsResponse::Arrivals& ElectronicsResponse::m_Arrivals(const grams::ReadoutID& a_readoutID)
+  {
+    // The electrons arriving at this cell. If this is the cell's
+    // first segment, this starts an empty list.
+    return m_arrivals[ a_readoutID ];
+  }
+
+  template <typename Map>
+  void ElectronicsResponse::m_FindCells(const Map& a_readoutMap)
+  {
+    // Add all the new cells first, since adding a cell can move the
+    // others in memory.
+    for ( const auto& cell : a_readoutMap )
+      m_Arrivals( cell.first );
+
+    m_cells.clear();
+    m_cells.reserve( a_readoutMap.size() );
+    for ( const auto& cell : a_readoutMap )
+      m_cells.push_back( &( m_arrivals.find( cell.first )->second ) );
+  }
+
+  void ElectronicsResponse::m_ForEachCell(std::size_t a_n,
+					  const std::function<void(std::size_t, int)>& a_func)
+  {
+    if ( m_pool  &&  a_n > 1 )
+      m_pool->ParallelFor( a_n, a_func );
+    else
+      for ( std::size_t cell = 0; cell != a_n; ++cell )
+	a_func( cell, 0 );
+  }
+
+  void ElectronicsResponse::m_AddCluster(const grams::ElectronCluster& a_cluster,
+					 Arrivals& a_arrivals) const
+  {
+    if (m_debug) {
+      std::cout << "gramselecsim::ElectronicsResponse: about to process cluster: " << std::endl
+		<< a_cluster << std::endl;
+    }
+
+    // The integer time bin in which the cluster arrived.
+    int ti = std::max(0,
+		      std::min(m_numTimeBins-1, int(std::floor( a_cluster.TAtAnode() / m_timeBinWidth)))
+		      );
+
+    // Accumulate the number of electrons to arrive at the cell
+    // within each time bin.
+    a_arrivals.emplace_back( ti, a_cluster.NumElectrons() );
+  }
+
+  void ElectronicsResponse::Accumulate(const grams::EventID& a_eventID,
+				       const grams::FlatElectronClusters& a_clusters,
+				       const grams::FlatReadoutMap& a_readoutMap)
+  {
+    m_FindCells( a_readoutMap );
+
+    // For each readout cell that received any electron clusters:
+    m_ForEachCell( a_readoutMap.size(), [&]( std::size_t a_cell, int ) {
+
+      const auto& clusterKeys = ( a_readoutMap.cbegin() + a_cell )->second;
+      auto& arrivals = *m_cells[ a_cell ];
+
+      // for each electron cluster assigned to this readout cell:
+      for ( const auto& clusterKey: clusterKeys ) {
+
+	// Find the key for this cluster in our list of electron
+	// clusters.
+	const auto search = a_clusters.find( clusterKey );
+
+	if ( search == a_clusters.cend() ) {
+	  // This should not happen. It means that the readout map
+	  // refers to a cluster key that was never defined.
+	  std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		    << "gramselecsim: Aborting due to mis-match between "
+		    << "the electron clusters and the readout map for event "
+		    << a_eventID << std::endl;
+	  exit(EXIT_FAILURE);
+	}
+
+	// We found the cluster's key in the list of electron
+	// clusters. Fetch that cluster; remember that a map consists
+	// of pairs (first,second).
+	const auto& cluster = (*search).second;
+
+	m_AddCluster( cluster, arrivals );
+
+      } // for each cluster within a readout cell
+    }); // for each cell with arriving electrons
+  }
+
+  void ElectronicsResponse::Process(const grams::EventID& a_eventID,
+				    const grams::FlatElectronClusters& a_clusters,
+				    const grams::CompactReadoutMap& a_readoutMap,
+				    grams::FlatReadoutWaveforms& a_waveforms)
+  {
+    Accumulate( a_eventID, a_clusters, a_readoutMap );
+    Finish( a_eventID, a_waveforms );
+  }
+
+  void ElectronicsResponse::Accumulate(const grams::EventID& a_eventID,
+				       const grams::FlatElectronClusters& a_clusters,
+				       const grams::CompactReadoutMap& a_readoutMap)
+  {
+    const auto numberOfClusters = a_clusters.size();
+
+    m_FindCells( a_readoutMap );
+
+    m_ForEachCell( a_readoutMap.size(), [&]( std::size_t a_cell, int ) {
+      const auto indices = a_readoutMap[ a_cell ].second;
+      auto& arrivals = *m_cells[ a_cell ];
+      arrivals.reserve( arrivals.size() + indices.size() );
+
+      for ( const auto index : indices ) {
+	if ( index >= numberOfClusters ) {
+	  // As above: the readout map doesn't go with these clusters.
+	  std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		    << "gramselecsim: Aborting due to mis-match between "
+		    << "the electron clusters and the readout map for event "
+		    << a_eventID << std::endl;
+	  exit(EXIT_FAILURE);
+	}
+	m_AddCluster( grams::ClusterAt( a_clusters, index ), arrivals );
+      }
+    });
+  }
+
+  void ElectronicsResponse::Finish(const grams::EventID& a_eventID,
+				   grams::FlatReadoutWaveforms& a_waveforms)
+  {
+    // Clear out any waveform information from the previous event.
+    a_waveforms.clear();
+    a_waveforms.reserve( m_arrivals.size() );
+
+    // Create an (empty) entry for each readout cell that received any
+    // electrons. The readout cells are visited in order, so this
+    // appends to the end of the list. Each cell's waveforms are then
+    // computed in its own entry, so the threads never write to the
+    // same place.
+    for ( const auto& [ readoutID, arrivals ] : m_arrivals ) {
+      grams::ReadoutWaveform readoutWaveform;
+      readoutWaveform.readoutID = readoutID;
+      a_waveforms.insert( std::make_pair( readoutID, readoutWaveform ) );
+    }
+
+    // The windows of the spectrum noise: the cells take consecutive
+    // windows from a random starting one, so they don't overlap; and
+    // the part that's common to all the cells in the event.
+    if ( m_noiseLibrary ) {
+      m_randomService->SetStream( m_eventRandom, util::RandomService::e_gramselecsimnoise,
+				  a_eventID.Run(), a_eventID.Event(), 1 );
+      m_eventNoiseWindow = m_noiseLibrary->RandomWindow( &m_eventRandom );
+      if ( m_noiseLibrary->HasCoherentNoise() )
+	m_eventNoiseOffset = m_noiseLibrary->RandomCoherentOffset( &m_eventRandom );
+
+      if ( m_arrivals.size() > m_noiseLibrary->NumberOfWindows()  &&  ! m_warnedNoiseWindows ) {
+	std::cout << "gramselecsim::ElectronicsResponse: event " << a_eventID << " has "
+		  << m_arrivals.size() << " readout cells with electrons, but the noise library only has "
+		  << m_noiseLibrary->NumberOfWindows() << " separate windows; some cells will get "
+		  << "the same noise. Increase noiseLibraryLength." << std::endl;
+	m_warnedNoiseWindows = true;
+      }
+    }
+
+    m_ForEachCell( m_arrivals.size(), [&]( std::size_t a_cell, int a_thread ) {
+      auto& [ readoutID, arrivals ] = *( m_arrivals.begin() + a_cell );
+      auto& readoutWaveform = ( a_waveforms.begin() + a_cell )->second;
+      auto& worker = *m_workers[ a_thread ];
+
+      if (m_debug) {
+	std::cout << "gramselecsim::ElectronicsResponse: about to compute waveform for "
+		  << "ReadoutID=" << readoutID << std::endl;
+      }
+
+      // The noise for a readout cell depends only on the event and
+      // the cell (and, for the spectrum noise, its place among the
+      // event's cells), not on the thread that computes it.
+      m_randomService->SetStream( worker.random, util::RandomService::e_gramselecsim,
+				  a_eventID.Run(), a_eventID.Event(), readoutID.Key(), readoutID.Tile() );
+
+      const std::size_t noiseOffset
+	= m_noiseLibrary ? m_noiseLibrary->WindowOffset( m_eventNoiseWindow + a_cell ) : 0;
+
+      if ( m_sparse )
+	m_SparseWaveform( worker, arrivals, noiseOffset, readoutWaveform );
+      else
+	m_Waveform( worker, arrivals, noiseOffset, readoutWaveform );
+    }); // for each cell with arriving electrons
+
+    // Start the next event with no readout cells.
+    m_arrivals.clear();
+  }
+
+  void ElectronicsResponse::Compact(const grams::FlatReadoutWaveforms& a_waveforms,
+				    grams::CompactReadoutWaveforms& a_compactWaveforms) const
+  {
+    a_compactWaveforms.Assign( a_waveforms, m_adconverter->Baseline(),
+			       m_keepAnalog, m_analogThreshold );
+  }
+
+  void ElectronicsResponse::m_Waveform(Worker& a_worker, Arrivals& a_arrivals,
+				       std::size_t a_noiseOffset,
+				       grams::ReadoutWaveform& a_waveform) const
+  {
+    auto& electronsPerBin = a_worker.electrons;
+
+    // The number of electrons in every time bin.
+    for ( const auto& [ bin, electrons ] : a_arrivals )
+      electronsPerBin[ bin ] += electrons;
+
+    if (m_debug) {
+      std::cout << "gramselecsim::ElectronicsResponse: AddNoise..." << std::endl;
+    }
+
+    // Add noise to the number of electrons.
+    const auto num_arrival_electron_with_noise
+      = a_worker.addNoise.ProcessElectronNoise( electronsPerBin );
+
+    for ( const auto& arrival : a_arrivals )
+      electronsPerBin[ arrival.first ] = 0;
+
+    if (m_debug) {
+      std::cout << "gramselecsim::ElectronicsResponse: PreAmp..." << std::endl;
+    }
+
+    //Add a response function
+    a_waveform.analog = m_preampProcessor->ConvoluteResponse( num_arrival_electron_with_noise );
+
+    // Add the noise with a measured spectrum.
+    if ( m_noiseLibrary )
+      m_noiseLibrary->Add( a_waveform.analog, a_noiseOffset, m_eventNoiseOffset );
+
+    if (m_debug) {
+      std::cout << "gramselecsim::ElectronicsResponse: ADConvert..." << std::endl;
+    }
+
+    // Convert analog into digital
+    a_waveform.digital = m_adconverter->Process( a_waveform.analog );
+  }
+
+  void ElectronicsResponse::m_SparseWaveform(Worker& a_worker, Arrivals& a_arrivals,
+					     std::size_t a_noiseOffset,
+					     grams::ReadoutWaveform& a_waveform) const
+  {
+    auto& bins = a_worker.bins;
+    auto& counts = a_worker.counts;
+    auto& regions = a_worker.regions;
+
+    // Sort the arrivals by time bin, and add up the electrons within
+    // each bin.
+    std::sort( a_arrivals.begin(), a_arrivals.end() );
+    bins.clear();
+    counts.clear();
+    for ( const auto& [ bin, electrons ] : a_arrivals ) {
+      if ( ! bins.empty()  &&  bins.back() == bin )
+	counts.back() += electrons;
+      else {
+	bins.push_back( bin );
+	counts.push_back( electrons );
+      }
+    }
+
+    // Add noise only to the bins that have electrons.
+    const auto counts_with_noise = a_worker.addNoise.ProcessElectronNoise( counts );
+
+    // Convolve with the preamp response. Only the responses to the
+    // occupied bins are computed; the rest of the waveform is zero.
+    m_preampProcessor->ConvoluteSparse( bins, counts_with_noise, a_waveform.analog );
+
+    // The noise with a measured spectrum reaches every time bin, so
+    // the whole waveform has to be digitized.
+    if ( m_noiseLibrary ) {
+      m_noiseLibrary->Add( a_waveform.analog, a_noiseOffset, m_eventNoiseOffset );
+      a_waveform.digital = m_adconverter->Process( a_waveform.analog );
+      return;
+    }
+
+    // The regions of interest: the bins covered by the response to
+    // each occupied bin, merged where they overlap. Only those are
+    // digitized; elsewhere the analog waveform is zero.
+    const int start = m_preampProcessor->ResponseStart();
+    const int length = m_preampProcessor->ResponseLength();
+    regions.clear();
+    for ( const auto bin : bins ) {
+      const int first = std::max( bin + start, 0 );
+      const int last = std::min( bin + start + length, m_numTimeBins );
+      if ( first >= last ) continue;
+      if ( ! regions.empty()  &&  first <= regions.back().second )
+	regions.back().second = std::max( regions.back().second, last );
+      else
+	regions.emplace_back( first, last );
+    }
+    a_waveform.digital = m_adconverter->Process( a_waveform.analog, regions );
+  }
+
+} // namespace gramselecsim
@@ -0,0 +1,215 @@
+// 16-Oct-2026
+// Synthesize electronics noise from a power spectrum.
+
+#include "NoiseLibrary.h"
+
+// For processing command-line and XML file options.
+#include "Options.h" // in util/
+
+// For the inverse transform and the random numbers.
+#include "FFT.h" // in util/
+#include "RandomService.h" // in util/
+
+// ROOT includes
+#include "TRandom.h"
+
+// C++ includes
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+
+namespace gramselecsim {
+
+  NoiseLibrary::NoiseLibrary(const std::string& a_spectrumFile,
+			     int a_numTimeBins, double a_timeBinWidth)
+  {
+    auto options = util::Options::GetInstance();
+    options->GetOption("verbose",m_verbose);
+    options->GetOption("debug",m_debug);
+
+    double rms;
+    options->GetOption("noiseSpectrumRMS",rms);
+    int length;
+    options->GetOption("noiseLibraryLength",length);
+    double coherentFraction;
+    options->GetOption("coherentNoiseFraction",coherentFraction);
+    if ( coherentFraction < 0.  ||  coherentFraction > 1. ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramselecsim::NoiseLibrary - coherentNoiseFraction=" << coherentFraction
+		<< " should be between 0 and 1" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    // The fraction applies to the noise power, so the two windows
+    // are weighted by its square root.
+    m_ownWeight = std::sqrt( 1. - coherentFraction );
+    m_commonWeight = std::sqrt( coherentFraction );
+
+    m_ReadSpectrum( a_spectrumFile );
+
+    // The library should hold a window of a waveform's length for
+    // each cell with electrons in an event.
+    const std::size_t size
+      = util::RealFFT::GoodSize( std::max( std::size_t( std::max( length, 0 ) ),
+					   std::size_t( a_numTimeBins ) ) );
+    m_mask = size - 1;
+    m_windowLength = std::size_t( std::max( a_numTimeBins, 1 ) );
+    m_numWindows = size / m_windowLength;
+    util::RealFFT fft( size );
+
+    // The time bins are in ns, and the spectrum's frequencies in MHz.
+    const double frequencyStep = 1000. / ( a_timeBinWidth * double(size) );
+
+    // Each library has a random-number stream of its own (the event
+    // streams use subID 1), so the noise depends only on rngseed, and
+    // the coherent noise isn't correlated with the cells' own.
+    m_samples = m_Synthesize( fft, frequencyStep, rms, 0, a_spectrumFile );
+    if ( m_commonWeight != 0. )
+      m_coherentSamples = m_Synthesize( fft, frequencyStep, rms, 2, a_spectrumFile );
+
+    if (m_verbose) {
+      std::cout << "gramselecsim::NoiseLibrary - " << m_frequency.size()
+		<< " points read from '" << a_spectrumFile << "'; "
+		<< size << " samples of noise with RMS " << rms << " mV ("
+		<< m_numWindows << " waveforms), "
+		<< coherentFraction << " of the power common to each event" << std::endl;
+    }
+  }
+
+  std::vector<float> NoiseLibrary::m_Synthesize(util::RealFFT& a_fft, double a_frequencyStep,
+						double a_rms, int a_subID,
+						const std::string& a_spectrumFile) const
+  {
+    const std::size_t size = a_fft.Size();
+
+    // Draw a complex Gaussian for each frequency bin, and scale it by
+    // the square root of the power spectrum.
+    util::RandomStream random;
+    util::RandomService::GetInstance()->SetStream( random, util::RandomService::e_gramselecsimnoise,
+						   0, 0, a_subID );
+    const std::size_t numBins = a_fft.NumberOfBins();
+    std::vector<double> gaussians( 2 * numBins );
+    util::GausArray( &random, gaussians.size(), gaussians.data() );
+
+    std::vector< std::complex<double> > spectrum( numBins );
+    for ( std::size_t k = 1; k != numBins; ++k ) {
+      const double amplitude = std::sqrt( m_Power( a_frequencyStep * double(k) ) );
+      spectrum[k] = amplitude * std::complex<double>( gaussians[2*k], gaussians[2*k + 1] );
+    }
+
+    // No offset, and the highest bin of a real sequence's transform
+    // is real.
+    spectrum[0] = 0.;
+    spectrum[numBins - 1] = spectrum[numBins - 1].real();
+
+    std::vector<double> noise( size );
+    a_fft.Inverse( spectrum.data(), noise.data() );
+
+    // Scale to the requested RMS.
+    double sumSquares = 0.;
+    for ( const auto value : noise )
+      sumSquares += value * value;
+    const double actualRMS = std::sqrt( sumSquares / double(size) );
+    if ( actualRMS <= 0. ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramselecsim::NoiseLibrary - the spectrum in '" << a_spectrumFile
+		<< "' is zero at every frequency between " << a_frequencyStep << " and "
+		<< a_frequencyStep * double(numBins - 1) << " MHz" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    const double scale = a_rms / actualRMS;
+    std::vector<float> samples( size );
+    for ( std::size_t i = 0; i != size; ++i )
+      samples[i] = float( noise[i] * scale );
+    return samples;
+  }
+
+  void NoiseLibrary::m_ReadSpectrum(const std::string& a_spectrumFile)
+  {
+    std::ifstream file( a_spectrumFile );
+    if ( ! file ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramselecsim::NoiseLibrary: Could not open file '" << a_spectrumFile << "'"
+		<< std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    // Each line is a frequency [MHz] and a noise power. Anything after
+    // a '#' is a comment.
+    std::string line;
+    int lineNumber = 0;
+    while ( std::getline( file, line ) ) {
+      ++lineNumber;
+      line = line.substr( 0, line.find('#') );
+      std::istringstream stream( line );
+
+      double frequency, power;
+      if ( ! ( stream >> frequency ) )
+	continue; // blank line
+      if ( ! ( stream >> power )  ||  power < 0.
+	   ||  ( ! m_frequency.empty()  &&  frequency <= m_frequency.back() ) ) {
+	std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		  << "gramselecsim::NoiseLibrary: '" << a_spectrumFile << "' line " << lineNumber
+		  << ": expected a frequency greater than the previous line's, "
+		  << "and a power that's not negative" << std::endl;
+	exit(EXIT_FAILURE);
+      }
+      m_frequency.push_back( frequency );
+      m_power.push_back( power );
+    }
+
+    if ( m_frequency.empty() ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramselecsim::NoiseLibrary: no spectrum found in '" << a_spectrumFile << "'"
+		<< std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  double NoiseLibrary::m_Power(double a_f) const
+  {
+    // Linear interpolation, and the nearest value beyond the ends.
+    if ( a_f <= m_frequency.front() ) return m_power.front();
+    if ( a_f >= m_frequency.back() ) return m_power.back();
+    const std::size_t upper
+      = std::upper_bound( m_frequency.cbegin(), m_frequency.cend(), a_f ) - m_frequency.cbegin();
+    const std::size_t lower = upper - 1;
+    const double fraction = ( a_f - m_frequency[lower] ) / ( m_frequency[upper] - m_frequency[lower] );
+    return m_power[lower] + fraction * ( m_power[upper] - m_power[lower] );
+  }
+
+  std::size_t NoiseLibrary::RandomWindow(TRandom* a_random) const
+  {
+    return std::size_t( a_random->Rndm() * double( m_numWindows ) ) % m_numWindows;
+  }
+
+  std::size_t NoiseLibrary::RandomCoherentOffset(TRandom* a_random) const
+  {
+    return std::size_t( a_random->Rndm() * double( Size() ) ) & m_mask;
+  }
+
+  void NoiseLibrary::Add(std::vector<double>& a_analog,
+			 std::size_t a_offset, std::size_t a_eventOffset) const
+  {
+    const float* samples = m_samples.data();
+    const std::size_t length = a_analog.size();
+    if ( m_commonWeight == 0. ) {
+      for ( std::size_t i = 0; i != length; ++i )
+	a_analog[i] += samples[ ( a_offset + i ) & m_mask ];
+    }
+    else {
+      const float* coherent = m_coherentSamples.data();
+      for ( std::size_t i = 0; i != length; ++i )
+	a_analog[i] += m_ownWeight * samples[ ( a_offset + i ) & m_mask ]
+	  + m_commonWeight * coherent[ ( a_eventOffset + i ) & m_mask ];
+    }
+  }
+
+} // namespace gramselecsim
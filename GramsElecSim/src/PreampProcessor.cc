@@ -10,10 +10,17 @@
 // For processing command-line and XML file options.
 #include "Options.h" // in util/
 
+// For the FFT convolution.
+#include "FFT.h" // in util/
+
 // C++ includes
 #include <iostream>
 #include <cmath>
 #include <numeric>
+#include <algorithm>
+#include <complex>
+#include <string>
+#include <memory>
 
 namespace gramselecsim {
 
@@ -82,16 +89,106 @@ namespace gramselecsim {
     //peak_delay_bin is the number of bins between peak time of a
     //response function and when an e- cluster arrives
     peak_delay_bin_ = static_cast<int>(std::floor(header_preamp_.peak_delay / header_gen_.timebin_width));
+
+    // Both convolution methods apply the response as a kernel of
+    // kernel_length_ bins, which starts shift_ bins after the time
+    // bin of the electrons.
+    kernel_length_ = std::max( std::min( preamp_time_bin_[0] + preamp_time_bin_[1], response_length_bin_ ), 0 );
+    shift_ = peak_delay_bin_ - preamp_time_bin_[0];
+
+    std::string method;
+    options->GetOption("preampConvolution",method);
+    if ( method.empty()  ||  method == "auto" )
+      method_ = 0;
+    else if ( method == "direct" )
+      method_ = 1;
+    else if ( method == "fft" )
+      method_ = 2;
+    else {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramselecsim::PreampProcessor - preampConvolution='" << method
+		<< "' is not 'auto', 'direct', or 'fft'" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    // There's nothing for an FFT to do with an empty response.
+    if ( kernel_length_ == 0 ) {
+      method_ = 1;
+      return;
+    }
+
+    // Pick the FFT size with the least work per input bin. An FFT of
+    // size n handles a block of n - kernel_length_ + 1 input bins,
+    // and costs about 2.5 n log2(n) in units of one direct-method
+    // multiply-add (measured on x86-64 with -O2, including the
+    // copying and the product of the transforms). There's no point
+    // in an FFT that's longer than the waveform plus the response.
+    const double costPerPoint = 2.5;
+    const std::size_t smallest = util::RealFFT::GoodSize( 2 * kernel_length_ );
+    const std::size_t largest = std::max( smallest,
+					  util::RealFFT::GoodSize( size_waveform_ + kernel_length_ ) );
+    std::size_t fftSize = smallest;
+    double bestCost = 0.;
+    for ( std::size_t size = smallest; size <= largest; size <<= 1 ) {
+      const double blockCost = costPerPoint * double(size) * std::log2( double(size) );
+      const double cost = blockCost / double( size - kernel_length_ + 1 );
+      if ( size == smallest  ||  cost < bestCost ) {
+	fftSize = size;
+	bestCost = cost;
+	fft_block_cost_ = blockCost;
+      }
+    }
+    fft_ = std::make_unique<util::RealFFT>( fftSize );
+    block_length_ = int(fftSize) - kernel_length_ + 1;
+
+    // The transform of the response, including the gain.
+    std::vector<double> buffer( fftSize, 0. );
+    response_spectrum_.resize( fft_->NumberOfBins() );
+    for ( int i = 0; i < kernel_length_; i++ )
+      buffer[i] = preamp_response_[i] * header_preamp_.preamp_gain;
+    fft_->Forward( buffer.data(), response_spectrum_.data() );
+
+    if (m_verbose) {
+      std::cout << "gramselecsim::PreampProcessor - response of " << kernel_length_
+		<< " bins; FFT size " << fftSize
+		<< ", input blocks of " << block_length_ << " bins" << std::endl;
+    }
   }
 
   PreampProcessor::~PreampProcessor(){}
 
   // Compute the analog waveform based on the number of electrons seen
   // at the pixel.
-  std::vector<double> PreampProcessor::ConvoluteResponse( const std::vector<int>& num_arrival_electron ) {
+  std::vector<double> PreampProcessor::ConvoluteResponse( const std::vector<int>& num_arrival_electron ) const {
+
+    if ( method_ == 1 )
+      return ConvoluteDirect( num_arrival_electron );
+    if ( method_ == 2 )
+      return ConvoluteFFT( num_arrival_electron );
+
+    // The direct method costs kernel_length_ multiply-adds for each
+    // time bin that has electrons; the FFT method costs a fixed
+    // amount for each block that has any.
+    long occupiedBins = 0;
+    long occupiedBlocks = 0;
+    for ( int begin = 0; begin < size_waveform_; begin += block_length_ ) {
+      const int end = std::min( begin + block_length_, size_waveform_ );
+      long occupied = 0;
+      for ( int i = begin; i < end; i++ )
+	occupied += ( num_arrival_electron[i] != 0 );
+      occupiedBins += occupied;
+      occupiedBlocks += ( occupied != 0 );
+    }
+
+    if ( double(occupiedBlocks) * fft_block_cost_ < double(occupiedBins) * double(kernel_length_) )
+      return ConvoluteFFT( num_arrival_electron );
+    return ConvoluteDirect( num_arrival_electron );
+  }
+
+  std::vector<double> PreampProcessor::ConvoluteDirect( const std::vector<int>& num_arrival_electron ) const {
 
     std::vector<double> output_waveform(size_waveform_, 0.0);
-    int event_start_bin;
+    const double* response = preamp_response_.data();
 
     // For every time bin:
     for (int i=0; i<size_waveform_; i++){
@@ -101,20 +198,13 @@ namespace gramselecsim {
 	continue;
       }
 
-      event_start_bin = i + peak_delay_bin_;
-
-      if( (event_start_bin - preamp_time_bin_[0]) < 0){
-	for(int j=0;j<event_start_bin;j++){
-	  output_waveform[j] += preamp_response_[preamp_time_bin_[0] - event_start_bin + j] * num_electron;
-	}
-      }   else if ( (event_start_bin + preamp_time_bin_[1]) > (size_waveform_ - 1) ){
-	for(int j = (event_start_bin - preamp_time_bin_[0]);j<size_waveform_;j++){
-	  output_waveform[j] += preamp_response_[j-event_start_bin + preamp_time_bin_[0]] * num_electron;
-	}
-      }   else{
-	for(int j=(event_start_bin - preamp_time_bin_[0]);j<(event_start_bin + preamp_time_bin_[1]);j++){
-	  output_waveform[j] += preamp_response_[j - event_start_bin + preamp_time_bin_[0]] * num_electron;
-	}
+      // The response starts at bin 'start'. Only the part of it that
+      // falls within the waveform is added.
+      const int start = i + shift_;
+      const int first = std::max( start, 0 );
+      const int last  = std::min( start + kernel_length_, size_waveform_ );
+      for (int j=first; j<last; j++){
+	output_waveform[j] += response[j - start] * num_electron;
       }
     }
 
@@ -126,4 +216,120 @@ namespace gramselecsim {
     return output_waveform;
   }
 
+  std::vector<double> PreampProcessor::ConvoluteFFT( const std::vector<int>& num_arrival_electron ) const {
+
+    std::vector<double> output_waveform(size_waveform_, 0.0);
+    if ( ! fft_ ) return ConvoluteDirect( num_arrival_electron );
+
+    const int fftSize = fft_->Size();
+    const std::size_t numBins = fft_->NumberOfBins();
+
+    // Each thread has its own work space, so that one
+    // PreampProcessor can be shared among threads.
+    thread_local std::vector<double> buffer;
+    thread_local std::vector< std::complex<double> > spectrum;
+    buffer.resize( fftSize );
+    spectrum.resize( numBins );
+
+    for ( int begin = 0; begin < size_waveform_; begin += block_length_ ) {
+      const int end = std::min( begin + block_length_, size_waveform_ );
+
+      // Copy the block, and skip it if there are no electrons in it.
+      bool empty = true;
+      for ( int i = begin; i < end; i++ ) {
+	buffer[i - begin] = num_arrival_electron[i];
+	empty &= ( num_arrival_electron[i] == 0 );
+      }
+      if ( empty ) continue;
+      std::fill( buffer.begin() + ( end - begin ), buffer.begin() + fftSize, 0. );
+
+      m_ConvoluteBlock( begin, end, buffer, spectrum, output_waveform );
+    }
+
+    return output_waveform;
+  }
+
+  void PreampProcessor::m_ConvoluteBlock( int begin, int end, std::vector<double>& buffer,
+					  std::vector< std::complex<double> >& spectrum,
+					  std::vector<double>& output_waveform ) const {
+
+    const std::size_t numBins = fft_->NumberOfBins();
+
+    // Multiply the transforms. The operator* for std::complex has to
+    // check for infinities, so write it out.
+    fft_->Forward( buffer.data(), spectrum.data() );
+    for ( std::size_t k = 0; k != numBins; k++ ) {
+      const auto a = spectrum[k];
+      const auto b = response_spectrum_[k];
+      spectrum[k] = std::complex<double>( a.real() * b.real() - a.imag() * b.imag(),
+					       a.real() * b.imag() + a.imag() * b.real() );
+    }
+    fft_->Inverse( spectrum.data(), buffer.data() );
+
+    // The block's response starts at bin begin + shift_ and is
+    // (end - begin) + kernel_length_ - 1 bins long, which fits in
+    // the FFT without wrapping around. Add it to the waveform where
+    // the two overlap.
+    const int start = begin + shift_;
+    const int first = std::max( start, 0 );
+    const int last  = std::min( start + ( end - begin ) + kernel_length_ - 1, size_waveform_ );
+    for ( int j = first; j < last; j++ )
+      output_waveform[j] += buffer[j - start];
+  }
+
+  void PreampProcessor::ConvoluteSparse( const std::vector<int>& bins, const std::vector<int>& counts,
+					 std::vector<double>& output_waveform ) const {
+
+    output_waveform.assign( size_waveform_, 0.0 );
+    const std::size_t numOccupied = bins.size();
+    if ( numOccupied == 0 ) return;
+
+    // The same choice as ConvoluteResponse, but the occupied blocks
+    // can be counted from the occupied bins.
+    bool useFFT = ( method_ == 2 );
+    if ( method_ == 0  &&  fft_ ) {
+      long occupiedBlocks = 0;
+      int lastBlock = -1;
+      for ( const auto bin : bins ) {
+	const int block = bin / block_length_;
+	occupiedBlocks += ( block != lastBlock );
+	lastBlock = block;
+      }
+      useFFT = ( double(occupiedBlocks) * fft_block_cost_
+		 < double(numOccupied) * double(kernel_length_) );
+    }
+
+    if ( ! useFFT  ||  ! fft_ ) {
+      // Add the response to each occupied bin, with the gain, over
+      // the bins it covers.
+      const double* response = preamp_response_.data();
+      for ( std::size_t k = 0; k != numOccupied; k++ ) {
+	const double charge = double( counts[k] ) * header_preamp_.preamp_gain;
+	const int start = bins[k] + shift_;
+	const int first = std::max( start, 0 );
+	const int last  = std::min( start + kernel_length_, size_waveform_ );
+	for ( int j = first; j < last; j++ )
+	  output_waveform[j] += response[j - start] * charge;
+      }
+      return;
+    }
+
+    const int fftSize = fft_->Size();
+    thread_local std::vector<double> buffer;
+    thread_local std::vector< std::complex<double> > spectrum;
+    buffer.resize( fftSize );
+    spectrum.resize( fft_->NumberOfBins() );
+
+    // Transform only the blocks that contain occupied bins.
+    std::size_t k = 0;
+    while ( k != numOccupied ) {
+      const int begin = ( bins[k] / block_length_ ) * block_length_;
+      const int end = std::min( begin + block_length_, size_waveform_ );
+      std::fill( buffer.begin(), buffer.end(), 0. );
+      for ( ; k != numOccupied  &&  bins[k] < end; k++ )
+	buffer[ bins[k] - begin ] = counts[k];
+      m_ConvoluteBlock( begin, end, buffer, spectrum, output_waveform );
+    }
+  }
+
 } // namespace gramselecsim
@@ -103,6 +103,12 @@ namespace gramsg4 {
     grams::MCTrackList* m_mcTrackList;
     grams::MCLArHits*   m_mcLArHits;
     grams::MCScintHits* m_mcScintHits;
+
+    // If the flatDataProducts option is on, the hits are written in
+    // these containers instead of the two above.
+    bool                    m_flatDataProducts;
+    grams::FlatMCLArHits*   m_flatLArHits;
+    grams::FlatMCScintHits* m_flatScintHits;
   };
 
 } // namespace gramsg4
@@ -66,6 +66,8 @@ namespace gramsg4 {
     , m_mcTrackList(nullptr)
     , m_mcLArHits(nullptr)
     , m_mcScintHits(nullptr)
+    , m_flatLArHits(nullptr)
+    , m_flatScintHits(nullptr)
   {
     // Fetch the units from the Options XML file.
     m_options = util::Options::GetInstance();
@@ -93,6 +95,9 @@ namespace gramsg4 {
     // create.
     m_options->GetOption("outputG4File",m_filename);
     m_options->GetOption("outputG4Tree",m_treeName);
+
+    // Write the hits as std::maps or as flat vectors?
+    m_options->GetOption("flatDataProducts",m_flatDataProducts);
   }
 
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -138,8 +143,16 @@ namespace gramsg4 {
       // improves potential issues with ROOT's TBrowser.
       s_tree->Branch("EventID",  &m_eventID,     32000, 0);
       s_tree->Branch("TrackList",&m_mcTrackList, 32000, 0);
-      s_tree->Branch("LArHits",  &m_mcLArHits,   32000, 0);
-      s_tree->Branch("ScintHits",&m_mcScintHits, 32000, 0);
+      if ( m_flatDataProducts ) {
+	// The flat products are split into a column for each field;
+	// see util::ProductWriter.
+	s_tree->Branch("LArHits",  &m_flatLArHits,   32000, 99);
+	s_tree->Branch("ScintHits",&m_flatScintHits, 32000, 99);
+      }
+      else {
+	s_tree->Branch("LArHits",  &m_mcLArHits,   32000, 0);
+	s_tree->Branch("ScintHits",&m_mcScintHits, 32000, 0);
+      }
 
       // Write the options used to run this program. See
       // GramsSim/util/README.md for why we do this.
@@ -376,8 +389,20 @@ namespace gramsg4 {
 
     s_tree->SetBranchAddress("EventID",  &m_eventID);
     s_tree->SetBranchAddress("TrackList",&m_mcTrackList);
-    s_tree->SetBranchAddress("LArHits",  &m_mcLArHits);
-    s_tree->SetBranchAddress("ScintHits",&m_mcScintHits);
+    if ( m_flatDataProducts ) {
+      // The hits were collected in std::maps; copy them into the flat
+      // containers, which are in the same (key) order.
+      delete m_flatLArHits;
+      m_flatLArHits = new grams::FlatMCLArHits( *m_mcLArHits );
+      delete m_flatScintHits;
+      m_flatScintHits = new grams::FlatMCScintHits( *m_mcScintHits );
+      s_tree->SetBranchAddress("LArHits",  &m_flatLArHits);
+      s_tree->SetBranchAddress("ScintHits",&m_flatScintHits);
+    }
+    else {
+      s_tree->SetBranchAddress("LArHits",  &m_mcLArHits);
+      s_tree->SetBranchAddress("ScintHits",&m_mcScintHits);
+    }
 
     s_tree->Fill();
 
@@ -6,6 +6,7 @@
 
 // The model of the readout geometry:
 #include "AssignPixelID.h"
+#include "PixelGeometryIO.h"
 
 // For processing command-line and XML file options.
 #include "Options.h" // in util/
@@ -13,10 +14,17 @@
 // For copying and accessing the detectory geometry.
 #include "Geometry.h" // in util/
 
+// For reading and writing either std::map or flat data products.
+#include "ProductIO.h" // in util/
+
+// For processing events in parallel.
+#include "ThreadPool.h" // in util/
+
 // From GramsDataObj:
 #include "EventID.h"
 #include "ReadoutID.h"
 #include "ReadoutMap.h"
+#include "CompactReadoutMap.h"
 #include "ElectronClusters.h"
 
 // ROOT includes
@@ -24,6 +32,7 @@
 #include "TTree.h"
 #include "TTreeReader.h"
 #include "TTreeReaderValue.h"
+#include "TROOT.h"
 
 // C++ includes
 #include <iostream>
@@ -31,6 +40,7 @@
 #include <cmath>
 #include <vector>
 #include <memory>
+#include <utility>
 
 ///////////////////////////////////////
 int main(int argc,char **argv)
@@ -91,6 +101,10 @@ int main(int argc,char **argv)
   // track the history of how the files are created.
   options->CopyInputNtuple(input);
 
+  // If gramsdetsim put the charge on the pixels itself, they must be
+  // the same pixels.
+  gramsreadoutsim::CheckDepositedPixels( assignPixelID->Geometry(), input );
+
   // The standard way of reading a TTree (without using RDataFrame) in
   // C++ is using the TTreeReader.
   auto reader = new TTreeReader(inputTreeName.c_str(), input);
@@ -98,7 +112,18 @@ int main(int argc,char **argv)
   // Create a TTreeReaderValue for each column in the tree whose
   // value we'll use.
   TTreeReaderValue<grams::EventID> inputEventID      = {*reader, "EventID"};
-  TTreeReaderValue<grams::ElectronClusters> clusters = {*reader, "ElectronClusters"};
+
+  // The clusters may be stored as a std::map or a flat vector.
+  util::ProductReader<grams::FlatElectronClusters, grams::ElectronClusters>
+    clusters(*reader, "ElectronClusters");
+
+  // If gramsdetsim wrote large events in segments (see
+  // maxClustersPerSegment in options.xml), each segment is mapped on
+  // its own and keeps its segment number.
+  const bool segmented = ( reader->GetTree()->GetBranch("Segment") != nullptr );
+  std::unique_ptr< TTreeReaderValue<int> > inputSegment;
+  if ( segmented )
+    inputSegment = std::make_unique< TTreeReaderValue<int> >( *reader, "Segment" );
 
   // Now read in the options associated with the output file and tree. 
   std::string outputFileName;
@@ -130,6 +155,10 @@ int main(int argc,char **argv)
 	      << "gramsreadoutsim: geometry copied"
 	      << std::endl;
 
+  // Save the pixel geometry as well, so a later job can use this file
+  // as its pixelGeometryFile.
+  gramsreadoutsim::WritePixelGeometry( assignPixelID->Geometry(), output );
+
   // Define our output tree.
   TTree* outputTree = new TTree(outputTreeName.c_str(), "ReadoutSim");
 
@@ -141,47 +170,157 @@ int main(int argc,char **argv)
   // make it easier for them to be friends.
 
   auto eventID = new grams::EventID();
-  auto readoutMap = new grams::ReadoutMap();
   // By experimenting, it turns out that setting the splitlevel to 0
   // improves potential issues with ROOT's TBrowser.
   outputTree->Branch("EventID",    &eventID,    32000, 0);
-  outputTree->Branch("ReadoutMap", &readoutMap, 32000, 0);
+
+  int segment = 0;
+  if ( segmented )
+    outputTree->Branch("Segment", &segment);
+
+  // The map is built in the flat format, and converted before each
+  // Fill() if the user wants the std::map format. If the user wants
+  // the compressed sparse row format, that's built instead, and
+  // 'readoutMap' isn't written.
+  bool flatDataProducts;
+  options->GetOption("flatDataProducts",flatDataProducts);
+  bool compact;
+  options->GetOption("compactReadoutMap",compact);
+  util::ProductWriter<grams::FlatReadoutMap, grams::ReadoutMap>
+    readoutMap(compact ? nullptr : outputTree, "ReadoutMap", flatDataProducts);
+  auto compactMap = new grams::CompactReadoutMap();
+  if ( compact )
+    outputTree->Branch("ReadoutMap", &compactMap, 32000, 0);
 
   if (verbose)
     std::cout << "gramsreadoutsim: output tree defined" << std::endl;
 
-  // For each row in the input tree:
-  while ( (*reader).Next() ) {
+  // The number of clusters that arrived outside the anode, and so
+  // weren't assigned to any readout cell.
+  size_t numberOutsideAnode = 0;
 
-    // Copy the event ID from one tree to another.
-    (*eventID) = (*inputEventID);
-    
-    // Clean out any readout data from the previous event.
-    readoutMap->clear();
+  // How many worker threads? If this is zero, process the events
+  // serially in this thread.
+  int nthreads;
+  options->GetOption("nthreads",nthreads);
+
+  if ( nthreads <= 0 ) {
+
+    // For each row in the input tree:
+    while ( (*reader).Next() ) {
+
+      // Copy the event ID from one tree to another.
+      (*eventID) = (*inputEventID);
+      if ( segmented )
+	segment = *(*inputSegment);
     
-    for ( const auto& [ ckey, cluster ] : (*clusters) ) {
+      // Assign each cluster to a readout cell. This replaces any
+      // readout data from the previous event.
+      if ( compact )
+	assignPixelID->Assign( *clusters, *compactMap );
+      else {
+	assignPixelID->Assign( *clusters, *readoutMap );
+	readoutMap.Prepare();
+      }
 
-      // Assign a pixel readout ID to each cluster.
-      const grams::ReadoutID readoutID
-	= assignPixelID->Assign(cluster);
-      
-      // We're using C++ STL structures in two different ways
-      // here. For the key (ReadoutID) in ReadoutMap, using a map's
-      // operator[] notation; this is because we will add many cluster
-      // keys for every readoutID. For the list that the map points
-      // to, use the insert function to expand that list.
-      (*readoutMap)[ readoutID ].insert( ckey );
-    }
+      // Add a row to the output tree.
+      outputTree->Fill();
 
-    // Add a row to the output tree.
-    outputTree->Fill();
+    } // For each event
 
-  } // For each event
+    numberOutsideAnode = assignPixelID->NumberOutsideAnode();
+  }
+  else {
+
+    // Multi-threaded processing, as in gramsdetsim: this thread
+    // reads a batch of rows, the workers assign the clusters of
+    // each row to readout cells, then this thread writes the batch
+    // in its original order. There are no random numbers involved,
+    // so the output is identical to that of a serial job.
+
+    // Tell ROOT that it's going to be used by more than one thread.
+    ROOT::EnableThreadSafety();
+
+    if (verbose)
+      std::cout << "gramsreadoutsim: processing events with "
+		<< nthreads << " threads" << std::endl;
+
+    // Each worker gets its own copy of the pixel assignment, since
+    // AssignPixelID keeps work space between events. The copies are
+    // made from the one that's already set up, so the geometry file
+    // is only read once.
+    std::vector< gramsreadoutsim::AssignPixelID > assigners( nthreads, *assignPixelID );
+
+    // Each batch holds a few events per thread, to keep the workers
+    // busy if some events take longer than others.
+    const size_t batchSize = 8 * nthreads;
+    std::vector< grams::EventID > batchEventIDs( batchSize );
+    std::vector< int > batchSegments( batchSize, 0 );
+    std::vector< grams::FlatElectronClusters > batchClusters( batchSize );
+    std::vector< grams::FlatReadoutMap > batchReadoutMaps( compact ? 0 : batchSize );
+    std::vector< grams::CompactReadoutMap > batchCompactMaps( compact ? batchSize : 0 );
+
+    util::ThreadPool pool(nthreads);
+
+    bool moreEvents = true;
+    while ( moreEvents ) {
+
+      // Read the next batch of events.
+      size_t numberInBatch = 0;
+      while ( numberInBatch < batchSize ) {
+	moreEvents = (*reader).Next();
+	if ( ! moreEvents ) break;
+
+	batchEventIDs[ numberInBatch ] = (*inputEventID);
+	if ( segmented )
+	  batchSegments[ numberInBatch ] = *(*inputSegment);
+	// Swapping avoids copying the clusters. The reader will
+	// clear out whatever we swapped into it before it reads the
+	// next entry.
+	std::swap( batchClusters[ numberInBatch ], (*clusters) );
+	++numberInBatch;
+      }
+
+      // Assign the clusters of each event in the batch.
+      pool.ParallelFor( numberInBatch, [&](size_t i, int thread) {
+	  if ( compact )
+	    assigners[thread].Assign( batchClusters[i], batchCompactMaps[i] );
+	  else
+	    assigners[thread].Assign( batchClusters[i], batchReadoutMaps[i] );
+	});
+
+      // Write the batch in input order.
+      for ( size_t i = 0; i != numberInBatch; ++i ) {
+	(*eventID) = batchEventIDs[i];
+	segment = batchSegments[i];
+	if ( compact )
+	  std::swap( *compactMap, batchCompactMaps[i] );
+	else {
+	  std::swap( *readoutMap, batchReadoutMaps[i] );
+	  readoutMap.Prepare();
+	}
+	outputTree->Fill();
+      }
+
+    } // for each batch of events
+
+    for ( const auto& assigner : assigners )
+      numberOutsideAnode += assigner.NumberOutsideAnode();
+  }
+
+  if ( numberOutsideAnode > 0 )
+    std::cout << "gramsreadoutsim: " << numberOutsideAnode
+	      << " cluster(s) arrived outside the anode and were not assigned to a readout cell"
+	      << std::endl;
 
   // Build an index for this tree. This will allow downstream
   // programs to quickly access a given EventID within the tree.
-  outputTree->BuildIndex("EventID.Index()");
+  if ( segmented )
+    outputTree->BuildIndex("EventID.Index()","Segment");
+  else
+    outputTree->BuildIndex("EventID.Index()");
 
   outputTree->Write();
   output->Close();
+  delete compactMap;
 }
@@ -0,0 +1,79 @@
+// 16-Oct-2026
+
+// The pixel grid of each anode tile, in the form used to assign
+// positions to pixels. It's built from a grams::PixelGeometry, and
+// shared by AssignPixelID and by gramsdetsim's
+// AnalyticDiffusionModel, so that the charge deposited on the pixels
+// by the latter lands on the pixels found by the former.
+
+// The pixel boundaries of a tile are at (offsetX + k*pitchX) along x
+// for every integer k, and likewise along y; the pixel with index k
+// extends from boundary k to boundary k+1.
+
+#ifndef AnodeGrid_h
+#define AnodeGrid_h
+
+// From GramsDataObj
+#include "PixelGeometry.h"
+
+#include "AnodeTileIndex.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace gramsreadoutsim {
+
+  class AnodeGrid
+  {
+  public:
+
+    // The variables that define the pixel grid of a tile: the
+    // center of the tile (including the readout center), the pixel
+    // pitches and their reciprocals, and the edges of the tile in
+    // units of pixels from the center.
+    struct Tile {
+      double offsetX;
+      double offsetY;
+      double pitchX;
+      double pitchY;
+      double recipX;
+      double recipY;
+      double edgeX;
+      double edgeY;
+    };
+
+    AnodeGrid() {}
+    explicit AnodeGrid(const grams::PixelGeometry& geometry);
+
+    // The number of tiles, and tile number 't'.
+    std::size_t size() const { return m_tiles.size(); }
+    const Tile& operator[](std::size_t a_t) const { return m_tiles[a_t]; }
+
+    // The tiles that might contain (x,y); see AnodeTileIndex. This
+    // is only meaningful if there's more than one tile.
+    AnodeTileIndex::Candidates Candidates(double a_x, double a_y) const
+    {
+      return m_tileIndex.Find( a_x, a_y );
+    }
+
+    // Is (x,y) on tile 't'?
+    bool Contains(std::size_t t, double x, double y) const;
+
+    // The tile that contains (x,y). If no tile does, the nearest
+    // one; every tile is searched in that case, so it's slower.
+    std::size_t NearestTile(double x, double y) const;
+
+    // For diagnostics; see AnodeTileIndex.
+    const AnodeTileIndex& Index() const { return m_tileIndex; }
+
+  private:
+
+    std::vector< Tile > m_tiles;
+
+    // Used to find the tile when there's more than one.
+    AnodeTileIndex m_tileIndex;
+  };
+
+} // namespace gramsreadoutsim
+
+#endif // AnodeGrid_h
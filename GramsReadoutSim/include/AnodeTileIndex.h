@@ -0,0 +1,96 @@
+// 16-Oct-2026
+
+// Find the anode tile(s) that might contain a point, in a time that
+// doesn't depend on the number of tiles.
+
+// The area covered by the tiles is divided into a uniform grid of
+// cells, roughly the size of a typical tile. Each cell has a list of
+// the tiles that overlap it. To look up a point, compute its cell
+// from its coordinates (a subtraction and a multiplication per axis),
+// then test the few tiles in that cell's list. The lists are stored
+// one after another in a single vector, in the same compressed sparse
+// row form as grams::CompactReadoutMap.
+
+#ifndef AnodeTileIndex_h
+#define AnodeTileIndex_h
+
+#include <vector>
+#include <cstddef>
+
+namespace gramsreadoutsim {
+
+  class AnodeTileIndex
+  {
+  public:
+
+    // The extent of one tile: x from minX to maxX, y from minY to
+    // maxY.
+    struct Box {
+      double minX;
+      double maxX;
+      double minY;
+      double maxY;
+    };
+
+    // A list of tile numbers; see Find() below.
+    class Candidates {
+    public:
+      Candidates(const int* a_begin, const int* a_end)
+	: m_begin(a_begin), m_end(a_end) {}
+      const int* begin() const { return m_begin; }
+      const int* end() const { return m_end; }
+      std::size_t size() const { return m_end - m_begin; }
+      bool empty() const { return m_begin == m_end; }
+    private:
+      const int* m_begin;
+      const int* m_end;
+    };
+
+    AnodeTileIndex() {}
+
+    // Index the tiles. Tile number i is boxes[i]. Any previous
+    // contents are discarded.
+    void Build(const std::vector<Box>& boxes);
+
+    // The tiles that might contain (x,y), in increasing tile number.
+    // Every tile whose box contains the point is in the list; the
+    // caller has to test each one, since the list can also contain
+    // tiles that only come near it. The list is empty if the point
+    // is outside all the tiles' boxes (or isn't a number).
+    Candidates Find(double a_x, double a_y) const
+    {
+      const double fx = ( a_x - m_minX ) * m_recipX;
+      const double fy = ( a_y - m_minY ) * m_recipY;
+      if ( !( fx >= 0.  &&  fx < m_numX  &&  fy >= 0.  &&  fy < m_numY ) )
+	return Candidates( nullptr, nullptr );
+      const std::size_t cell = std::size_t(fy) * m_numX + std::size_t(fx);
+      const int* data = m_tiles.data();
+      return Candidates( data + m_offsets[cell], data + m_offsets[cell + 1] );
+    }
+
+    // For diagnostics: the number of grid cells, and the longest
+    // list of tiles in any cell.
+    std::size_t NumberOfCells() const { return std::size_t(m_numX) * m_numY; }
+    std::size_t MaxCandidates() const;
+
+  private:
+
+    // The corner of the grid, and the reciprocals of the cell sizes.
+    double m_minX = 0.;
+    double m_minY = 0.;
+    double m_recipX = 0.;
+    double m_recipY = 0.;
+
+    // The number of grid cells along each axis.
+    int m_numX = 0;
+    int m_numY = 0;
+
+    // The tiles of cell number (iy * m_numX + ix) go from
+    // m_offsets[cell] up to m_offsets[cell+1] in m_tiles.
+    std::vector< unsigned int > m_offsets;
+    std::vector< int > m_tiles;
+  };
+
+} // namespace gramsreadoutsim
+
+#endif // AnodeTileIndex_h
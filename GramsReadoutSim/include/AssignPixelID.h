@@ -5,6 +5,15 @@
 // From GramsDataObj
 #include "ReadoutID.h"
 #include "ElectronClusters.h"
+#include "ReadoutMap.h"
+#include "CompactReadoutMap.h"
+#include "PixelGeometry.h"
+
+#include "AnodeGrid.h"
+
+#include <vector>
+#include <utility>
+#include <cstddef>
 
 namespace gramsreadoutsim {
 
@@ -12,27 +21,85 @@ namespace gramsreadoutsim {
     {
     public:
 
-      // Constructor.
+      // Constructor. The pixels are those of JobPixelGeometry(); see
+      // PixelGeometryIO.h.
       AssignPixelID();
 
       // Destructor.
       virtual ~AssignPixelID();
 
-      // Accept the (x,y) positions of an electron cluster at the
-      // anode. Determine the readout cell associated with that coordinate.
+      // Accept the position of an electron cluster at the anode, and
+      // determine the readout cell associated with it. The pixels
+      // are in the two coordinates across the drift (see
+      // DriftCoordinate in options.xml and util/include/DriftAxis.h);
+      // for the default drift along z, those are (x,y). If the cluster is outside the anode, the
+      // ReadoutID is that of a pixel that doesn't exist: for an
+      // anode with one tile, its indices continue the pixel grid past
+      // the edge; for several tiles, its tile number is -1.
 
       const grams::ReadoutID Assign(const grams::ElectronCluster& ec);
 
+      // The batch version: assign the n anode positions (x[i],y[i]),
+      // in the coordinates across the drift,
+      // to pixels, and store the tile number in tile[i] and the pixel
+      // indices within the tile in pixelX[i] and pixelY[i]. If a
+      // position is outside every tile, outside[i] is set to 1 and
+      // the other values are not meaningful; otherwise outside[i] is
+      // 0. For an anode with a single tile, the loop is written so
+      // the compiler can vectorize it; otherwise each position is
+      // looked up in an AnodeTileIndex.
+      void Assign(std::size_t n, const double* x, const double* y,
+		  int* tile, int* pixelX, int* pixelY, unsigned char* outside) const;
+
+      // Assign every cluster in an event to a readout cell, and fill
+      // 'readoutMap' with the list of cluster keys for each
+      // cell. Any previous contents of 'readoutMap' are discarded.
+      void Assign(const grams::FlatElectronClusters& clusters,
+		  grams::FlatReadoutMap& readoutMap);
+
+      // The same, in the compressed sparse row form; see
+      // GramsDataObj/include/CompactReadoutMap.h.
+      void Assign(const grams::FlatElectronClusters& clusters,
+		  grams::CompactReadoutMap& readoutMap);
+
+      // Clusters that arrive outside the anode are not assigned to any
+      // readout cell. This is how many have been left out by the
+      // routines above, since this object was created.
+      std::size_t NumberOutsideAnode() const { return m_numberOutside; }
+
+      // The pixel geometry this object was constructed with, to be
+      // saved for later jobs; see PixelGeometryIO.h.
+      const grams::PixelGeometry& Geometry() const { return m_geometry; }
+
     private:
 
+      // Fill m_assignments for the clusters in an event, sorted by
+      // readout ID.
+      void m_Assign(const grams::FlatElectronClusters& clusters);
+
       bool m_verbose;
       bool m_debug;
 
-      // The variables that define the geometry of the pixel readout. 
-      double m_pixel_sizex;
-      double m_pixel_sizey;
-      double m_offset_x;
-      double m_offset_y;
+      grams::PixelGeometry m_geometry;
+
+      // The coordinates of a cluster across the drift, for the
+      // DriftCoordinate of this job.
+      void (*m_anodePosition)(const grams::ElectronCluster& cluster, double& x, double& y);
+
+      // The pixel grid of each tile, and the index used to find the
+      // tile when there's more than one.
+      AnodeGrid m_grid;
+
+      std::size_t m_numberOutside;
+
+      // Work space for m_Assign, re-used from one event to the next:
+      // the anode positions of the event's clusters, the results of
+      // the batch assignment, and the (readout ID, cluster index)
+      // pair for each cluster.
+      std::vector<double> m_x, m_y;
+      std::vector<int> m_tile, m_pixelX, m_pixelY;
+      std::vector<unsigned char> m_outside;
+      std::vector< std::pair< grams::ReadoutID, grams::CompactReadoutMap::index_type > > m_assignments;
     };
 }
 
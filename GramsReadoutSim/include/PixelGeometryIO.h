@@ -0,0 +1,46 @@
+// 16-Oct-2026
+
+// Find the pixel readout geometry for a job, either from a
+// grams::PixelGeometry saved by an earlier job or from the GDML
+// file; and save it for later jobs.
+
+#ifndef PixelGeometryIO_h
+#define PixelGeometryIO_h
+
+// From GramsDataObj
+#include "PixelGeometry.h"
+
+// ROOT includes
+#include "TDirectory.h"
+
+namespace gramsreadoutsim {
+
+  // Return the pixel geometry described by the options gdml,
+  // anodeTileVolume, multipleAnodeTiles, x_resolution, y_resolution,
+  // readout_centerx, and readout_centery. If the option
+  // pixelGeometryFile names a ROOT file that contains a PixelGeometry
+  // taken from the same GDML file and volume, the tiles come from
+  // there; otherwise the GDML file is imported and searched.
+  grams::PixelGeometry LoadPixelGeometry();
+
+  // The pixel geometry of this job: the result of
+  // LoadPixelGeometry() the first time this is called, and the same
+  // object after that. This is how gramsreadoutsim's pixel
+  // assignment and gramsdetsim's AnalyticDiffusionModel (and both of
+  // them in gramschainsim) use one description of the pixels, and
+  // import the GDML file at most once. It's safe to call from
+  // several threads.
+  const grams::PixelGeometry& JobPixelGeometry();
+
+  // Write 'geometry' to 'output' under the name "PixelGeometry".
+  void WritePixelGeometry(const grams::PixelGeometry& geometry, TDirectory* output);
+
+  // If gramsdetsim deposited the charge directly on the pixels (see
+  // AnalyticDiffusion in options.xml), it wrote the PixelGeometry it
+  // used to its output file. If 'input' is such a file, and those
+  // aren't the pixels of 'geometry', stop the job with an error.
+  void CheckDepositedPixels(const grams::PixelGeometry& geometry, TDirectory* input);
+
+} // namespace gramsreadoutsim
+
+#endif // PixelGeometryIO_h
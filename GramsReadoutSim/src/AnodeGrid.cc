@@ -0,0 +1,82 @@
+// 16-Oct-2026
+// Build the pixel grids of the anode tiles.
+
+#include "AnodeGrid.h"
+#include "AnodeTileIndex.h"
+
+// From GramsDataObj
+#include "PixelGeometry.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace gramsreadoutsim {
+
+  AnodeGrid::AnodeGrid(const grams::PixelGeometry& a_geometry)
+  {
+    // Multiplying by a reciprocal is much faster than dividing. Each
+    // tile's readout is centered on the tile's position plus the
+    // readout center, so the tile extends half its number of pixels
+    // to either side.
+    std::vector< AnodeTileIndex::Box > boxes;
+    for ( const auto& tile : a_geometry.tiles ) {
+      Tile grid;
+      grid.offsetX = tile.centerX + a_geometry.readoutCenterX;
+      grid.offsetY = tile.centerY + a_geometry.readoutCenterY;
+      grid.pitchX = tile.PitchX();
+      grid.pitchY = tile.PitchY();
+      grid.recipX = 1.0 / grid.pitchX;
+      grid.recipY = 1.0 / grid.pitchY;
+      grid.edgeX = 0.5 * static_cast<double>(tile.numPixelsX);
+      grid.edgeY = 0.5 * static_cast<double>(tile.numPixelsY);
+      m_tiles.push_back( grid );
+      boxes.push_back( { grid.offsetX - 0.5 * tile.sizeX, grid.offsetX + 0.5 * tile.sizeX,
+			 grid.offsetY - 0.5 * tile.sizeY, grid.offsetY + 0.5 * tile.sizeY } );
+    }
+
+    // A single tile doesn't need the index.
+    if ( m_tiles.size() > 1 )
+      m_tileIndex.Build( boxes );
+  }
+
+  bool AnodeGrid::Contains(std::size_t a_t, double a_x, double a_y) const
+  {
+    const auto& grid = m_tiles[a_t];
+    const double u = ( a_x - grid.offsetX ) * grid.recipX;
+    const double v = ( a_y - grid.offsetY ) * grid.recipY;
+    return u >= -grid.edgeX  &&  u < grid.edgeX  &&  v >= -grid.edgeY  &&  v < grid.edgeY;
+  }
+
+  std::size_t AnodeGrid::NearestTile(double a_x, double a_y) const
+  {
+    if ( m_tiles.size() <= 1 )
+      return 0;
+
+    // If tiles overlap, the one with the lowest number wins, as in
+    // AssignPixelID.
+    for ( const int t : m_tileIndex.Find( a_x, a_y ) )
+      if ( Contains( t, a_x, a_y ) )
+	return t;
+
+    // Otherwise, the tile with the smallest (squared) distance from
+    // the point to its edge.
+    std::size_t nearest = 0;
+    double nearestDistance = 0.;
+    for ( std::size_t t = 0; t != m_tiles.size(); ++t ) {
+      const auto& grid = m_tiles[t];
+      const double u = std::abs( a_x - grid.offsetX ) - grid.edgeX * grid.pitchX;
+      const double v = std::abs( a_y - grid.offsetY ) - grid.edgeY * grid.pitchY;
+      const double du = std::max( u, 0. );
+      const double dv = std::max( v, 0. );
+      const double distance = du*du + dv*dv;
+      if ( t == 0  ||  distance < nearestDistance ) {
+	nearest = t;
+	nearestDistance = distance;
+      }
+    }
+    return nearest;
+  }
+
+} // namespace gramsreadoutsim
@@ -0,0 +1,118 @@
+// 16-Oct-2026
+// Build the uniform grid that locates anode tiles.
+
+#include "AnodeTileIndex.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace gramsreadoutsim {
+
+  void AnodeTileIndex::Build(const std::vector<Box>& a_boxes)
+  {
+    m_offsets.clear();
+    m_tiles.clear();
+    m_numX = 0;
+    m_numY = 0;
+    if ( a_boxes.empty() ) {
+      m_offsets.push_back(0);
+      return;
+    }
+
+    // The area covered by all the tiles, and the median tile size.
+    double minX = a_boxes.front().minX;
+    double maxX = a_boxes.front().maxX;
+    double minY = a_boxes.front().minY;
+    double maxY = a_boxes.front().maxY;
+    std::vector<double> widths, heights;
+    widths.reserve( a_boxes.size() );
+    heights.reserve( a_boxes.size() );
+    for ( const auto& box : a_boxes ) {
+      minX = std::min( minX, box.minX );
+      maxX = std::max( maxX, box.maxX );
+      minY = std::min( minY, box.minY );
+      maxY = std::max( maxY, box.maxY );
+      widths.push_back( box.maxX - box.minX );
+      heights.push_back( box.maxY - box.minY );
+    }
+    const std::size_t middle = widths.size() / 2;
+    std::nth_element( widths.begin(), widths.begin() + middle, widths.end() );
+    std::nth_element( heights.begin(), heights.begin() + middle, heights.end() );
+    const double extentX = maxX - minX;
+    const double extentY = maxY - minY;
+
+    // With cells the size of a typical tile, a cell overlaps at most
+    // four tiles that don't overlap each other. If the tiles vary a
+    // lot in size, limit the number of cells to a multiple of the
+    // number of tiles, so the memory stays proportional to the
+    // number of tiles.
+    double numX = ( widths[middle] > 0. ) ? std::ceil( extentX / widths[middle] ) : 1.;
+    double numY = ( heights[middle] > 0. ) ? std::ceil( extentY / heights[middle] ) : 1.;
+    numX = std::max( numX, 1. );
+    numY = std::max( numY, 1. );
+    const double maxCells = 16. * double( a_boxes.size() ) + 16.;
+    if ( numX * numY > maxCells ) {
+      const double scale = std::sqrt( maxCells / ( numX * numY ) );
+      numX = std::max( std::floor( numX * scale ), 1. );
+      numY = std::max( std::floor( numY * scale ), 1. );
+    }
+    m_numX = int(numX);
+    m_numY = int(numY);
+    m_minX = minX;
+    m_minY = minY;
+    m_recipX = ( extentX > 0. ) ? numX / extentX : 0.;
+    m_recipY = ( extentY > 0. ) ? numY / extentY : 0.;
+
+    // The range of cells covered by a box. It's widened a little, so
+    // that a point that rounds to just outside a tile's edge when the
+    // caller tests it is still listed in the right cell.
+    auto cellRange = [&]( double a_min, double a_max, double a_corner,
+			  double a_recip, int a_num, int& a_first, int& a_last )
+    {
+      const double pad = 1.e-6 * ( a_max - a_min );
+      a_first = int( std::floor( ( a_min - pad - a_corner ) * a_recip ) );
+      a_last  = int( std::floor( ( a_max + pad - a_corner ) * a_recip ) );
+      a_first = std::min( std::max( a_first, 0 ), a_num - 1 );
+      a_last  = std::min( std::max( a_last,  0 ), a_num - 1 );
+    };
+
+    // Two passes: count the tiles in each cell, then fill in the
+    // lists. Since the tiles are visited in order, each cell's list
+    // is in increasing tile number.
+    const std::size_t numCells = NumberOfCells();
+    std::vector< unsigned int > counts( numCells + 1, 0 );
+    for ( int pass = 0; pass != 2; ++pass ) {
+      for ( std::size_t t = 0; t != a_boxes.size(); ++t ) {
+	const auto& box = a_boxes[t];
+	int firstX, lastX, firstY, lastY;
+	cellRange( box.minX, box.maxX, m_minX, m_recipX, m_numX, firstX, lastX );
+	cellRange( box.minY, box.maxY, m_minY, m_recipY, m_numY, firstY, lastY );
+	for ( int iy = firstY; iy <= lastY; ++iy )
+	  for ( int ix = firstX; ix <= lastX; ++ix ) {
+	    const std::size_t cell = std::size_t(iy) * m_numX + ix;
+	    if ( pass == 0 )
+	      ++counts[cell + 1];
+	    else
+	      m_tiles[ counts[cell]++ ] = int(t);
+	  }
+      }
+      if ( pass == 0 ) {
+	for ( std::size_t cell = 0; cell != numCells; ++cell )
+	  counts[cell + 1] += counts[cell];
+	m_offsets = counts;
+	m_tiles.resize( counts[numCells] );
+      }
+    }
+  }
+
+  std::size_t AnodeTileIndex::MaxCandidates() const
+  {
+    std::size_t result = 0;
+    for ( std::size_t cell = 0; cell + 1 < m_offsets.size(); ++cell )
+      result = std::max( result, std::size_t( m_offsets[cell + 1] - m_offsets[cell] ) );
+    return result;
+  }
+
+} // namespace gramsreadoutsim
@@ -3,20 +3,33 @@
 // From GramsDataObj
 #include "ReadoutID.h"
 #include "ElectronClusters.h"
+#include "ReadoutMap.h"
+#include "CompactReadoutMap.h"
+#include "PixelGeometry.h"
 
+#include "PixelGeometryIO.h"
 #include "Options.h"
+#include "DriftAxis.h" // in util/
 
 #include <iostream>
 #include <cmath>
 #include <cassert>
-#include <TGeoManager.h>
-#include <TGeoVolume.h>
-#include <TGeoBBox.h>
-#include <TString.h>
-#include <TRegexp.h>
+#include <algorithm>
+#include <vector>
 
 namespace gramsreadoutsim {
 
+  // The position of a cluster in the anode plane: its two
+  // coordinates across the drift.
+  template <int Axis>
+  static void AnodePosition(const grams::ElectronCluster& a_cluster, double& a_x, double& a_y)
+  {
+    using Drift = util::DriftAxis<Axis>;
+    const auto position = a_cluster.PositionAtAnode4D();
+    a_x = Drift::Across1( position );
+    a_y = Drift::Across2( position );
+  }
+
   AssignPixelID::AssignPixelID()
   {
     auto options = util::Options::GetInstance();
@@ -24,89 +37,31 @@ namespace gramsreadoutsim {
     options->GetOption("verbose",     m_verbose);
     options->GetOption("debug",       m_debug);
 
-    // Avoid pointless ROOT geometry information messages. 
-    if (m_debug || m_verbose)
-      gGeoManager->SetVerboseLevel(1);
-    else
-      gGeoManager->SetVerboseLevel(0); // avoid pointless Info messages
-
-    // Get the gdml file that was reformatted by GramsG4, and load
-    // Geometry, and the volume of the anode plane,
-    std::string GramsG4_gdml;
-    options->GetOption("gdml",GramsG4_gdml);
-    std::string anodeTileVolume;
-    options->GetOption("anodeTileVolume",anodeTileVolume);
-
-    auto geom = TGeoManager::Import(GramsG4_gdml.c_str());
-
-    // get the top level volume of the bounding volume hierarchy so that you can find the AnodePlane volume
-    TGeoVolume* startVol = geom->GetTopVolume();
-
-    // Construct a (very simple) Regex expression to try and pattern
-    // match the bounding box names you encounter as you traverse the
-    // hierarchy
-    TString volName = anodeTileVolume;
-    TRegexp searchFor(volName);
-
-    // construct an interator around the top level volume
-    TGeoIterator next(startVol);
-
-    // the current Node in the tree that you will be traversing
-    TGeoNode* current;
-
-    // Place to store the name of the current node
-    TString nodePath;
-
-    // output x/y extend of the Anode Plane
-    double AnodePlaneXLength  = -1;
-    double AnodePlaneYLength  = -1;
-
-    // Run through the geometry tree structure via the iterator
-    while ((current= next())) {
-      // grab the node name
-      next.GetPath(nodePath);
-      // if the volume contains the regex expression...
-      if (nodePath.Contains(searchFor)) {
-        // Grab the bounding box of the Anode Plane (which for Grams,
-        // just coincides with the Tile since it is just a
-        // parallelpiped)
-        auto volume = current->GetVolume();
-        auto box = dynamic_cast<TGeoBBox*>(volume->GetShape());
-        // GetDX() gets half width along the X axis, so multiply by 2 to get full width
-        AnodePlaneXLength = box->GetDX() * 2.0;
-        AnodePlaneYLength = box->GetDY() * 2.0;
-        break;
-      } // volume found
-    } // loop over volumes in the geometry
-
-    // PANIC if the dimensions aren't physical
-    if(AnodePlaneXLength<=0 || AnodePlaneYLength<=0){
-      std::cerr << std::endl
-		<< "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
-		<< "GramsReadoutSim::AssignPixelID: Could not find volume '" << anodeTileVolume << "'" 
-		<< " in '" <<  GramsG4_gdml << "'." << " Check anodeTileVolume value"
-		<< std::endl;
-      exit(EXIT_FAILURE);
-    }
+    // The tiles come from either a saved PixelGeometry or the GDML
+    // file; how they're divided into pixels, and the readout center,
+    // come from the options. It's the same geometry that gramsdetsim
+    // uses if it deposits the charge on the pixels.
+    m_geometry = JobPixelGeometry();
+    m_grid = AnodeGrid( m_geometry );
 
-    // Get the pixel geometry options from the XML file/command line.
-    options->GetOption("readout_centerx",    m_offset_x);
-    options->GetOption("readout_centery",    m_offset_y);
-
-    int x_resolution;
-    int y_resolution;
-    options->GetOption("x_resolution", x_resolution);
-    options->GetOption("y_resolution", y_resolution);
-    if(x_resolution<=0 || y_resolution<=0){
-      std::cerr << std::endl
-		<< "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
-		<< "GramsReadoutSim::AssignPixelID: either x_resolution or y_resolution is not positive. "
-		<< "Check '" << GramsG4_gdml << "'"
-		<< std::endl;
-        exit(EXIT_FAILURE);
+    if ( m_grid.size() > 1  &&  m_verbose )
+      std::cout << "GramsReadOutSim::AssignPixelID() - " << m_grid.size()
+		<< " tiles indexed in " << m_grid.Index().NumberOfCells()
+		<< " grid cells, at most " << m_grid.Index().MaxCandidates()
+		<< " tiles per cell" << std::endl;
+
+    // The anode is across the drift, which is the same axis that
+    // gramsdetsim drifted the electrons along.
+    int driftAxis;
+    double driftDirection;
+    util::GetDriftAxisOptions(driftAxis, driftDirection);
+    switch (driftAxis) {
+    case 0:  m_anodePosition = &AnodePosition<0>; break;
+    case 1:  m_anodePosition = &AnodePosition<1>; break;
+    default: m_anodePosition = &AnodePosition<2>; break;
     }
-    m_pixel_sizex = AnodePlaneXLength/static_cast<double>(x_resolution);
-    m_pixel_sizey = AnodePlaneYLength/static_cast<double>(y_resolution);
+
+    m_numberOutside = 0;
 
     if (m_verbose) {
       std::cout << "GramsReadOutSim::AssignPixelID() - initialized" << std::endl;
@@ -115,29 +70,190 @@ namespace gramsreadoutsim {
   
   AssignPixelID::~AssignPixelID() {}
 
-  // Accept the (x,y) position of the electron cluster at the
-  // anode. Determine its (x,y) pixel ID numbers.
+  // Accept the position of the electron cluster at the anode.
+  // Determine its (x,y) pixel ID numbers.
   
   const grams::ReadoutID AssignPixelID::Assign(const grams::ElectronCluster& cluster) 
   {
-    int pixel_idx = std::floor((cluster.XAtAnode() - m_offset_x) / m_pixel_sizex);
-    int pixel_idy = std::floor((cluster.YAtAnode() - m_offset_y) / m_pixel_sizey);
+    double x, y;
+    m_anodePosition( cluster, x, y );
+    int tile;
+    int pixel_idx;
+    int pixel_idy;
+    unsigned char outside;
+    Assign( 1, &x, &y, &tile, &pixel_idx, &pixel_idy, &outside );
+
+    // Outside the anode, keep the index that the position would have
+    // if the pixel grid of the first tile continued past the edge.
+    if ( outside ) {
+      const auto& grid = m_grid[0];
+      pixel_idx = std::floor((x - grid.offsetX) * grid.recipX);
+      pixel_idy = std::floor((y - grid.offsetY) * grid.recipY);
+      tile = ( m_grid.size() == 1 ) ? 0 : -1;
+    }
    
     if (m_debug) {
       std::cout << "gramsreadoutsim::AssignPixelID - "
-		<< " m_offset_x=" << m_offset_x
-		<< " m_offset_y=" << m_offset_y
-		<< " m_pixel_sizex=" << m_pixel_sizex
-		<< " m_pixel_sizey=" << m_pixel_sizey
-		<< std::endl
-		<< " cluster.XAtAnode()=" << cluster.XAtAnode()
-		<< " cluster.YAtAnode()=" << cluster.YAtAnode()
+		<< " anode position=(" << x << "," << y << ")"
+		<< " tile=" << tile
 		<< " pixel_idx=" << pixel_idx
 		<< " pixel_idy=" << pixel_idy
 		<< std::endl;
     }    
  
-    return grams::ReadoutID(pixel_idx, pixel_idy);
+    return grams::ReadoutID(pixel_idx, pixel_idy, tile);
+  }
+
+  // Truncating a double to an int rounds towards zero. This rounds
+  // towards minus infinity like std::floor, but without a function
+  // call, so a loop that uses it can be vectorized.
+  static inline int FloorToInt(double a_value)
+  {
+    const int truncated = static_cast<int>(a_value);
+    return truncated - ( static_cast<double>(truncated) > a_value );
+  }
+
+  // Assign n positions to the pixels of a single tile.
+  static void AssignToGrid(std::size_t a_n, const double* a_x, const double* a_y,
+			   double offsetX, double offsetY,
+			   double recipX, double recipY,
+			   double edgeX, double edgeY,
+			   int* a_pixelX, int* a_pixelY, unsigned char* a_outside)
+  {
+    for ( std::size_t i = 0; i < a_n; ++i ) {
+      // The position in units of pixels from the center of the tile.
+      const double u = ( a_x[i] - offsetX ) * recipX;
+      const double v = ( a_y[i] - offsetY ) * recipY;
+
+      // A position that isn't a number counts as outside. The
+      // operators are & rather than &&, which would introduce a
+      // branch.
+      const bool inX = ( u >= -edgeX ) & ( u < edgeX );
+      const bool inY = ( v >= -edgeY ) & ( v < edgeY );
+      a_outside[i] = !( inX & inY );
+
+      // Clamp the position to the tile before converting it, so the
+      // conversion can't overflow. The argument order of std::max
+      // maps a NaN to the edge.
+      const double cu = std::min( std::max( -edgeX, u ), edgeX );
+      const double cv = std::min( std::max( -edgeY, v ), edgeY );
+      a_pixelX[i] = FloorToInt( cu );
+      a_pixelY[i] = FloorToInt( cv );
+    }
+  }
+
+  void AssignPixelID::Assign(std::size_t a_n, const double* a_x, const double* a_y,
+			     int* a_tile, int* a_pixelX, int* a_pixelY,
+			     unsigned char* a_outside) const
+  {
+    if ( m_grid.size() == 1 ) {
+      const auto& grid = m_grid[0];
+      AssignToGrid( a_n, a_x, a_y,
+		    grid.offsetX, grid.offsetY, grid.recipX, grid.recipY, grid.edgeX, grid.edgeY,
+		    a_pixelX, a_pixelY, a_outside );
+      std::fill( a_tile, a_tile + a_n, 0 );
+      return;
+    }
+
+    // With several tiles, find the tile first. If tiles overlap, the
+    // one with the lowest number wins.
+    for ( std::size_t i = 0; i < a_n; ++i ) {
+      a_tile[i] = -1;
+      a_pixelX[i] = 0;
+      a_pixelY[i] = 0;
+      a_outside[i] = 1;
+      for ( const int t : m_grid.Candidates( a_x[i], a_y[i] ) ) {
+	const auto& grid = m_grid[t];
+	AssignToGrid( 1, a_x + i, a_y + i,
+		      grid.offsetX, grid.offsetY, grid.recipX, grid.recipY, grid.edgeX, grid.edgeY,
+		      a_pixelX + i, a_pixelY + i, a_outside + i );
+	if ( ! a_outside[i] ) {
+	  a_tile[i] = t;
+	  break;
+	}
+      }
+    }
+  }
+
+  void AssignPixelID::m_Assign(const grams::FlatElectronClusters& a_clusters)
+  {
+    m_assignments.clear();
+
+    // Copy the anode positions into arrays for the batch
+    // assignment. resize() only allocates memory if an event has
+    // more clusters than any before it.
+    const std::size_t n = a_clusters.size();
+    m_x.resize(n);
+    m_y.resize(n);
+    m_tile.resize(n);
+    m_pixelX.resize(n);
+    m_pixelY.resize(n);
+    m_outside.resize(n);
+    std::size_t i = 0;
+    for ( const auto& [ ckey, cluster ] : a_clusters ) {
+      m_anodePosition( cluster, m_x[i], m_y[i] );
+      ++i;
+    }
+
+    Assign( n, m_x.data(), m_y.data(), m_tile.data(),
+	    m_pixelX.data(), m_pixelY.data(), m_outside.data() );
+
+    // The clusters were copied in key order, so a cluster's position
+    // in the arrays is its index in the event's list of clusters.
+    for ( i = 0; i != n; ++i ) {
+      if ( m_outside[i] ) {
+	if (m_debug) {
+	  std::cout << "gramsreadoutsim::AssignPixelID - cluster at"
+		    << " x=" << m_x[i] << " y=" << m_y[i]
+		    << " is outside the anode" << std::endl;
+	}
+	++m_numberOutside;
+	continue;
+      }
+      m_assignments.emplace_back( grams::ReadoutID( m_pixelX[i], m_pixelY[i], m_tile[i] ),
+				  grams::CompactReadoutMap::index_type(i) );
+    }
+
+    // Group the clusters by readout ID. The sort is stable, so
+    // within each readout ID the clusters stay in key order. That
+    // means every insertion in the routines below appends to the
+    // end of a flat container, with no searching or shifting of
+    // elements.
+    std::stable_sort( m_assignments.begin(), m_assignments.end(),
+		      []( const auto& a, const auto& b ) { return a.first < b.first; } );
+  }
+
+  void AssignPixelID::Assign(const grams::FlatElectronClusters& a_clusters,
+			     grams::FlatReadoutMap& a_readoutMap)
+  {
+    a_readoutMap.clear();
+    m_Assign( a_clusters );
+
+    for ( const auto& [ readoutID, index ] : m_assignments ) {
+      // We're using C++ STL structures in two different ways
+      // here. For the key (ReadoutID) in ReadoutMap, using a map's
+      // operator[] notation; this is because we will add many cluster
+      // keys for every readoutID. For the list that the map points
+      // to, use the insert function to expand that list.
+      const auto& ckey = ( a_clusters.cbegin() + index )->first;
+      a_readoutMap[ readoutID ].insert( ckey );
+    }
+  }
+
+  void AssignPixelID::Assign(const grams::FlatElectronClusters& a_clusters,
+			     grams::CompactReadoutMap& a_readoutMap)
+  {
+    a_readoutMap.clear();
+    m_Assign( a_clusters );
+
+    a_readoutMap.reserve( 0, m_assignments.size() );
+    for ( std::size_t i = 0; i != m_assignments.size(); ++i ) {
+      const auto& [ readoutID, index ] = m_assignments[i];
+      // Start a new cell whenever the readout ID changes.
+      if ( i == 0  ||  !( m_assignments[i-1].first == readoutID ) )
+	a_readoutMap.AddCell( readoutID );
+      a_readoutMap.AddCluster( index );
+    }
   }
   
 } // namespace gramsreadoutsim
@@ -0,0 +1,287 @@
+// 16-Oct-2026
+// Load and save the pixel readout geometry.
+
+#include "PixelGeometryIO.h"
+
+// From GramsDataObj
+#include "PixelGeometry.h"
+
+#include "Options.h" // in util/
+#include "DriftAxis.h" // in util/
+
+// ROOT includes
+#include "TFile.h"
+#include "TDirectory.h"
+#include "TGeoManager.h"
+#include "TGeoVolume.h"
+#include "TGeoBBox.h"
+#include "TGeoMatrix.h"
+#include "TString.h"
+#include "TRegexp.h"
+
+// C++ includes
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gramsreadoutsim {
+
+  // Import the GDML file and find the volumes whose paths match
+  // 'anodeVolume'. If 'multipleTiles' is false, stop at the first
+  // one and center it at (0,0); otherwise make a tile for every
+  // placement, at its position in the geometry. The tiles' "X" and
+  // "Y" are the coordinates across the axis 'driftAxis'.
+  static void FindAnodeTiles(const std::string& a_gdmlFile,
+			     const std::string& a_anodeVolume,
+			     bool a_multipleTiles,
+			     int a_driftAxis,
+			     bool a_verbose,
+			     std::vector<grams::AnodeTile>& a_tiles)
+  {
+    // Avoid pointless ROOT geometry information messages.
+    if (a_verbose)
+      gGeoManager->SetVerboseLevel(1);
+    else
+      gGeoManager->SetVerboseLevel(0); // avoid pointless Info messages
+
+    auto geom = TGeoManager::Import(a_gdmlFile.c_str());
+
+    // get the top level volume of the bounding volume hierarchy so that you can find the AnodePlane volume
+    TGeoVolume* startVol = geom->GetTopVolume();
+
+    // Construct a (very simple) Regex expression to try and pattern
+    // match the bounding box names you encounter as you traverse the
+    // hierarchy
+    TString volName = a_anodeVolume;
+    TRegexp searchFor(volName);
+
+    // construct an interator around the top level volume
+    TGeoIterator next(startVol);
+
+    // the current Node in the tree that you will be traversing
+    TGeoNode* current;
+
+    // Place to store the name of the current node
+    TString nodePath;
+
+    a_tiles.clear();
+
+    // The two world axes across the drift, in the order of
+    // util::DriftAxis.
+    const int across1 = ( a_driftAxis + 1 ) % 3;
+    const int across2 = ( a_driftAxis + 2 ) % 3;
+
+    // Run through the geometry tree structure via the iterator
+    while ((current= next())) {
+      // grab the node name
+      next.GetPath(nodePath);
+      // if the volume contains the regex expression...
+      if (nodePath.Contains(searchFor)) {
+        // Grab the bounding box of the Anode Plane (which for Grams,
+        // just coincides with the Tile since it is just a
+        // parallelpiped)
+        auto volume = current->GetVolume();
+        auto box = dynamic_cast<TGeoBBox*>(volume->GetShape());
+	grams::AnodeTile tile;
+        // GetDX() gets half width along the X axis, so multiply by 2 to get full width
+	const double halfWidth[3] = { box->GetDX(), box->GetDY(), box->GetDZ() };
+        tile.sizeX = halfWidth[across1] * 2.0;
+        tile.sizeY = halfWidth[across2] * 2.0;
+	if ( ! a_multipleTiles ) {
+	  a_tiles.push_back( tile );
+	  break;
+	}
+
+	// The center of the box in the world's coordinates. The tiles
+	// are assumed not to be rotated in the anode plane.
+	double center[3];
+	next.GetCurrentMatrix()->LocalToMaster( box->GetOrigin(), center );
+	tile.centerX = center[across1];
+	tile.centerY = center[across2];
+	a_tiles.push_back( tile );
+
+	// The paths of the volumes inside the tile also match; don't
+	// look at them.
+	next.Skip();
+      } // volume found
+    } // loop over volumes in the geometry
+  }
+
+  // The size and 64-bit FNV-1a hash of the contents of a file, to
+  // tell whether a saved descriptor was made from the same GDML. Both
+  // are 0 if the file can't be read. Reading the file is much faster
+  // than having ROOT import it.
+  static void FileFingerprint(const std::string& a_file,
+			      std::uint64_t& a_size, std::uint64_t& a_hash)
+  {
+    a_size = 0;
+    a_hash = 0;
+    std::ifstream input( a_file, std::ios::binary );
+    if ( ! input )
+      return;
+
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    std::uint64_t size = 0;
+    std::vector<char> buffer( 1 << 16 );
+    while ( input ) {
+      input.read( buffer.data(), buffer.size() );
+      const std::streamsize n = input.gcount();
+      for ( std::streamsize i = 0; i != n; ++i ) {
+	hash ^= static_cast<unsigned char>( buffer[i] );
+	hash *= 0x100000001b3ULL;
+      }
+      size += n;
+    }
+    a_size = size;
+    a_hash = hash;
+  }
+
+  grams::PixelGeometry LoadPixelGeometry()
+  {
+    auto options = util::Options::GetInstance();
+
+    bool verbose, debug;
+    options->GetOption("verbose", verbose);
+    options->GetOption("debug",   debug);
+
+    // Get the gdml file that was reformatted by GramsG4, and the
+    // volume of the anode plane.
+    std::string GramsG4_gdml;
+    options->GetOption("gdml",GramsG4_gdml);
+    std::string anodeTileVolume;
+    options->GetOption("anodeTileVolume",anodeTileVolume);
+
+    // Use every placement of that volume as a tile?
+    bool multipleTiles;
+    options->GetOption("multipleAnodeTiles",multipleTiles);
+
+    grams::PixelGeometry geometry;
+    geometry.gdmlFile = GramsG4_gdml;
+    FileFingerprint( GramsG4_gdml, geometry.gdmlSize, geometry.gdmlHash );
+    geometry.anodeVolume = anodeTileVolume;
+    geometry.multipleTiles = multipleTiles;
+
+    // The anode is in the plane across the drift.
+    double driftDirection;
+    util::GetDriftAxisOptions(geometry.driftCoordinate, driftDirection);
+
+    // Look for a saved descriptor.
+    bool found = false;
+    std::string pixelGeometryFile;
+    options->GetOption("pixelGeometryFile",pixelGeometryFile);
+    if ( ! pixelGeometryFile.empty() ) {
+      auto file = std::unique_ptr<TFile>( TFile::Open(pixelGeometryFile.c_str()) );
+      if ( file  &&  ! file->IsZombie() ) {
+	auto saved = std::unique_ptr<grams::PixelGeometry>( file->Get<grams::PixelGeometry>("PixelGeometry") );
+	if ( saved  &&  saved->Matches(GramsG4_gdml, geometry.gdmlSize, geometry.gdmlHash,
+						anodeTileVolume, multipleTiles,
+						geometry.driftCoordinate) ) {
+	  geometry.tiles = saved->tiles;
+	  found = true;
+	}
+      }
+      if ( found ) {
+	if (verbose || debug)
+	  std::cout << "gramsreadoutsim::LoadPixelGeometry - using the anode tiles saved in '"
+		    << pixelGeometryFile << "'" << std::endl;
+      }
+      else
+	std::cout << "gramsreadoutsim::LoadPixelGeometry - '" << pixelGeometryFile
+		  << "' does not contain a PixelGeometry for volume '" << anodeTileVolume
+		  << "' in the current '" << GramsG4_gdml << "'; reading the GDML file instead"
+		  << std::endl;
+    }
+
+    if ( ! found )
+      FindAnodeTiles( GramsG4_gdml, anodeTileVolume, multipleTiles, geometry.driftCoordinate,
+		      verbose || debug, geometry.tiles );
+
+    // PANIC if the dimensions aren't physical
+    bool physical = ! geometry.tiles.empty();
+    for ( const auto& tile : geometry.tiles )
+      if ( !( tile.sizeX > 0 )  ||  !( tile.sizeY > 0 ) )
+	physical = false;
+    if ( ! physical ) {
+      std::cerr << std::endl
+		<< "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "GramsReadoutSim::AssignPixelID: Could not find volume '" << anodeTileVolume << "'"
+		<< " in '" <<  GramsG4_gdml << "'." << " Check anodeTileVolume value"
+		<< std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    // The division of each tile into pixels always comes from the
+    // options, so it can be changed without going back to the GDML
+    // file. Tiles of different sizes have different pitches.
+    int x_resolution;
+    int y_resolution;
+    options->GetOption("x_resolution", x_resolution);
+    options->GetOption("y_resolution", y_resolution);
+    if ( x_resolution <= 0  ||  y_resolution <= 0 ) {
+      std::cerr << std::endl
+		<< "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "GramsReadoutSim::AssignPixelID: either x_resolution or y_resolution is not positive. "
+		<< "Check '" << GramsG4_gdml << "'"
+		<< std::endl;
+        exit(EXIT_FAILURE);
+    }
+    for ( auto& tile : geometry.tiles ) {
+      tile.numPixelsX = x_resolution;
+      tile.numPixelsY = y_resolution;
+    }
+
+    // So does the position of the readout.
+    options->GetOption("readout_centerx", geometry.readoutCenterX);
+    options->GetOption("readout_centery", geometry.readoutCenterY);
+
+    if (verbose  &&  multipleTiles)
+      std::cout << "gramsreadoutsim::LoadPixelGeometry - found " << geometry.tiles.size()
+		<< " anode tiles" << std::endl;
+
+    if (debug)
+      std::cout << geometry;
+
+    return geometry;
+  }
+
+  const grams::PixelGeometry& JobPixelGeometry()
+  {
+    // The initialization of a static local variable happens once,
+    // even if several threads get here at the same time.
+    static const grams::PixelGeometry geometry = LoadPixelGeometry();
+    return geometry;
+  }
+
+  void WritePixelGeometry(const grams::PixelGeometry& a_geometry, TDirectory* a_output)
+  {
+    // As in util::Geometry::CopyGeometry, return to the calling
+    // routine's directory afterwards.
+    auto directory = gDirectory->GetDirectory("");
+    a_output->cd();
+    a_output->WriteObject( &a_geometry, "PixelGeometry" );
+    directory->cd();
+  }
+
+  void CheckDepositedPixels(const grams::PixelGeometry& a_geometry, TDirectory* a_input)
+  {
+    auto deposited = std::unique_ptr<grams::PixelGeometry>( a_input->Get<grams::PixelGeometry>("PixelGeometry") );
+    if ( ! deposited )
+      return;
+
+    if ( ! deposited->SameGrid(a_geometry) ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "gramsreadoutsim: the charge in '" << a_input->GetName()
+		<< "' was deposited on these pixels:" << std::endl
+		<< *deposited
+		<< "but this job's pixels are:" << std::endl
+		<< a_geometry
+		<< "Check the gdml, anodeTileVolume, multipleAnodeTiles, x_resolution, "
+		<< "y_resolution, and readout_center options of the two jobs" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+} // namespace gramsreadoutsim
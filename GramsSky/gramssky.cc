@@ -178,6 +178,9 @@ int main(int argc, char** argv) {
   // For each event:
   for ( int e = 0; e != numberOfEvents; ++e ) {
 
+    // Select the random numbers for this event.
+    pg->SetEvent( runNumber, e + startingEventNumber );
+
     // Generate returns a std::shared_ptr<gramssky::ParticleInfo>.
     auto info = generator->Generate();
 
@@ -9,6 +9,7 @@
 #define Grams_ParticleGeneration_h
 
 #include "PositionGenerator.h"
+#include "RandomService.h" // in util/
 
 // C++ includes
 #include <memory>
@@ -28,9 +29,19 @@ namespace gramssky {
     // Select an primary-generation method.
     std::shared_ptr<PositionGenerator> GetGenerator();
 
+    // Call this before generating each event. It selects the
+    // random-number stream for the event, so that an event's
+    // particles depend only on rngseed, the run, and the event
+    // number.
+    void SetEvent(int run, int event);
+
   private:
     // The generator selected by the user.
     std::shared_ptr<PositionGenerator> m_generator;
+
+    // The generators all use gRandom. It's replaced by this stream,
+    // which is owned by ROOT.
+    util::RandomStream* m_random;
   };
 
 } // namespace gramssky
@@ -11,6 +11,7 @@
 #include "EnergyGenerator.h"
 #include "ParticleInfo.h"
 #include "Options.h"
+#include "RandomService.h"
 
 // The different generators we can manage.
 #include "PointPositionGenerator.h"
@@ -45,13 +46,16 @@ namespace gramssky {
     // Set up accessing program options.
     auto options = util::Options::GetInstance();
     
-    // Most generators will require random numbers.  Get and set the
-    // random number seed.
-    int seed;
-    options->GetOption("rngseed",seed);
-    // Note that the default random-number generator in ROOT is
-    // TRandom3.
-    gRandom->SetSeed(seed);
+    // Most generators will require random numbers, and they get them
+    // from gRandom. Replace ROOT's default generator with a stream
+    // from util::RandomService; SetEvent() selects the stream for
+    // each event. Until then, use a stream of its own for anything
+    // the generators might need while they're being set up.
+    delete gRandom;
+    m_random = new util::RandomStream();
+    gRandom = m_random;
+    util::RandomService::GetInstance()->SetStream( *m_random, util::RandomService::e_gramssky,
+						   0, 0, 1 );
 
     // Not all the generators require a separate energy generator.
     bool energyGeneratorNeeded = true;
@@ -158,4 +162,9 @@ namespace gramssky {
     return m_generator;
   }
 
+  void ParticleGeneration::SetEvent(int a_run, int a_event) {
+    util::RandomService::GetInstance()->SetStream( *m_random, util::RandomService::e_gramssky,
+						   a_run, a_event );
+  }
+
 } // namespace gramssky
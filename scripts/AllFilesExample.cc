@@ -91,6 +91,34 @@ int main( int, char**  ) {
   tree->AddFriend("DetSim","gramsdetsim.root");
   tree->AddFriend("gramsg4","gramsg4.root");
 
+  // ROOT matches the rows of the friend trees to those of this tree
+  // with the index that each tree has on EventID. If gramsdetsim
+  // wrote large events in segments (see maxClustersPerSegment in
+  // options.xml), the DetSim and ReadoutSim trees can have more than
+  // one row per event, and are indexed by both EventID and Segment;
+  // their rows no longer line up with this tree. This example only
+  // handles one row per event.
+  if ( tree->GetBranch("Segment") != nullptr ) {
+    std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+              << "AllFilesExample: The DetSim tree was written in segments; "
+              << "this example expects one row per event"
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // If gramselecsim was run with compactWaveforms, the waveforms are
+  // stored as a grams::CompactReadoutWaveforms, with only their
+  // regions of interest. Its ToFlat() method expands them again (see
+  // GramsSim/Display for an example); this example doesn't.
+  const std::string waveformsClass = tree->GetBranch("ReadoutWaveforms")->GetClassName();
+  if ( waveformsClass == "grams::CompactReadoutWaveforms" ) {
+    std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+              << "AllFilesExample: The waveforms were written with compactWaveforms; "
+              << "this example expects grams::ReadoutWaveforms"
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
   // Define the TTreeReader for this combined tree.
   auto reader = new TTreeReader(tree);
 
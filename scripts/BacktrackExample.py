@@ -20,7 +20,7 @@
 # perhaps more realistic examples in SimpleAnalysis, dEdxExample, and
 # RadialDistance.
 
-import platform, ROOT
+import platform, sys, ROOT
 
 # We'll also need the GramsSim custom dictionary for its data objects
 # (see GramsSim/GramsDataObj/README.md and
@@ -47,6 +47,24 @@ tree.AddFriend("ReadoutSim","gramsreadoutsim.root");
 tree.AddFriend("DetSim","gramsdetsim.root");
 tree.AddFriend("gramsg4","gramsg4.root");
 
+# ROOT matches the rows of the friend trees to those of this tree with
+# the index that each tree has on EventID. If gramsdetsim wrote large
+# events in segments (see maxClustersPerSegment in options.xml), the
+# DetSim and ReadoutSim trees can have more than one row per event,
+# and are indexed by both EventID and Segment; their rows no longer
+# line up with this tree. This example only handles one row per event.
+if tree.GetBranch("Segment"):
+    print("BacktrackExample: The DetSim tree was written in segments; this example expects one row per event")
+    sys.exit(1)
+
+# If gramselecsim was run with compactWaveforms, the waveforms are
+# stored as a grams::CompactReadoutWaveforms, with only their regions
+# of interest. Its ToFlat() method expands them again (see
+# GramsSim/Display for an example); this example doesn't.
+if tree.GetBranch("ReadoutWaveforms").GetClassName() == "grams::CompactReadoutWaveforms":
+    print("BacktrackExample: The waveforms were written with compactWaveforms; this example expects grams::ReadoutWaveforms")
+    sys.exit(1)
+
 # For each row (or entry) in the tree:
 for entry in tree:
 
@@ -0,0 +1,71 @@
+// 16-Oct-2026
+
+// The ionization electrons drift along one of the coordinate axes,
+// given by the DriftCoordinate option (x:0 y:1 z:2). DriftAxis<Axis>
+// picks the coordinate along the drift and the two coordinates
+// across it, so that each model can be written once as a template
+// and compiled for each axis. The model chooses which version to
+// call when it's created, so there is no test of the axis for each
+// hit or cluster.
+
+// The two coordinates across the drift are taken in cyclic order:
+// (x,y) for a drift along z, (y,z) along x, and (z,x) along y. These
+// are the coordinates of the anode plane: the models of GramsDetSim
+// drift the electrons to it, and GramsReadoutSim divides it into
+// pixels.
+
+#ifndef DriftAxis_h
+#define DriftAxis_h
+
+// ROOT includes
+#include "Math/Vector4D.h"
+
+namespace util {
+
+  template <int Axis>
+  struct DriftAxis
+  {
+    static_assert( Axis >= 0  &&  Axis <= 2, "the drift axis must be 0, 1, or 2" );
+
+    // The coordinate numbers (x:0 y:1 z:2) along and across the drift.
+    static constexpr int along   = Axis;
+    static constexpr int across1 = ( Axis + 1 ) % 3;
+    static constexpr int across2 = ( Axis + 2 ) % 3;
+
+    // Of three values given in (x,y,z) order, pick the one for the
+    // given coordinate. This works for positions, or for the arrays
+    // in a HitBatch.
+    template <int Coordinate, typename T>
+    static T Pick(T a_x, T a_y, T a_z)
+    {
+      if constexpr ( Coordinate == 0 ) return a_x;
+      else if constexpr ( Coordinate == 1 ) return a_y;
+      else return a_z;
+    }
+
+    static double Along  (const ROOT::Math::XYZTVector& a_v) { return Pick<along>  ( a_v.X(), a_v.Y(), a_v.Z() ); }
+    static double Across1(const ROOT::Math::XYZTVector& a_v) { return Pick<across1>( a_v.X(), a_v.Y(), a_v.Z() ); }
+    static double Across2(const ROOT::Math::XYZTVector& a_v) { return Pick<across2>( a_v.X(), a_v.Y(), a_v.Z() ); }
+
+    // The reverse: a position in (x,y,z,t) from its coordinates along
+    // and across the drift.
+    static ROOT::Math::XYZTVector Position(double a_along, double a_across1, double a_across2,
+					   double a_t)
+    {
+      double c[3];
+      c[along]   = a_along;
+      c[across1] = a_across1;
+      c[across2] = a_across2;
+      return ROOT::Math::XYZTVector( c[0], c[1], c[2], a_t );
+    }
+  };
+
+  // Read the DriftCoordinate and DriftDirection options, and check
+  // them. 'direction' is +1 if the electrons drift towards increasing
+  // values of the coordinate (i.e., the readout plane is at a larger
+  // coordinate than the hits), -1 if they drift the other way.
+  void GetDriftAxisOptions(int& axis, double& direction);
+
+} // namespace util
+
+#endif // DriftAxis_h
@@ -0,0 +1,74 @@
+/// 16-Oct-2026
+/// A small fast Fourier transform for real sequences.
+
+/// See README.md for documentation.
+
+#ifndef FFT_h
+#define FFT_h 1
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace util {
+
+  /// The discrete Fourier transform of a real sequence whose length
+  /// is a power of two. The tables (twiddle factors and bit-reversal
+  /// order) are computed once in the constructor, so an object
+  /// should be created once and reused for every transform of that
+  /// length.
+
+  /// The transforms don't change the object, so one object can be
+  /// shared among threads, as long as each thread has its own
+  /// input and output arrays.
+  class RealFFT
+  {
+  public:
+
+    /// 'size' must be a power of two, at least 4.
+    explicit RealFFT(std::size_t size);
+
+    /// The length of a sequence, and the number of frequency bins
+    /// (size/2 + 1) in its transform.
+    std::size_t Size() const { return m_size; }
+    std::size_t NumberOfBins() const { return m_size / 2 + 1; }
+
+    /// The smallest power of two that is >= n (and at least 4).
+    static std::size_t GoodSize(std::size_t n);
+
+    /// Compute the transform of the Size() values in 'input' into
+    /// the NumberOfBins() values of 'output':
+    ///    output[k] = sum_n input[n] exp(-2 pi i k n / Size())
+    /// 'input' is left unchanged.
+    void Forward(const double* input, std::complex<double>* output) const;
+
+    /// The inverse: from NumberOfBins() values of 'input' (taken to
+    /// be the transform of a real sequence), compute the Size()
+    /// values of 'output', including the factor of 1/Size(), so that
+    /// Inverse(Forward(x)) == x. 'input' is left unchanged.
+    void Inverse(const std::complex<double>* input, double* output) const;
+
+  private:
+
+    /// The complex transform of length m_size/2, in place, on
+    /// values already in bit-reversed order.
+    void m_Transform(std::complex<double>* data) const;
+
+    std::size_t m_size;
+
+    /// exp(-2 pi i j / (m_size/2)) for j in [0, m_size/4), for the
+    /// half-length complex transform.
+    std::vector< std::complex<double> > m_twiddles;
+
+    /// exp(-2 pi i k / m_size) for k in [0, m_size/2), to split the
+    /// half-length transform into the transform of a real sequence.
+    std::vector< std::complex<double> > m_split;
+
+    /// Where each element of the half-length transform goes in
+    /// bit-reversed order.
+    std::vector< std::size_t > m_reverse;
+  };
+
+} // namespace util
+
+#endif // FFT_h
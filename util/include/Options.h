@@ -36,6 +36,16 @@ namespace util {
     bool GetOption(const std::string name, std::string& value) const;
     bool GetOption(const std::string name, std::vector<double>& value) const;
 
+    /// Change the value of an option that's already defined, after
+    /// the options have been parsed. The value is converted in the
+    /// same way as one given on the command line. This returns false
+    /// if there's no such option, if the value can't be converted, or
+    /// if it's outside the option's low/high limits (the option is
+    /// then left unchanged). It's meant for setting up objects that read their
+    /// options when they're constructed (e.g., the same model with
+    /// different parameters); it isn't thread-safe.
+    bool SetOption(const std::string name, const std::string value);
+
     /// Display all the options as a table.
     void PrintOptions() const;
 
@@ -109,6 +119,11 @@ namespace util {
     std::string m_progPath;    ///< The path of the running program (argv[0])
     std::string m_optionsFile; ///< The name of the options XML file used
 
+    /// Is 'value' within the low and high limits of a numeric
+    /// option? If not, print an error message.
+    bool m_InRange(const std::string& name, const m_option_attributes& option,
+		   const std::string& value) const;
+
     /// Convert a string like "(1,2,3)" into a vector of numbers.
     std::vector<double> m_stringToValues( const std::string& ) const;
 
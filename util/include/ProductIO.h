@@ -0,0 +1,158 @@
+/// 16-Oct-2026
+/// Read and write data products that may be stored either as a
+/// std::map or as its flat (sorted-vector) equivalent.
+
+/// See README.md for documentation.
+
+#ifndef ProductIO_h
+#define ProductIO_h 1
+
+// ROOT includes
+#include "TTree.h"
+#include "TBranch.h"
+#include "TClass.h"
+#include "TTreeReader.h"
+#include "TTreeReaderValue.h"
+
+// C++ includes
+#include <memory>
+#include <typeinfo>
+
+namespace util {
+
+  /// Does the column 'branchName' in 'tree' (or one of its friends)
+  /// hold an object of type T?
+  template <typename T>
+  bool ColumnHolds(TTree* a_tree, const char* a_branchName)
+  {
+    if ( a_tree == nullptr ) return false;
+    auto branch = a_tree->GetBranch(a_branchName);
+    if ( branch == nullptr ) return false;
+    // Compare TClass pointers rather than names, since ROOT
+    // normalizes the names of template classes.
+    return TClass::GetClass( branch->GetClassName() ) == TClass::GetClass( typeid(T) );
+  }
+
+  /// Read a column that holds either a Flat or a Map data product
+  /// (e.g., grams::FlatMCLArHits or grams::MCLArHits). The format is
+  /// determined from the branch when the reader is created. Either
+  /// way the program sees a Flat object; if the column holds a Map,
+  /// it's converted (with grams::Convert) when an entry is first
+  /// accessed.
+
+  /// Like TTreeReaderValue, this must be created before the first
+  /// call to TTreeReader::Next().
+  template <typename Flat, typename Map>
+  class ProductReader
+  {
+  public:
+
+    ProductReader(TTreeReader& a_reader, const char* a_branchName)
+      : m_reader(a_reader)
+    {
+      m_flat = IsFlat( a_reader.GetTree(), a_branchName );
+      if ( m_flat )
+	m_flatValue = std::make_unique< TTreeReaderValue<Flat> >( a_reader, a_branchName );
+      else
+	m_mapValue = std::make_unique< TTreeReaderValue<Map> >( a_reader, a_branchName );
+    }
+
+    /// Does the column contain the flat version of the data product?
+    bool IsFlat() const { return m_flat; }
+
+    /// The product for the current entry.
+    Flat& operator*()
+    {
+      if ( m_flat ) return *(*m_flatValue);
+
+      // Only convert once per entry.
+      const auto entry = m_reader.GetCurrentEntry();
+      if ( entry != m_convertedEntry ) {
+	Convert( *(*m_mapValue), m_converted );
+	m_convertedEntry = entry;
+      }
+      return m_converted;
+    }
+    Flat* operator->() { return &(**this); }
+
+    /// Does 'branchName' in 'tree' (or one of its friends) hold a
+    /// Flat object?
+    static bool IsFlat(TTree* a_tree, const char* a_branchName)
+    {
+      return ColumnHolds<Flat>( a_tree, a_branchName );
+    }
+
+  private:
+    TTreeReader& m_reader;
+    bool m_flat;
+    std::unique_ptr< TTreeReaderValue<Flat> > m_flatValue;
+    std::unique_ptr< TTreeReaderValue<Map> >  m_mapValue;
+
+    // The converted copy of a Map column, and the entry it came from.
+    Flat m_converted;
+    Long64_t m_convertedEntry = -1;
+  };
+
+  /// Create a column that holds either a Flat or a Map data
+  /// product. The program always fills the Flat object returned by
+  /// operator*; if the column is a Map, call Prepare() before each
+  /// TTree::Fill() to convert it. If the tree is nullptr, no column
+  /// is created, and the object only holds the product in memory.
+
+  /// A Flat column is split: each field of the elements (the key,
+  /// and each member of the value) is stored in a sub-branch of its
+  /// own, so ROOT compresses and reads it column by column. A Map
+  /// column isn't split.
+  template <typename Flat, typename Map>
+  class ProductWriter
+  {
+  public:
+
+    ProductWriter(TTree* a_tree, const char* a_branchName, bool a_flat)
+      : m_flat(a_flat)
+      , m_flatProduct( new Flat() )
+      , m_mapProduct( new Map() )
+    {
+      if ( a_tree == nullptr )
+	return;
+
+      // The vector inside a Flat product splits into columns. A
+      // std::map doesn't gain much from splitting, and as in the
+      // programs' other output branches, a splitlevel of 0 avoids
+      // problems with ROOT's TBrowser.
+      if ( m_flat )
+	a_tree->Branch( a_branchName, &m_flatProduct, 32000, 99 );
+      else
+	a_tree->Branch( a_branchName, &m_mapProduct, 32000, 0 );
+    }
+
+    ~ProductWriter()
+    {
+      delete m_flatProduct;
+      delete m_mapProduct;
+    }
+
+    // The TTree holds the addresses of our pointers.
+    ProductWriter(const ProductWriter&) = delete;
+    ProductWriter& operator=(const ProductWriter&) = delete;
+
+    bool IsFlat() const { return m_flat; }
+
+    Flat& operator*() { return *m_flatProduct; }
+    Flat* operator->() { return m_flatProduct; }
+
+    void Prepare()
+    {
+      if ( ! m_flat )
+	Convert( *m_flatProduct, *m_mapProduct );
+    }
+
+  private:
+    bool m_flat;
+    Flat* m_flatProduct;
+    Map* m_mapProduct;
+  };
+
+} // namespace util
+
+#endif // ProductIO_h
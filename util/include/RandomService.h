@@ -0,0 +1,166 @@
+/// 16-Oct-2026
+/// Reproducible, per-event random-number streams.
+
+/// See README.md for documentation.
+
+#ifndef RandomService_h
+#define RandomService_h 1
+
+#include <TRandom.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+
+namespace util {
+
+  /// The Philox4x32-10 counter-based generator from J. Salmon et
+  /// al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC'11. It
+  /// maps a 128-bit counter and a 64-bit key to 128 random bits, with
+  /// no internal state. Any point in any sequence can be reached
+  /// without generating the numbers before it.
+  inline void Philox4x32(const uint32_t a_counter[4], const uint32_t a_key[2],
+			 uint32_t a_result[4])
+  {
+    const uint32_t M0 = 0xD2511F53;
+    const uint32_t M1 = 0xCD9E8D57;
+    const uint32_t W0 = 0x9E3779B9;
+    const uint32_t W1 = 0xBB67AE85;
+
+    uint32_t c0 = a_counter[0], c1 = a_counter[1], c2 = a_counter[2], c3 = a_counter[3];
+    uint32_t k0 = a_key[0], k1 = a_key[1];
+
+    for ( int round = 0; round != 10; ++round ) {
+      if ( round != 0 ) { k0 += W0; k1 += W1; }
+      const uint64_t p0 = uint64_t(M0) * c0;
+      const uint64_t p1 = uint64_t(M1) * c2;
+      const uint32_t n0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+      const uint32_t n2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+      c1 = uint32_t(p1);
+      c3 = uint32_t(p0);
+      c0 = n0;
+      c2 = n2;
+    }
+
+    a_result[0] = c0; a_result[1] = c1; a_result[2] = c2; a_result[3] = c3;
+  }
+
+  /// A ROOT TRandom whose numbers come from Philox4x32. Since it's a
+  /// TRandom, all of the usual methods (Gaus, Uniform, Poisson, ...)
+  /// are available, and it can be used anywhere a TRandom* is
+  /// expected, including gRandom.
+
+  /// The stream is identified by its key (the job seed, the program
+  /// stage, and the tile) and the (run, event, subID) fields of the
+  /// counter. The remaining counter field steps through the stream.
+  /// The four counter words are all in use, so the tile shares the
+  /// second key word with the stage: the stage in the low 8 bits,
+  /// the tile in the high 24. Each field has its own bits, so
+  /// different (stage, tile) pairs never give the same stream.
+  class RandomStream : public TRandom
+  {
+  public:
+
+    RandomStream();
+    virtual ~RandomStream() {}
+
+    /// Start the stream identified by these values from its
+    /// beginning.
+    void SetKey(uint32_t seed, uint32_t stage, uint32_t run, uint32_t event, uint32_t subID,
+		uint32_t tile = 0);
+
+    /// The largest tile number that fits in the key.
+    static constexpr uint32_t MaxTile = ( 1u << 24 ) - 1;
+
+    /// A uniform deviate in the open interval (0,1) with 32 bits of
+    /// resolution, like TRandom3.
+    virtual Double_t Rndm() override;
+    virtual void RndmArray(Int_t n, Float_t* array) override;
+    virtual void RndmArray(Int_t n, Double_t* array) override;
+
+    /// For compatibility with code that calls gRandom->SetSeed():
+    /// change the seed part of the key and restart the stream.
+    virtual void SetSeed(ULong_t seed = 0) override;
+    virtual UInt_t GetSeed() const override { return m_key[0]; }
+
+    /// The raw 32-bit output, for routines that want to do their own
+    /// conversions.
+    uint32_t Next32()
+    {
+      if ( m_used == 4 ) m_Refill();
+      return m_block[ m_used++ ];
+    }
+
+    /// Convert a 32-bit integer into a double in (0,1).
+    static double ToUniform(uint32_t a_x) { return ( double(a_x) + 0.5 ) * 2.3283064365386963e-10; }
+
+  private:
+    void m_Refill();
+
+    uint32_t m_key[2];
+    uint32_t m_counter[4];
+    uint32_t m_block[4];
+    int m_used;
+  };
+
+  /// Fill 'values' with n Gaussian deviates with mean 0 and width
+  /// 1. The uniform deviates are fetched from 'random' in a single
+  /// call and converted with the Box-Muller transform, which is much
+  /// faster than calling random->Gaus() n times.
+  void GausArray(TRandom* random, std::size_t n, double* values);
+
+  /// The job-wide service that assigns random-number streams. Every
+  /// stream is determined by (rngseed, stage, run, event, subID), so
+  /// an event gets the same random numbers no matter which thread,
+  /// job, or computer processes it, and no matter what order the
+  /// events are processed in.
+  class RandomService
+  {
+  public:
+
+    /// This is a singleton class.
+    static RandomService* GetInstance();
+
+    /// The programs in the analysis chain. Each has its own streams,
+    /// so that (for example) the noise in gramselecsim is not
+    /// correlated with the diffusion in gramsdetsim.
+    enum Stage : uint32_t {
+      e_gramssky        = 1,
+      e_gramsdetsim     = 2,
+      e_gramsreadoutsim = 3,
+      e_gramselecsim    = 4,
+
+      /// gramselecsim's library of correlated noise (see
+      /// GramsElecSim/include/NoiseLibrary.h), and the choice of the
+      /// noise shared by the cells of each event.
+      e_gramselecsimnoise = 5
+    };
+
+    /// Restart 'stream' at the beginning of the sequence for the
+    /// given stage, run, event, subID, and tile. The subID and tile
+    /// distinguish independent sequences within an event (e.g., one
+    /// per readout channel, with the channel's index within its anode
+    /// tile as the subID); use 0 if you only need one.
+    void SetStream(RandomStream& stream, Stage stage,
+		   int run, int event, int subID = 0, int tile = 0);
+
+    /// The job seed, taken from the 'rngseed' option. If rngseed is
+    /// 0, a seed is chosen at random the first time this is called
+    /// (and displayed if 'verbose' is on).
+    uint32_t Seed();
+
+    /// Prevent copy construction for a singleton class.
+    RandomService(const RandomService&) = delete;
+    void operator=(RandomService const&) = delete;
+
+  private:
+    /// Standard null constructor for a singleton class.
+    RandomService() {}
+
+    std::once_flag m_seedFlag;
+    uint32_t m_seed = 0;
+  };
+
+} // namespace util
+
+#endif // RandomService_h
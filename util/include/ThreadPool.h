@@ -0,0 +1,80 @@
+/// 16-Oct-2026
+/// A minimal pool of worker threads for event-parallel processing.
+
+/// See README.md for documentation.
+
+#ifndef ThreadPool_h
+#define ThreadPool_h 1
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util {
+
+  class ThreadPool
+  {
+  public:
+
+    /// Start 'nthreads' worker threads. They sleep until there's
+    /// work for them to do.
+    explicit ThreadPool(int nthreads);
+
+    /// Stop and join the worker threads.
+    ~ThreadPool();
+
+    int NumberOfThreads() const { return m_workers.size(); }
+
+    /// Call func(index, thread) for every index in [0,n), spread
+    /// among the worker threads. 'thread' is in the range
+    /// [0,NumberOfThreads()) and identifies the worker that's
+    /// handling that index; use it to select per-thread resources
+    /// (models, random-number engines, etc.).
+
+    /// Indices are handed out one at a time as the workers become
+    /// free, so a few expensive items don't hold up the rest. This
+    /// routine returns only after every index has been processed.
+
+    /// If func throws, the workers stop handing out new indices, and
+    /// the first exception is re-thrown here, in the calling thread,
+    /// once the indices already started have finished.
+    void ParallelFor(std::size_t n,
+		     const std::function<void(std::size_t index, int thread)>& func);
+
+    /// Prevent copying; we own threads.
+    ThreadPool(const ThreadPool&) = delete;
+    void operator=(ThreadPool const&) = delete;
+
+  private:
+
+    // The loop executed by each worker thread.
+    void m_Work(int thread);
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_start;   ///< signals the workers that a job is ready
+    std::condition_variable m_done;    ///< signals ParallelFor that the job is finished
+
+    // The current job. m_generation is incremented for each call to
+    // ParallelFor, so that a worker can tell a new job from one it's
+    // already finished.
+    const std::function<void(std::size_t, int)>* m_func = nullptr;
+    std::size_t m_size = 0;
+    std::atomic<std::size_t> m_next{0};
+    unsigned long m_generation = 0;
+    int m_busy = 0;
+
+    // The first exception thrown by m_func in the current job.
+    std::exception_ptr m_exception;
+    bool m_stop = false;
+  };
+
+} // namespace util
+
+#endif // ThreadPool_h
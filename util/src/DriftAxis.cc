@@ -0,0 +1,45 @@
+// 16-Oct-2026
+// Read the options that describe the drift direction.
+
+#include "DriftAxis.h"
+
+// For processing command-line and XML file options.
+#include "Options.h"
+
+// C++ includes
+#include <iostream>
+#include <cstdlib>
+
+namespace util {
+
+  void GetDriftAxisOptions(int& a_axis, double& a_direction)
+  {
+    auto options = util::Options::GetInstance();
+
+    // The defaults are the GRAMS geometry, in case an older
+    // options file doesn't have these options.
+    a_axis = 2;
+    int direction = 1;
+    options->GetOption("DriftCoordinate", a_axis);
+    options->GetOption("DriftDirection",  direction);
+
+    if ( a_axis < 0  ||  a_axis > 2 ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "util::GetDriftAxisOptions: DriftCoordinate=" << a_axis
+		<< " must be 0 (x), 1 (y), or 2 (z)"
+		<< std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    if ( direction != 1  &&  direction != -1 ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "util::GetDriftAxisOptions: DriftDirection=" << direction
+		<< " must be 1 or -1"
+		<< std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    a_direction = double(direction);
+  }
+
+} // namespace util
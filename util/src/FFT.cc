@@ -0,0 +1,148 @@
+/// 16-Oct-2026
+/// Implement a small fast Fourier transform for real sequences.
+
+/// A real sequence of length N is treated as a complex sequence of
+/// length N/2 (even elements in the real parts, odd elements in the
+/// imaginary parts). That's transformed with an iterative radix-2
+/// algorithm, and the result is split into the transform of the real
+/// sequence. This is about twice as fast as a complex transform of
+/// length N.
+
+#include "FFT.h"
+
+// C++ includes
+#include <complex>
+#include <cstddef>
+#include <vector>
+#include <cmath>
+#include <iostream>
+#include <cstdlib>
+
+namespace util {
+
+  // Multiply two complex numbers. The operator* for std::complex has
+  // to handle infinities and NaNs, which turns it into a function
+  // call unless the compiler is told to ignore them.
+  static inline std::complex<double> Multiply(const std::complex<double>& a,
+					      const std::complex<double>& b)
+  {
+    return std::complex<double>( a.real() * b.real() - a.imag() * b.imag(),
+				 a.real() * b.imag() + a.imag() * b.real() );
+  }
+
+  std::size_t RealFFT::GoodSize(std::size_t a_n)
+  {
+    std::size_t size = 4;
+    while ( size < a_n ) size <<= 1;
+    return size;
+  }
+
+  RealFFT::RealFFT(std::size_t a_size)
+    : m_size(a_size)
+  {
+    if ( a_size < 4  ||  ( a_size & ( a_size - 1 ) ) != 0 ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "util::RealFFT - size " << a_size
+		<< " is not a power of two that's at least 4" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    const std::size_t half = m_size / 2;
+    const double twoPi = 2. * M_PI;
+
+    m_twiddles.resize( half / 2 );
+    for ( std::size_t j = 0; j != m_twiddles.size(); ++j )
+      m_twiddles[j] = std::polar( 1., -twoPi * double(j) / double(half) );
+
+    m_split.resize( half / 2 + 1 );
+    for ( std::size_t k = 0; k != m_split.size(); ++k )
+      m_split[k] = std::polar( 1., -twoPi * double(k) / double(m_size) );
+
+    std::size_t bits = 0;
+    while ( ( std::size_t(1) << bits ) < half ) ++bits;
+    m_reverse.resize( half );
+    for ( std::size_t i = 0; i != half; ++i ) {
+      std::size_t r = 0;
+      for ( std::size_t b = 0; b != bits; ++b )
+	if ( i & ( std::size_t(1) << b ) )
+	  r |= std::size_t(1) << ( bits - 1 - b );
+      m_reverse[i] = r;
+    }
+  }
+
+  void RealFFT::m_Transform(std::complex<double>* a_data) const
+  {
+    const std::size_t half = m_size / 2;
+    for ( std::size_t length = 2; length <= half; length <<= 1 ) {
+      const std::size_t span = length / 2;
+      const std::size_t step = half / length;
+      for ( std::size_t start = 0; start < half; start += length ) {
+	for ( std::size_t j = 0; j != span; ++j ) {
+	  const auto u = a_data[ start + j ];
+	  const auto v = Multiply( a_data[ start + j + span ], m_twiddles[ j * step ] );
+	  a_data[ start + j ] = u + v;
+	  a_data[ start + j + span ] = u - v;
+	}
+      }
+    }
+  }
+
+  void RealFFT::Forward(const double* a_input, std::complex<double>* a_output) const
+  {
+    const std::size_t half = m_size / 2;
+
+    // The output array has room for the half-length transform, so do
+    // it there.
+    for ( std::size_t n = 0; n != half; ++n )
+      a_output[ m_reverse[n] ] = std::complex<double>( a_input[2*n], a_input[2*n + 1] );
+    m_Transform( a_output );
+
+    // Split the result into the transforms of the even and odd
+    // elements (E and O), and combine them. Bins k and half-k are
+    // computed together, since each needs both of them.
+    const auto z0 = a_output[0];
+    a_output[0]    = std::complex<double>( z0.real() + z0.imag(), 0. );
+    a_output[half] = std::complex<double>( z0.real() - z0.imag(), 0. );
+    for ( std::size_t k = 1; k <= half / 2; ++k ) {
+      const auto zk = a_output[k];
+      const auto zm = std::conj( a_output[ half - k ] );
+      const auto even = 0.5 * ( zk + zm );
+      const auto diff = 0.5 * ( zk - zm );
+      const std::complex<double> odd( diff.imag(), -diff.real() ); // -i * diff
+      const auto wodd = Multiply( m_split[k], odd );
+      a_output[k]        = even + wodd;
+      a_output[half - k] = std::conj( even - wodd );
+    }
+  }
+
+  void RealFFT::Inverse(const std::complex<double>* a_input, double* a_output) const
+  {
+    const std::size_t half = m_size / 2;
+
+    // Each thread has its own work space.
+    thread_local std::vector< std::complex<double> > work;
+    work.resize( half );
+
+    // Undo the split, and put the half-length transform in
+    // bit-reversed order. The inverse transform is done as the
+    // conjugate of the forward transform of the conjugate.
+    for ( std::size_t k = 0; k <= half / 2; ++k ) {
+      const auto xk = a_input[k];
+      const auto xm = std::conj( a_input[ half - k ] );
+      const auto even = 0.5 * ( xk + xm );
+      const auto odd = Multiply( 0.5 * ( xk - xm ), std::conj( m_split[k] ) );
+      const std::complex<double> iodd( -odd.imag(), odd.real() ); // i * odd
+      work[ m_reverse[k] ] = std::conj( even + iodd );
+      if ( k != 0 )
+	work[ m_reverse[ half - k ] ] = even - iodd; // conj of conj(even - iodd)
+    }
+    m_Transform( work.data() );
+
+    const double scale = 1. / double(half);
+    for ( std::size_t n = 0; n != half; ++n ) {
+      a_output[2*n]     =  work[n].real() * scale;
+      a_output[2*n + 1] = -work[n].imag() * scale;
+    }
+  }
+
+} // namespace util
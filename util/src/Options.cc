@@ -406,54 +406,9 @@ namespace util {
     // For every entry in the options map...
     for ( auto option_iter = m_options.cbegin(); option_iter != m_options.cend(); ++option_iter )
       {
-	// Get the option's name.
-	auto name = (*option_iter).first;
-	
-	// Is this a numeric option?
-	if ( (*option_iter).second.type == e_integer ||
-	     (*option_iter).second.type == e_double ) {
-
-	  // Is there a lower limit?
-	  if ( ! (*option_iter).second.low.empty() ) {
-	    // There is, so convert the strings for the value and the
-	    // limit into numbers and compare them. 
-	    auto value = std::stod((*option_iter).second.value);
-	    auto low = std::stod((*option_iter).second.low);
-	    if ( low > value ) 
-	      {
-		// We have a problem! Print an error message and unset
-		// the success flag.
-		std::cerr << "ERROR: File " << __FILE__ << " Line " << __LINE__ << " " 
-			  << std::endl
-			  << "Option '" << name << "' - the value '" << value
-			  << "' is lower than the lower limit of '" << low
-			  << "' as defined in the options file '" << m_optionsFile
-			  << "'" << std::endl;
-		success = false;
-	      }
-	  } // there is an option attribute for 'low'
-
-	  // Is there an upper limit?
-	  if ( ! (*option_iter).second.high.empty() ) {
-	    // There is, so convert the strings for the value and the
-	    // limit into numbers and compare them. 
-	    auto value = std::stod((*option_iter).second.value);
-	    auto high = std::stod((*option_iter).second.high);
-	    if ( value > high ) 
-	      {
-		// We have a problem! Print an error message and unset
-		// the success flag.
-		std::cerr << "ERROR: File " << __FILE__ << " Line " << __LINE__ << " " 
-			  << std::endl
-			  << "Option '" << name << "' - the value '" << value
-			  << "' is higher than the higher limit of '" << high
-			  << "' as defined in the options file '" << m_optionsFile
-			  << "'" << std::endl;
-		success = false;
-	      }
-	  } // there is a option attribute of 'high'
-
-	} // option is numeric
+	if ( ! m_InRange( (*option_iter).first, (*option_iter).second,
+			  (*option_iter).second.value ) )
+	  success = false;
       } // for each option
 
     if (debug) PrintOptions();
@@ -462,6 +417,58 @@ namespace util {
     return success;
   }
 
+  bool Options::m_InRange(const std::string& name, const m_option_attributes& option,
+			  const std::string& text) const
+  {
+    // Only the numeric options have limits.
+    if ( option.type != e_integer  &&  option.type != e_double )
+      return true;
+
+    bool success = true;
+
+    // Is there a lower limit?
+    if ( ! option.low.empty() ) {
+      // There is, so convert the strings for the value and the
+      // limit into numbers and compare them. 
+      auto value = std::stod(text);
+      auto low = std::stod(option.low);
+      if ( low > value ) 
+	{
+	  // We have a problem! Print an error message and unset
+	  // the success flag.
+	  std::cerr << "ERROR: File " << __FILE__ << " Line " << __LINE__ << " " 
+		    << std::endl
+		    << "Option '" << name << "' - the value '" << value
+		    << "' is lower than the lower limit of '" << low
+		    << "' as defined in the options file '" << m_optionsFile
+		    << "'" << std::endl;
+	  success = false;
+	}
+    } // there is an option attribute for 'low'
+
+    // Is there an upper limit?
+    if ( ! option.high.empty() ) {
+      // There is, so convert the strings for the value and the
+      // limit into numbers and compare them. 
+      auto value = std::stod(text);
+      auto high = std::stod(option.high);
+      if ( value > high ) 
+	{
+	  // We have a problem! Print an error message and unset
+	  // the success flag.
+	  std::cerr << "ERROR: File " << __FILE__ << " Line " << __LINE__ << " " 
+		    << std::endl
+		    << "Option '" << name << "' - the value '" << value
+		    << "' is higher than the higher limit of '" << high
+		    << "' as defined in the options file '" << m_optionsFile
+		    << "'" << std::endl;
+	  success = false;
+	}
+    } // there is a option attribute of 'high'
+
+    return success;
+  }
+
   // For the getters, it would perhaps be possible to create a
   // template.  But the resulting code would be even more difficult to
   // read, and there are only four types of values that matter for
@@ -537,6 +544,61 @@ namespace util {
     return false;
   }
 
+  bool Options::SetOption(const std::string name, const std::string value)
+  {
+    auto search = m_options.find( name );
+    if ( search == m_options.end() )
+      return false;
+
+    auto& option = (*search).second;
+    switch (option.type)
+      {
+      case e_flag:
+      case e_boolean:
+	{
+	  // The same conversion as in the XML file.
+	  std::string lower = value;
+	  auto lowC = [](unsigned char c){ return std::tolower(c); };
+	  std::transform(lower.begin(), lower.end(), lower.begin(), lowC);
+	  option.value = "0";
+	  if ( lower == "on"  ||  lower[0] == 't'  ||  lower[0] == '1' )
+	    option.value = "1";
+	}
+	break;
+      case e_string:
+	option.value = value;
+	break;
+      case e_double:
+      case e_integer:
+	{
+	  // The value has to be within the same limits as a value on
+	  // the command line.
+	  std::string converted;
+	  try {
+	    if ( option.type == e_double ) {
+	      std::ostringstream os;
+	      os << std::stod(value);
+	      converted = os.str();
+	    }
+	    else
+	      converted = std::to_string( std::stoi(value) );
+	  } catch ( std::exception& e ) {
+	    return false;
+	  }
+	  if ( ! m_InRange( name, option, converted ) )
+	    return false;
+	  option.value = converted;
+	}
+	break;
+      case e_vector:
+	option.value = m_valuesToString( m_stringToValues(value) );
+	break;
+      default:
+	return false;
+      }
+    return true;
+  }
+
   void Options::PrintOptions() const
   {
     // Neatly-formatted columnar output is not one of C++ strengths (I
@@ -978,9 +1040,17 @@ namespace util {
     // program tag we find. Otherwise, initialize the program tags in
     // the list.
     bool allTags = ( a_program.compare("ALL") == 0 );
+
+    // a_program may also be a comma-separated list of program tags,
+    // for a program that does the work of several others. The first
+    // tag in the list is the program's own.
+    std::string primaryTag = a_program.substr( 0, a_program.find(',') );
     if ( ! allTags ) {
       programTags.insert("global");
-      programTags.insert(a_program);
+      std::stringstream tagList(a_program);
+      std::string tag;
+      while ( std::getline( tagList, tag, ',' ) )
+	if ( ! tag.empty() ) programTags.insert(tag);
     }
 
     // Read in the XML file and parse its contents. 
@@ -1242,7 +1312,13 @@ namespace util {
 	  // Handle the "short" attribute (which I call 'brief' here to avoid
 	  // the C++ keyword 'short'. If there's no short option, set this
 	  // to char(0) to avoid issues with getopt_long processing in ParseXML.
-	  if ( brief.empty() ) m_options[name].brief = 0;
+	  // When several program tags are read, the programs' short
+	  // options may clash (e.g., "-i" for each program's input
+	  // file), so only those in <global> and the program's own tag
+	  // are kept.
+	  const bool keepBrief = allTags  ||  programTags.size() <= 2
+	    ||  parentString == "global"  ||  parentString == primaryTag;
+	  if ( brief.empty()  ||  ! keepBrief ) m_options[name].brief = 0;
 	  else m_options[name].brief = brief[0];
 
 	  // The "desc" attribute:
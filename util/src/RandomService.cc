@@ -0,0 +1,163 @@
+/// 16-Oct-2026
+/// Implement reproducible, per-event random-number streams.
+
+#include "RandomService.h"
+#include "Options.h"
+
+// C++ includes
+#include <iostream>
+#include <random>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+
+namespace util {
+
+  RandomStream::RandomStream()
+    : TRandom(0)
+  {
+    SetKey(0, 0, 0, 0, 0);
+  }
+
+  void RandomStream::SetKey(uint32_t a_seed, uint32_t a_stage,
+			    uint32_t a_run, uint32_t a_event, uint32_t a_subID,
+			    uint32_t a_tile)
+  {
+    if ( a_stage > 0xFF  ||  a_tile > MaxTile ) {
+      std::cerr << "File " << __FILE__ << " Line " << __LINE__ << " " << std::endl
+		<< "util::RandomStream::SetKey: stage=" << a_stage << " tile=" << a_tile
+		<< " don't fit in the key (stage < 256, tile <= " << MaxTile << ")"
+		<< std::endl;
+      exit(EXIT_FAILURE);
+    }
+    m_key[0] = a_seed;
+    m_key[1] = a_stage | ( a_tile << 8 );
+    m_counter[0] = 0;
+    m_counter[1] = a_subID;
+    m_counter[2] = a_event;
+    m_counter[3] = a_run;
+    // Force a new block on the next request.
+    m_used = 4;
+  }
+
+  void RandomStream::m_Refill()
+  {
+    Philox4x32( m_counter, m_key, m_block );
+    ++m_counter[0];
+    m_used = 0;
+  }
+
+  Double_t RandomStream::Rndm()
+  {
+    return ToUniform( Next32() );
+  }
+
+  void RandomStream::RndmArray(Int_t a_n, Float_t* a_array)
+  {
+    for ( Int_t i = 0; i < a_n; ++i ) {
+      // Rounding to float could turn a value just below 1 into 1.
+      Float_t x = float( ToUniform( Next32() ) );
+      a_array[i] = ( x < 1.0f ) ? x : 0.99999994f;
+    }
+  }
+
+  void RandomStream::RndmArray(Int_t a_n, Double_t* a_array)
+  {
+    Int_t i = 0;
+
+    // Use up what's left of the current block.
+    for ( ; i < a_n  &&  m_used < 4; ++i )
+      a_array[i] = ToUniform( m_block[ m_used++ ] );
+
+    // Convert whole blocks without going through m_block.
+    uint32_t block[4];
+    for ( ; i + 4 <= a_n; i += 4 ) {
+      Philox4x32( m_counter, m_key, block );
+      ++m_counter[0];
+      for ( int j = 0; j != 4; ++j )
+	a_array[i+j] = ToUniform( block[j] );
+    }
+
+    for ( ; i < a_n; ++i )
+      a_array[i] = ToUniform( Next32() );
+  }
+
+  void RandomStream::SetSeed(ULong_t a_seed)
+  {
+    SetKey( uint32_t(a_seed), m_key[1] & 0xFF, m_counter[3], m_counter[2], m_counter[1],
+	    m_key[1] >> 8 );
+  }
+
+  void GausArray(TRandom* a_random, std::size_t a_n, double* a_values)
+  {
+    const double twoPi = 2.0 * M_PI;
+
+    // Fill the array with uniform deviates, then convert each pair
+    // in place. Box-Muller needs u1 > 0; ROOT's generators and
+    // RandomStream never return 0.
+    const std::size_t nPairs = a_n / 2;
+    if ( nPairs > 0 )
+      a_random->RndmArray( Int_t(2 * nPairs), a_values );
+
+    for ( std::size_t k = 0; k != nPairs; ++k ) {
+      const double radius = std::sqrt( -2.0 * std::log( a_values[2*k] ) );
+      const double angle = twoPi * a_values[2*k + 1];
+      a_values[2*k]     = radius * std::cos(angle);
+      a_values[2*k + 1] = radius * std::sin(angle);
+    }
+
+    // If n is odd, the last value needs a pair of its own.
+    if ( a_n % 2 != 0 ) {
+      double u[2];
+      a_random->RndmArray( 2, u );
+      a_values[a_n - 1] = std::sqrt( -2.0 * std::log( u[0] ) ) * std::cos( twoPi * u[1] );
+    }
+  }
+
+  /// This is a singleton class.
+  /// According to <https://stackoverflow.com/questions/12248747/singleton-with-multithreads>
+  /// this method is compatible with multi-threaded running.
+  RandomService* RandomService::GetInstance()
+  {
+    static RandomService instance;
+    return &instance;
+  }
+
+  uint32_t RandomService::Seed()
+  {
+    // Fetch the seed only once. std::call_once makes this safe if the
+    // first calls come from several threads.
+    std::call_once( m_seedFlag, [this]() {
+	auto options = util::Options::GetInstance();
+	int seed = 0;
+	options->GetOption("rngseed",seed);
+	bool verbose = false;
+	options->GetOption("verbose",verbose);
+
+	if ( seed == 0 ) {
+	  // The user isn't interested in recreating the run.
+	  std::random_device device;
+	  m_seed = device();
+	  if (verbose)
+	    std::cout << "util::RandomService: rngseed=0; using seed "
+		      << m_seed << std::endl;
+	}
+	else {
+	  // Negative seeds are allowed; they just become large
+	  // unsigned numbers.
+	  m_seed = uint32_t(seed);
+	}
+      });
+
+    return m_seed;
+  }
+
+  void RandomService::SetStream(RandomStream& a_stream, Stage a_stage,
+				int a_run, int a_event, int a_subID, int a_tile)
+  {
+    a_stream.SetKey( Seed(), a_stage,
+		     uint32_t(a_run), uint32_t(a_event), uint32_t(a_subID), uint32_t(a_tile) );
+  }
+
+} // namespace util
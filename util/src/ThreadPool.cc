@@ -0,0 +1,101 @@
+/// 16-Oct-2026
+/// Implement a minimal pool of worker threads.
+
+#include "ThreadPool.h"
+
+// C++ includes
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace util {
+
+  ThreadPool::ThreadPool(int a_nthreads)
+  {
+    // Always have at least one worker, so ParallelFor can't hang.
+    if ( a_nthreads < 1 ) a_nthreads = 1;
+
+    for ( int t = 0; t != a_nthreads; ++t )
+      m_workers.emplace_back( &ThreadPool::m_Work, this, t );
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_start.notify_all();
+    for ( auto& worker : m_workers )
+      worker.join();
+  }
+
+  void ThreadPool::ParallelFor(std::size_t a_n,
+			       const std::function<void(std::size_t, int)>& a_func)
+  {
+    if ( a_n == 0 ) return;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_func = &a_func;
+    m_size = a_n;
+    m_next = 0;
+    m_busy = m_workers.size();
+    m_exception = nullptr;
+    ++m_generation;
+    m_start.notify_all();
+
+    // Wait until every worker has run out of indices.
+    m_done.wait( lock, [this]{ return m_busy == 0; } );
+    m_func = nullptr;
+
+    if ( m_exception ) {
+      std::exception_ptr exception = nullptr;
+      std::swap( exception, m_exception );
+      std::rethrow_exception( exception );
+    }
+  }
+
+  void ThreadPool::m_Work(int a_thread)
+  {
+    unsigned long lastGeneration = 0;
+
+    while (true) {
+      const std::function<void(std::size_t, int)>* func;
+      std::size_t size;
+      {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_start.wait( lock, [&]{ return m_stop || m_generation != lastGeneration; } );
+	if ( m_stop ) return;
+	lastGeneration = m_generation;
+	func = m_func;
+	size = m_size;
+      }
+
+      // Grab the next unprocessed index until they're all taken. An
+      // exception can't leave the thread (that would call
+      // std::terminate); keep the first one for ParallelFor, and use
+      // up the remaining indices so the other workers stop too.
+      for ( std::size_t i = m_next++; i < size; i = m_next++ ) {
+	try {
+	  (*func)(i, a_thread);
+	}
+	catch (...) {
+	  std::lock_guard<std::mutex> lock(m_mutex);
+	  if ( ! m_exception )
+	    m_exception = std::current_exception();
+	  m_next = size;
+	}
+      }
+
+      {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if ( --m_busy == 0 )
+	  m_done.notify_one();
+      }
+    }
+  }
+
+} // namespace util